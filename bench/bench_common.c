@@ -0,0 +1,126 @@
+#define _POSIX_C_SOURCE 200809L
+#include "bench_common.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+double bench_now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+uint64_t bench_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t v;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(v));
+    return v;
+#else
+    return 0;
+#endif
+}
+
+/* Writes "$body*HH\r\n"; returns 0 if it does not fit */
+static size_t put_sentence(char* out, size_t room, const char* body) {
+    uint8_t cs = 0;
+    for (const char* p = body; *p; p++) cs ^= (uint8_t)*p;
+    int n = snprintf(out, room, "$%s*%02X\r\n", body, cs);
+    if (n < 0 || (size_t)n >= room) return 0;
+    return (size_t)n;
+}
+
+static void format_coord(char* out, size_t size, double deg, int deg_digits) {
+    double a = deg < 0 ? -deg : deg;
+    int d = (int)a;
+    double m = (a - d) * 60.0;
+    snprintf(out, size, "%0*d%08.5f", deg_digits, d, m);
+}
+
+size_t bench_make_nmea_capture(char* buf, size_t size, size_t* epochs, size_t* sentences) {
+    size_t pos = 0, nepoch = 0, nsent = 0;
+    char epoch[1024], lat[16], lon[16], hms[16], dmy[8];
+
+    for (;;) {
+        uint32_t t = (uint32_t)nepoch;
+        uint32_t day = t / 86400;
+        uint32_t tod = t % 86400;
+        snprintf(hms, sizeof(hms), "%02u%02u%02u.00", tod / 3600, (tod / 60) % 60, tod % 60);
+        snprintf(dmy, sizeof(dmy), "%02u%02u%02u", 1 + day % 28, 1 + (day / 28) % 12, 24 + (day / 336) % 70);
+
+        double la = 47.0 + 0.0001 * (double)(nepoch % 50000);
+        double lo = 8.0 + 0.00015 * (double)(nepoch % 50000);
+        format_coord(lat, sizeof(lat), la, 2);
+        format_coord(lon, sizeof(lon), lo, 3);
+        double knots = 20.0 + (double)(nepoch % 37);
+        double course = (double)((nepoch * 7) % 3600) / 10.0;
+
+        size_t len = 0;
+        const char* bodies[8];
+        char rmc[160], vtg[160], gga[160], gll[160];
+        snprintf(rmc, sizeof(rmc), "GPRMC,%s,A,%s,N,%s,E,%.3f,%.2f,%s,,,A", hms, lat, lon, knots, course, dmy);
+        snprintf(vtg, sizeof(vtg), "GPVTG,%.2f,T,,M,%.3f,N,%.3f,K,A", course, knots, knots * 1.852);
+        snprintf(gga, sizeof(gga), "GPGGA,%s,%s,N,%s,E,1,08,1.01,%.1f,M,48.0,M,,", hms, lat, lon,
+                 400.0 + (double)(nepoch % 200) / 10.0);
+        snprintf(gll, sizeof(gll), "GPGLL,%s,N,%s,E,%s,A,A", lat, lon, hms);
+        bodies[0] = rmc;
+        bodies[1] = vtg;
+        bodies[2] = gga;
+        bodies[3] = "GPGSA,A,3,01,02,12,14,17,19,24,32,,,,,2.0,1.01,1.7";
+        bodies[4] = "GPGSV,3,1,12,01,40,083,46,02,17,308,44,12,07,344,39,14,22,228,45";
+        bodies[5] = "GPGSV,3,2,12,17,61,130,47,19,52,062,45,24,33,281,43,32,09,040,37";
+        bodies[6] = "GPGSV,3,3,12,03,05,200,,06,11,320,,09,02,150,,22,01,010,";
+        bodies[7] = gll;
+
+        for (int i = 0; i < 8; i++) {
+            len += put_sentence(epoch + len, sizeof(epoch) - len, bodies[i]);
+        }
+        if (pos + len > size) break;
+        memcpy(buf + pos, epoch, len);
+        pos += len;
+        nepoch++;
+        nsent += 8;
+    }
+
+    if (epochs) *epochs = nepoch;
+    if (sentences) *sentences = nsent;
+    return pos;
+}
+
+const char* bench_map_file(const char* path, size_t* len) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return NULL;
+    *len = (size_t)st.st_size;
+    return (const char*)p;
+}
+
+void bench_unmap_file(const char* data, size_t len) {
+    munmap((void*)data, len);
+}
+
+size_t bench_count_lines(const char* buf, size_t len) {
+    size_t n = 0;
+    const char* p = buf;
+    const char* end = buf + len;
+    while (p < end && (p = memchr(p, '\n', (size_t)(end - p))) != NULL) {
+        n++;
+        p++;
+    }
+    return n;
+}
@@ -0,0 +1,28 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Host benchmark helpers. Build with -DCMAKE_BUILD_TYPE=Release for
+   meaningful numbers; the default host build is -O0. */
+
+double bench_now_s(void);
+
+/* CPU timestamp counter (x86 TSC, AArch64 CNTVCT); 0 where unavailable */
+uint64_t bench_cycles(void);
+
+/* Fill buf with whole synthetic NEO-8M epochs (RMC, VTG, GGA, GSA, 3x GSV,
+   GLL at 1 Hz, moving north-east). Returns bytes written; *epochs and
+   *sentences receive the counts when non-NULL. */
+size_t bench_make_nmea_capture(char* buf, size_t size, size_t* epochs, size_t* sentences);
+
+/* Map a capture file read-only. Returns NULL on failure. */
+const char* bench_map_file(const char* path, size_t* len);
+void        bench_unmap_file(const char* data, size_t len);
+
+/* Count '\n'-terminated lines */
+size_t bench_count_lines(const char* buf, size_t len);
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ * CSV row formatting cost.
+ *
+ *   bench_csv_row [-n rows]
+ *
+ * Formats a 1 Hz drive (every column present) with csv_row_format() and
+ * with the per-field snprintf reference, checks the bytes agree, and
+ * prints rows per second, ns and cycles per row. On the host both run on a
+ * double FPU and glibc printf; on the Cortex-M33 the reference goes through
+ * newlib's soft-double printf, so the gap there is wider.
+ */
+#include "bench_common.h"
+#include "csv_row.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void report(const char* name, double secs, uint64_t cycles, size_t n, size_t bytes) {
+    printf("%-26s %8.3f s  %10.0f rows/s  %7.1f ns/row  %7.1f cycles/row  (%zu bytes)\n",
+           name, secs, (double)n / secs, secs * 1e9 / (double)n, (double)cycles / (double)n, bytes);
+}
+
+int main(int argc, char** argv) {
+    size_t n = 2000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            n = (size_t)strtoul(argv[++i], NULL, 10);
+        }
+    }
+
+    gps_fix_t* fixes = malloc(n * sizeof(*fixes));
+    if (!fixes) {
+        fprintf(stderr, "cannot allocate fixes\n");
+        return 1;
+    }
+    /* 12 m/s round a 5 km circle, climbing and descending */
+    for (size_t i = 0; i < n; i++) {
+        double a = (double)i * 12.0 / 5000.0;
+        uint32_t t = (uint32_t)(i % 86400);
+        gps_fix_t* f = &fixes[i];
+        memset(f, 0, sizeof(*f));
+        f->flags = GPS_FIX_VALID | GPS_HAS_ALL;
+        f->year = 2025;
+        f->month = 6;
+        f->day = (uint8_t)(1 + (i / 86400) % 28);
+        f->hour = (uint8_t)(t / 3600);
+        f->minute = (uint8_t)(t / 60 % 60);
+        f->second = (uint8_t)(t % 60);
+        f->latitude = 47.285233 + 5000.0 * (1.0 - cos(a)) / 111195.0;
+        f->longitude = 8.565265 + 5000.0 * sin(a) / 75445.0;
+        f->speed_kmh = 43.2f + (float)(i % 7) * 0.13f;
+        f->altitude_m = 499.6f + 40.0f * (float)sin(a * 3.0);
+        f->course_deg = (float)fmod(a * 57.29577951308232 + 90.0, 360.0);
+        f->satellites = (uint8_t)(6 + i % 6);
+        f->hdop = 0.8f + (float)(i % 5) * 0.07f;
+        f->fix_quality = 1;
+    }
+    printf("rows: %zu\n", n);
+
+    char line[CSV_ROW_MAX], ref[CSV_ROW_MAX];
+    for (size_t i = 0; i < n; i += 997) {
+        csv_row_format(line, &fixes[i]);
+        csv_row_format_printf(ref, &fixes[i]);
+        if (strcmp(line, ref) != 0) {
+            fprintf(stderr, "row %zu differs:\n  %s  %s", i, ref, line);
+            return 1;
+        }
+    }
+
+    double t0 = bench_now_s();
+    uint64_t c0 = bench_cycles();
+    size_t bytes = 0;
+    for (size_t i = 0; i < n; i++) bytes += csv_row_format_printf(line, &fixes[i]);
+    report("snprintf per field", bench_now_s() - t0, bench_cycles() - c0, n, bytes);
+
+    t0 = bench_now_s();
+    c0 = bench_cycles();
+    bytes = 0;
+    for (size_t i = 0; i < n; i++) bytes += csv_row_format(line, &fixes[i]);
+    report("csv_row_format()", bench_now_s() - t0, bench_cycles() - c0, n, bytes);
+
+    free(fixes);
+    return 0;
+}
@@ -0,0 +1,128 @@
+/*
+ * Distance kernel cost: haversine in double and float32, and the cached
+ * equirectangular fast path.
+ *
+ *   bench_geo_utils [-n pairs]
+ *
+ * Times haversine_distance_m(), haversine_distance_mf(),
+ * haversine_distance_e6_mf(), geo_distance_fast_m() and
+ * geo_distance_fast_mf() over consecutive points of a 1 Hz track, the
+ * pairs the filter's speed gate sees, and prints ns and cycles per call.
+ * Then times geo_distance_batch() at each SIMD level the CPU has, on the
+ * same track as double arrays.
+ * On the host both paths use the double-precision FPU; the float kernels
+ * pay off on single-precision FPUs such as the Cortex-M33.
+ */
+#include "bench_common.h"
+#include "geo_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void report(const char* name, double secs, uint64_t cycles, size_t calls, double sum) {
+    printf("%-28s %8.3f s  %6.2f ns/call  %6.1f cycles/call  (sum %.0f m)\n",
+           name, secs, secs * 1e9 / (double)calls, (double)cycles / (double)calls, sum);
+}
+
+int main(int argc, char** argv) {
+    size_t n = 10000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            n = (size_t)strtoul(argv[++i], NULL, 10);
+        }
+    }
+
+    /* Random walk from the reference fix, steps of up to about 20 m */
+    int32_t* lat = malloc((n + 1) * sizeof(*lat));
+    int32_t* lon = malloc((n + 1) * sizeof(*lon));
+    if (!lat || !lon) {
+        fprintf(stderr, "cannot allocate track\n");
+        return 1;
+    }
+    uint32_t seed = 1;
+    lat[0] = 47285233;
+    lon[0] = 8565265;
+    for (size_t i = 1; i <= n; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        lat[i] = lat[i - 1] + (int32_t)(seed >> 24) - 128;
+        lon[i] = lon[i - 1] + (int32_t)((seed >> 16) & 0xFF) - 128;
+    }
+    printf("pairs: %zu\n", n);
+
+    double t0, sum;
+    uint64_t c0;
+
+    sum = 0.0;
+    t0 = bench_now_s();
+    c0 = bench_cycles();
+    for (size_t i = 0; i < n; i++) {
+        sum += haversine_distance_m(lat[i] / 1e6, lon[i] / 1e6, lat[i + 1] / 1e6, lon[i + 1] / 1e6);
+    }
+    report("haversine_distance_m()", bench_now_s() - t0, bench_cycles() - c0, n, sum);
+
+    sum = 0.0;
+    t0 = bench_now_s();
+    c0 = bench_cycles();
+    for (size_t i = 0; i < n; i++) {
+        sum += haversine_distance_mf(lat[i] / 1e6f, lon[i] / 1e6f, lat[i + 1] / 1e6f, lon[i + 1] / 1e6f);
+    }
+    report("haversine_distance_mf()", bench_now_s() - t0, bench_cycles() - c0, n, sum);
+
+    sum = 0.0;
+    t0 = bench_now_s();
+    c0 = bench_cycles();
+    for (size_t i = 0; i < n; i++) {
+        sum += haversine_distance_e6_mf(lat[i], lon[i], lat[i + 1], lon[i + 1]);
+    }
+    report("haversine_distance_e6_mf()", bench_now_s() - t0, bench_cycles() - c0, n, sum);
+
+    geo_cos_cache_t cache = {0};
+    sum = 0.0;
+    t0 = bench_now_s();
+    c0 = bench_cycles();
+    for (size_t i = 0; i < n; i++) {
+        sum += geo_distance_fast_m(&cache, lat[i], lon[i], lat[i + 1], lon[i + 1]);
+    }
+    report("geo_distance_fast_m()", bench_now_s() - t0, bench_cycles() - c0, n, sum);
+
+    geo_cos_cache_t cache_f = {0};
+    sum = 0.0;
+    t0 = bench_now_s();
+    c0 = bench_cycles();
+    for (size_t i = 0; i < n; i++) {
+        sum += geo_distance_fast_mf(&cache_f, lat[i], lon[i], lat[i + 1], lon[i + 1]);
+    }
+    report("geo_distance_fast_mf()", bench_now_s() - t0, bench_cycles() - c0, n, sum);
+
+    double* dlat = malloc((n + 1) * sizeof(*dlat));
+    double* dlon = malloc((n + 1) * sizeof(*dlon));
+    double* out = malloc(n * sizeof(*out));
+    if (!dlat || !dlon || !out) {
+        fprintf(stderr, "cannot allocate track\n");
+        return 1;
+    }
+    for (size_t i = 0; i <= n; i++) {
+        dlat[i] = lat[i] / 1e6;
+        dlon[i] = lon[i] / 1e6;
+    }
+    static const char* const names[] = {
+        "geo_distance_batch() scalar", "geo_distance_batch() SSE2", "geo_distance_batch() AVX2",
+    };
+    for (int s = GEO_SIMD_SCALAR; s <= (int)geo_simd_available(); s++) {
+        t0 = bench_now_s();
+        c0 = bench_cycles();
+        geo_distance_batch_simd((geo_simd_t)s, dlat, dlon, n + 1, out);
+        double secs = bench_now_s() - t0;
+        uint64_t cycles = bench_cycles() - c0;
+        sum = 0.0;
+        for (size_t i = 0; i < n; i++) sum += out[i];
+        report(names[s], secs, cycles, n, sum);
+    }
+
+    free(dlat);
+    free(dlon);
+    free(out);
+    free(lat);
+    free(lon);
+    return 0;
+}
@@ -0,0 +1,119 @@
+/*
+ * gps_filter cost per fix.
+ *
+ *   bench_gps_filter [-n fixes]
+ *
+ * Feeds a noisy 1 Hz drive (3 m jitter, a 150 m spike every 37 fixes)
+ * through gps_filter_process() and, separately, through gps_kalman_step()
+ * with gps_kalman_position(), and prints ns and cycles per fix. The first
+ * line is the implied-speed gate unless the library was configured with
+ * -DGPS_FILTER_KALMAN=ON; the second is the same with every rejection
+ * traced, the cost of leaving the trace on. Host numbers only rank the two; on the Pico
+ * count cycles with the DWT cycle counter around the same calls.
+ */
+#include "bench_common.h"
+#include "gps_filter.h"
+#include "gps_kalman.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint64_t rng = 88172645463325252ull;
+
+static double gauss(void) {
+    double u[2];
+    for (int k = 0; k < 2; k++) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        u[k] = ((double)(rng >> 11) + 0.5) / 9007199254740992.0;
+    }
+    return sqrt(-2.0 * log(u[0])) * cos(6.283185307179586 * u[1]);
+}
+
+static void report(const char* name, double secs, uint64_t cycles, size_t n, size_t kept) {
+    printf("%-32s %8.3f s  %7.1f ns/fix  %7.1f cycles/fix  (%zu/%zu kept)\n",
+           name, secs, secs * 1e9 / (double)n, (double)cycles / (double)n, kept, n);
+}
+
+int main(int argc, char** argv) {
+    size_t n = 2000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            n = (size_t)strtoul(argv[++i], NULL, 10);
+        }
+    }
+
+    gps_fix_t* fixes = malloc(n * sizeof(*fixes));
+    if (!fixes) {
+        fprintf(stderr, "cannot allocate fixes\n");
+        return 1;
+    }
+    /* 12 m/s round a 5 km circle */
+    for (size_t i = 0; i < n; i++) {
+        double a = (double)i * 12.0 / 5000.0;
+        double off = (i % 37 == 36) ? 150.0 : 0.0;
+        gps_fix_t* f = &fixes[i];
+        memset(f, 0, sizeof(*f));
+        f->flags = GPS_FIX_VALID | GPS_HAS_LATLON | GPS_HAS_SPEED | GPS_HAS_TIME | GPS_HAS_HDOP;
+        f->latitude = 47.285233 + (5000.0 * (1.0 - cos(a)) + 3.0 * gauss() + off) / 111195.0;
+        f->longitude = 8.565265 + (5000.0 * sin(a) + 3.0 * gauss()) / 75445.0;
+        f->speed_kmh = 43.2f;
+        f->hdop = 1.0f;
+        f->unix_ms = 1700000000000ull + (uint64_t)i * 1000;
+    }
+    printf("fixes: %zu\n", n);
+
+    double t0;
+    uint64_t c0;
+    size_t kept = 0;
+    gps_filter_t filter;
+    gps_filter_init(&filter);
+    t0 = bench_now_s();
+    c0 = bench_cycles();
+    for (size_t i = 0; i < n; i++) {
+        kept += gps_filter_process(&filter, &fixes[i]) == FILTER_ACCEPT;
+    }
+    report(GPS_FILTER_KALMAN ? "gps_filter_process() Kalman" : "gps_filter_process() speed gate",
+           bench_now_s() - t0, bench_cycles() - c0, n, kept);
+
+    static gps_filter_trace_t trace;
+    gps_filter_init(&filter);
+    gps_filter_set_trace(&filter, &trace, ~GPS_FILTER_TRACE_MASK(FILTER_ACCEPT));
+    kept = 0;
+    t0 = bench_now_s();
+    c0 = bench_cycles();
+    for (size_t i = 0; i < n; i++) {
+        kept += gps_filter_process(&filter, &fixes[i]) == FILTER_ACCEPT;
+    }
+    report("gps_filter_process() + trace", bench_now_s() - t0, bench_cycles() - c0, n, kept);
+
+    gps_fix_packed_t* packed = malloc(n * sizeof(*packed));
+    if (!packed) {
+        fprintf(stderr, "cannot allocate fixes\n");
+        return 1;
+    }
+    for (size_t i = 0; i < n; i++) gps_fix_pack(&fixes[i], &packed[i]);
+
+    gps_kalman_t kf;
+    gps_kalman_init(&kf);
+    int32_t lat, lon;
+    int64_t sum = 0;
+    kept = 0;
+    t0 = bench_now_s();
+    c0 = bench_cycles();
+    for (size_t i = 0; i < n; i++) {
+        const gps_fix_packed_t* p = &packed[i];
+        kept += gps_kalman_step(&kf, p->lat_e6, p->lon_e6, p->hdop_c / 100.0f,
+                                fixes[i].unix_ms) != GPS_KALMAN_REJECTED;
+        gps_kalman_position(&kf, &lat, &lon);
+        sum += lat;
+    }
+    report("gps_kalman_step() + position", bench_now_s() - t0, bench_cycles() - c0, n, kept);
+    if (sum == 42) printf("\n");
+
+    free(packed);
+    free(fixes);
+    return 0;
+}
@@ -0,0 +1,224 @@
+/*
+ * NMEA parser throughput on a raw capture.
+ *
+ *   bench_nmea_parser [capture.nmea]     mmap and parse a field capture
+ *   bench_nmea_parser -m 1024            synthesize a 1 GB capture in memory
+ *
+ * Compares line-by-line nmea_parser_feed() (with the NUL-terminated copy it
+ * needs), nmea_parser_feed_bytes() in 4 KB chunks, and
+ * nmea_parser_parse_buffer() over the whole mapping, then the per-sentence
+ * decode cost of the GGA/RMC lines alone (field parsing, no I/O), and the
+ * parser's own statistics for the capture with per-type cycle accounting.
+ */
+#include "bench_common.h"
+#include "nmea_parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define OUT_CAP   4096
+#define CHUNK     4096
+
+static void report(const char* name, double secs, size_t bytes, size_t sentences, size_t fixes) {
+    printf("%-22s %8.3f s  %9.1f MB/s  %12.0f sentences/s  %11.0f fixes/s  (%zu fixes)\n",
+           name, secs, (double)bytes / secs / 1e6, (double)sentences / secs,
+           (double)fixes / secs, fixes);
+}
+
+static size_t run_feed_lines(const char* buf, size_t len) {
+    nmea_parser_t* p = nmea_parser_create();
+    char line[NMEA_MAX_SENTENCE_LEN + 3];
+    size_t fixes = 0;
+    const char* cur = buf;
+    const char* end = buf + len;
+    while (cur < end) {
+        const char* nl = memchr(cur, '\n', (size_t)(end - cur));
+        if (!nl) break;
+        size_t n = (size_t)(nl - cur);
+        if (n < sizeof(line)) {
+            memcpy(line, cur, n);
+            line[n] = '\0';
+            if (nmea_parser_feed(p, line) == NMEA_RESULT_FIX_READY) {
+                gps_fix_t fix;
+                if (nmea_parser_get_fix(p, &fix)) fixes++;
+            }
+        }
+        cur = nl + 1;
+    }
+    nmea_parser_destroy(p);
+    return fixes;
+}
+
+static void count_fix(const gps_fix_t* fix, void* user) {
+    (void)fix;
+    (*(size_t*)user)++;
+}
+
+static size_t run_feed_bytes(const char* buf, size_t len) {
+    nmea_parser_t* p = nmea_parser_create();
+    size_t fixes = 0;
+    nmea_parser_set_fix_callback(p, count_fix, &fixes);
+    for (size_t off = 0; off < len; off += CHUNK) {
+        size_t n = (len - off < CHUNK) ? len - off : CHUNK;
+        nmea_parser_feed_bytes(p, (const uint8_t*)buf + off, n);
+    }
+    nmea_parser_destroy(p);
+    return fixes;
+}
+
+static size_t run_parse_buffer(const char* buf, size_t len) {
+    nmea_parser_t* p = nmea_parser_create();
+    static gps_fix_t out[OUT_CAP];
+    size_t fixes = 0, pos = 0;
+    while (pos < len) {
+        size_t consumed = 0;
+        fixes += nmea_parser_parse_buffer(p, buf + pos, len - pos, out, OUT_CAP, &consumed);
+        if (consumed == 0) break;
+        pos += consumed;
+    }
+    nmea_parser_destroy(p);
+    return fixes;
+}
+
+/* Decode only the GGA/RMC sentences, already split into NUL-terminated lines */
+static void run_decode_cost(const char* buf, size_t len) {
+    size_t cap = 1 << 16, n = 0;
+    char (*lines)[NMEA_MAX_SENTENCE_LEN + 1] = malloc(cap * sizeof(*lines));
+    if (!lines) return;
+    const char* cur = buf;
+    const char* end = buf + len;
+    while (cur < end && n < cap) {
+        const char* nl = memchr(cur, '\n', (size_t)(end - cur));
+        if (!nl) break;
+        size_t l = (size_t)(nl - cur);
+        if (l > 0 && cur[l - 1] == '\r') l--;
+        if (l >= 6 && l <= NMEA_MAX_SENTENCE_LEN &&
+            (memcmp(cur + 3, "GGA", 3) == 0 || memcmp(cur + 3, "RMC", 3) == 0)) {
+            memcpy(lines[n], cur, l);
+            lines[n][l] = '\0';
+            n++;
+        }
+        cur = nl + 1;
+    }
+    if (n == 0) {
+        free(lines);
+        return;
+    }
+
+    enum { ROUNDS = 50 };
+    nmea_parser_t* p = nmea_parser_create();
+    size_t fixes = 0;
+    double t0 = bench_now_s();
+    uint64_t c0 = bench_cycles();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < n; i++) {
+            if (nmea_parser_feed(p, lines[i]) == NMEA_RESULT_FIX_READY) fixes++;
+        }
+    }
+    uint64_t c1 = bench_cycles();
+    double t1 = bench_now_s();
+    nmea_parser_destroy(p);
+    free(lines);
+
+    double total = (double)n * ROUNDS;
+    printf("%-22s %8.1f ns/sentence  %8.0f cycles/sentence  (%zu GGA/RMC x %d, %zu fixes)\n",
+           "GGA/RMC decode", (t1 - t0) * 1e9 / total, (double)(c1 - c0) / total, n, ROUNDS, fixes);
+}
+
+static uint32_t cycle_counter(void) {
+    return (uint32_t)bench_cycles();
+}
+
+/* feed_bytes() again with the cycle counter on: drop reasons and per-type cost */
+static void run_stats(const char* buf, size_t len, double plain_secs) {
+    static const char* const names[NMEA_STATS_TYPES] = {
+        "GGA", "RMC", "GSA", "GSV", "VTG", "GLL", "ZDA", "other"
+    };
+    nmea_parser_t* p = nmea_parser_create();
+    nmea_parser_set_cycle_counter(p, cycle_counter);
+    double t0 = bench_now_s();
+    for (size_t off = 0; off < len; off += CHUNK) {
+        size_t n = (len - off < CHUNK) ? len - off : CHUNK;
+        nmea_parser_feed_bytes(p, (const uint8_t*)buf + off, n);
+    }
+    double t1 = bench_now_s();
+    nmea_parser_stats_t st;
+    nmea_parser_get_stats(p, &st);
+    nmea_parser_destroy(p);
+
+    printf("stats: epochs %u  too_long %u  no_checksum %u  bad_checksum %u  unwanted %u  "
+           "too_short %u  bad_time %u\n",
+           (unsigned)st.epochs, (unsigned)st.too_long, (unsigned)st.no_checksum,
+           (unsigned)st.bad_checksum, (unsigned)st.unwanted, (unsigned)st.too_short,
+           (unsigned)st.bad_time);
+    for (int i = 0; i < NMEA_STATS_TYPES; i++) {
+        if (st.sentences[i] == 0) continue;
+        printf("stats: %-5s %10u sentences  %6.0f cycles/sentence\n", names[i],
+               (unsigned)st.sentences[i], (double)st.cycles[i] / (double)st.sentences[i]);
+    }
+    printf("stats: feed_bytes() with cycle counter %.3f s (%.3f s without)\n", t1 - t0, plain_secs);
+}
+
+int main(int argc, char** argv) {
+    const char* path = NULL;
+    size_t mb = 64;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            mb = (size_t)strtoul(argv[++i], NULL, 10);
+        } else {
+            path = argv[i];
+        }
+    }
+
+    const char* buf;
+    size_t len;
+    char* synth = NULL;
+    if (path) {
+        buf = bench_map_file(path, &len);
+        if (!buf) {
+            fprintf(stderr, "cannot map %s\n", path);
+            return 1;
+        }
+        printf("capture: %s (%zu bytes)\n", path, len);
+    } else {
+        synth = malloc(mb << 20);
+        if (!synth) {
+            fprintf(stderr, "cannot allocate %zu MB\n", mb);
+            return 1;
+        }
+        size_t epochs = 0;
+        len = bench_make_nmea_capture(synth, mb << 20, &epochs, NULL);
+        buf = synth;
+        printf("capture: synthetic, %zu epochs x 8 sentences (%zu bytes)\n", epochs, len);
+    }
+
+    size_t sentences = bench_count_lines(buf, len);
+    double t0, t1;
+    size_t fixes;
+
+    t0 = bench_now_s();
+    fixes = run_feed_lines(buf, len);
+    t1 = bench_now_s();
+    report("feed() per line", t1 - t0, len, sentences, fixes);
+
+    t0 = bench_now_s();
+    fixes = run_feed_bytes(buf, len);
+    t1 = bench_now_s();
+    report("feed_bytes() 4KB", t1 - t0, len, sentences, fixes);
+    double feed_bytes_secs = t1 - t0;
+
+    t0 = bench_now_s();
+    fixes = run_parse_buffer(buf, len);
+    t1 = bench_now_s();
+    report("parse_buffer()", t1 - t0, len, sentences, fixes);
+
+    run_decode_cost(buf, len);
+    run_stats(buf, len, feed_bytes_secs);
+
+    if (path) {
+        bench_unmap_file(buf, len);
+    } else {
+        free(synth);
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * GGA/RMC decode cost of one NMEA decode profile.
+ *
+ *   bench_nmea_profile_<profile> [-n epochs]
+ *
+ * Built once per GPS_PARSER_PROFILES entry; the nmea_profile_report target
+ * runs all of them after printing the parser's code size per profile.
+ * Only GGA and RMC are fed, so the numbers isolate field decoding.
+ */
+#include "bench_common.h"
+#include "nmea_parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ROUNDS 20
+
+static const char* const profile_names[] = { "full", "track", "position" };
+
+static uint32_t cycle_counter(void) {
+    return (uint32_t)bench_cycles();
+}
+
+int main(int argc, char** argv) {
+    size_t epochs = 20000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            epochs = (size_t)strtoul(argv[++i], NULL, 10);
+        }
+    }
+
+    size_t cap = epochs * 480;
+    char* capture = malloc(cap);
+    char (*lines)[NMEA_MAX_SENTENCE_LEN + 1] = malloc(epochs * 2 * sizeof(*lines));
+    if (!capture || !lines) {
+        fprintf(stderr, "cannot allocate capture buffers\n");
+        return 1;
+    }
+    size_t len = bench_make_nmea_capture(capture, cap, &epochs, NULL);
+
+    /* GGA and RMC only, as NUL-terminated lines without CR/LF */
+    size_t n = 0;
+    const char* cur = capture;
+    const char* end = capture + len;
+    while (cur < end) {
+        const char* nl = memchr(cur, '\n', (size_t)(end - cur));
+        if (!nl) break;
+        size_t l = (size_t)(nl - cur);
+        if (l > 0 && cur[l - 1] == '\r') l--;
+        if (l >= 6 && l <= NMEA_MAX_SENTENCE_LEN &&
+            (memcmp(cur + 3, "GGA", 3) == 0 || memcmp(cur + 3, "RMC", 3) == 0)) {
+            memcpy(lines[n], cur, l);
+            lines[n][l] = '\0';
+            n++;
+        }
+        cur = nl + 1;
+    }
+
+    nmea_parser_t* p = nmea_parser_create();
+    size_t fixes = 0;
+    double t0 = bench_now_s();
+    uint64_t c0 = bench_cycles();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < n; i++) {
+            if (nmea_parser_feed(p, lines[i]) == NMEA_RESULT_FIX_READY) fixes++;
+        }
+    }
+    uint64_t c1 = bench_cycles();
+    double t1 = bench_now_s();
+
+    /* Dispatch-only cost (built-in parsers) from the parser's own counters */
+    nmea_parser_reset_stats(p);
+    nmea_parser_set_cycle_counter(p, cycle_counter);
+    for (size_t i = 0; i < n; i++) nmea_parser_feed(p, lines[i]);
+    nmea_parser_stats_t st;
+    nmea_parser_get_stats(p, &st);
+    nmea_parser_destroy(p);
+
+    double total = (double)n * ROUNDS;
+    printf("%-9s sentences 0x%02X fields 0x%02X  %6.1f ns/sentence  %5.0f cycles/sentence  "
+           "GGA %4.0f RMC %4.0f cycles in parser  (%zu fixes)\n",
+           profile_names[NMEA_PROFILE], (unsigned)NMEA_BUILD_SENTENCES,
+           (unsigned)(NMEA_BUILD_FIELDS | GPS_HAS_TIME),
+           (t1 - t0) * 1e9 / total, (double)(c1 - c0) / total,
+           st.sentences[0] ? (double)st.cycles[0] / st.sentences[0] : 0.0,
+           st.sentences[1] ? (double)st.cycles[1] / st.sentences[1] : 0.0, fixes);
+
+    free(lines);
+    free(capture);
+    return 0;
+}
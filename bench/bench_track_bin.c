@@ -0,0 +1,137 @@
+/*
+ * Binary track format: size and streaming decode cost.
+ *
+ *   bench_track_bin [-n fixes] [-o track.bin]
+ *
+ * Encodes a 1 Hz drive (every column present) and prints bytes per fix
+ * against the CSV rows for the same fixes, then decodes the stream in 4 KB
+ * chunks as tools/track2csv reads a file: track_bin_decode() alone, and
+ * with gps_fix_unpack() and csv_row_format() on every fix. -o writes the
+ * encoded stream, a file track2csv accepts.
+ */
+#include "bench_common.h"
+#include "track_bin.h"
+#include "csv_row.h"
+#include "data_storage.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHUNK 4096
+
+static void report(const char* name, double secs, uint64_t cycles, size_t n, size_t bytes) {
+    printf("%-30s %8.3f s  %10.0f fixes/s  %7.1f MB/s  %6.1f ns/fix  %6.1f cycles/fix\n",
+           name, secs, (double)n / secs, (double)bytes / secs / 1e6, secs * 1e9 / (double)n,
+           (double)cycles / (double)n);
+}
+
+/* Feeds stream[0..len) to the decoder in CHUNK pieces through a carry
+   buffer; returns fixes, *csv_bytes gets the CSV size when formatting */
+static size_t decode(const uint8_t* stream, size_t len, bool format, size_t* csv_bytes) {
+    static uint8_t buf[CHUNK + TRACK_BIN_RECORD_MAX];
+    track_bin_decoder_t dec;
+    track_bin_decoder_init(&dec, stream, len);
+    size_t pos = TRACK_BIN_HEADER_SIZE, have = 0, fixes = 0;
+    *csv_bytes = 0;
+    while (pos < len) {
+        size_t n = len - pos < CHUNK ? len - pos : CHUNK;
+        memcpy(buf + have, stream + pos, n);
+        pos += n;
+        have += n;
+        size_t off = 0, used;
+        track_bin_status_t st;
+        while ((st = track_bin_decode(&dec, buf + off, have - off, &used)) != TRACK_BIN_NEED_MORE) {
+            if (st == TRACK_BIN_FIX) {
+                fixes++;
+                if (format) {
+                    char line[CSV_ROW_MAX];
+                    gps_fix_t fix;
+                    gps_fix_unpack(&dec.fix, &fix);
+                    *csv_bytes += csv_row_format(line, &fix);
+                }
+            }
+            off += used;
+        }
+        memmove(buf, buf + off, have - off);
+        have -= off;
+    }
+    return fixes;
+}
+
+int main(int argc, char** argv) {
+    size_t n = 2000000;
+    const char* out_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            n = (size_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        }
+    }
+
+    gps_fix_packed_t* fixes = malloc(n * sizeof(*fixes));
+    uint8_t* stream = malloc(TRACK_BIN_HEADER_SIZE + n * 40);
+    if (!fixes || !stream) {
+        fprintf(stderr, "cannot allocate fixes\n");
+        return 1;
+    }
+    /* 12 m/s round a 5 km circle, climbing and descending */
+    size_t csv_bytes = strlen(CSV_HEADER);
+    for (size_t i = 0; i < n; i++) {
+        double a = (double)i * 12.0 / 5000.0;
+        gps_fix_t f;
+        memset(&f, 0, sizeof(f));
+        f.flags = GPS_FIX_VALID | GPS_HAS_ALL;
+        f.unix_ms = 1750000000000ull + (uint64_t)i * 1000;
+        f.latitude = 47.285233 + 5000.0 * (1.0 - cos(a)) / 111195.0;
+        f.longitude = 8.565265 + 5000.0 * sin(a) / 75445.0;
+        f.speed_kmh = 43.2f + (float)(i % 7) * 0.13f;
+        f.altitude_m = 499.6f + 40.0f * (float)sin(a * 3.0);
+        f.course_deg = (float)fmod(a * 57.29577951308232 + 90.0, 360.0);
+        f.satellites = (uint8_t)(6 + i / 60 % 6);
+        f.hdop = 0.8f + (float)(i / 45 % 5) * 0.07f;
+        f.fix_quality = 1;
+        gps_fix_pack(&f, &fixes[i]);
+        char line[CSV_ROW_MAX];
+        gps_fix_unpack(&fixes[i], &f);
+        csv_bytes += csv_row_format(line, &f);
+    }
+    printf("fixes: %zu\n", n);
+
+    track_bin_encoder_t enc;
+    track_bin_encoder_init(&enc);
+    double t0 = bench_now_s();
+    uint64_t c0 = bench_cycles();
+    size_t len = track_bin_write_header(stream);
+    for (size_t i = 0; i < n; i++) len += track_bin_encode_fix(&enc, &fixes[i], stream + len);
+    report("track_bin_encode_fix()", bench_now_s() - t0, bench_cycles() - c0, n, len);
+    printf("size: %.2f bytes/fix binary, %.2f bytes/fix CSV\n",
+           (double)len / (double)n, (double)csv_bytes / (double)n);
+
+    size_t out_bytes;
+    t0 = bench_now_s();
+    c0 = bench_cycles();
+    size_t got = decode(stream, len, false, &out_bytes);
+    report("track_bin_decode()", bench_now_s() - t0, bench_cycles() - c0, got, len);
+
+    t0 = bench_now_s();
+    c0 = bench_cycles();
+    got = decode(stream, len, true, &out_bytes);
+    report("decode + csv_row_format()", bench_now_s() - t0, bench_cycles() - c0, got, len);
+    if (got != n || out_bytes + strlen(CSV_HEADER) != csv_bytes) {
+        fprintf(stderr, "decoded %zu of %zu fixes, %zu CSV bytes\n", got, n, out_bytes);
+        return 1;
+    }
+
+    if (out_path) {
+        FILE* f = fopen(out_path, "wb");
+        if (!f || fwrite(stream, 1, len, f) != len || fclose(f) != 0) {
+            perror(out_path);
+            return 1;
+        }
+    }
+    free(stream);
+    free(fixes);
+    return 0;
+}
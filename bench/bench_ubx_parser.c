@@ -0,0 +1,194 @@
+/*
+ * UBX NAV-PVT vs NMEA GGA+RMC decode throughput.
+ *
+ *   bench_ubx_parser [-n epochs]
+ *
+ * Builds the same track twice — as GGA+RMC text and as NAV-PVT frames —
+ * and times nmea_parser_feed() per line, nmea_parser_feed_bytes(),
+ * ubx_parser_feed_bytes() and gps_stream_feed(). Also prints bytes per
+ * epoch and the update rate each encoding allows at 9600 baud.
+ */
+#include "bench_common.h"
+#include "nmea_parser.h"
+#include "ubx_parser.h"
+#include "gps_stream.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHUNK 4096
+#define UART_BYTES_PER_S 960.0   /* 9600 baud, 8N1 */
+
+static void put_i32(uint8_t* p, int32_t v) {
+    uint32_t u = (uint32_t)v;
+    p[0] = (uint8_t)u;
+    p[1] = (uint8_t)(u >> 8);
+    p[2] = (uint8_t)(u >> 16);
+    p[3] = (uint8_t)(u >> 24);
+}
+
+/* NAV-PVT frames for the epochs of the synthetic NMEA capture */
+static size_t make_ubx_capture(uint8_t* buf, size_t size, size_t epochs) {
+    size_t pos = 0;
+    uint8_t p[UBX_NAV_PVT_LEN];
+    for (size_t e = 0; e < epochs; e++) {
+        uint32_t tod = (uint32_t)(e % 86400);
+        memset(p, 0, sizeof(p));
+        p[4] = 2025 & 0xFF;
+        p[5] = 2025 >> 8;
+        p[6] = 6;
+        p[7] = 15;
+        p[8] = (uint8_t)(tod / 3600);
+        p[9] = (uint8_t)(tod / 60 % 60);
+        p[10] = (uint8_t)(tod % 60);
+        p[11] = 0x07;
+        p[20] = 3;
+        p[21] = 0x01;
+        p[23] = 9;
+        put_i32(p + 24, 85652650 + (int32_t)(e % 100000) * 10);
+        put_i32(p + 28, 472852330 + (int32_t)(e % 100000) * 10);
+        put_i32(p + 36, 499600);
+        put_i32(p + 60, 13900);
+        put_i32(p + 64, 4500000);
+        p[76] = 101;
+        size_t n = ubx_frame_encode(UBX_CLASS_NAV, UBX_ID_NAV_PVT, p, sizeof(p), buf + pos, size - pos);
+        if (n == 0) break;
+        pos += n;
+    }
+    return pos;
+}
+
+/* Keep only GGA and RMC lines, in place */
+static size_t keep_gga_rmc(char* buf, size_t len) {
+    size_t out = 0;
+    const char* cur = buf;
+    const char* end = buf + len;
+    while (cur < end) {
+        const char* nl = memchr(cur, '\n', (size_t)(end - cur));
+        if (!nl) break;
+        size_t n = (size_t)(nl - cur) + 1;
+        if (n > 6 && (memcmp(cur + 3, "GGA", 3) == 0 || memcmp(cur + 3, "RMC", 3) == 0)) {
+            memmove(buf + out, cur, n);
+            out += n;
+        }
+        cur = nl + 1;
+    }
+    return out;
+}
+
+static void report(const char* name, double secs, size_t bytes, size_t fixes, size_t epochs) {
+    printf("%-24s %8.3f s  %8.1f MB/s  %11.0f fixes/s  %6.1f ns/fix  (%zu/%zu fixes)\n",
+           name, secs, (double)bytes / secs / 1e6, (double)fixes / secs,
+           secs * 1e9 / (double)(fixes ? fixes : 1), fixes, epochs);
+}
+
+static void count_fix(const gps_fix_t* fix, void* user) {
+    (void)fix;
+    (*(size_t*)user)++;
+}
+
+int main(int argc, char** argv) {
+    size_t epochs = 1000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            epochs = (size_t)strtoul(argv[++i], NULL, 10);
+        }
+    }
+
+    /* NMEA: 8 sentences of roughly 60 bytes per epoch before filtering */
+    size_t nmea_cap = epochs * 480;
+    char* nmea = malloc(nmea_cap);
+    if (!nmea) {
+        fprintf(stderr, "cannot allocate capture buffers\n");
+        return 1;
+    }
+    size_t nmea_len = bench_make_nmea_capture(nmea, nmea_cap, &epochs, NULL);
+    nmea_len = keep_gga_rmc(nmea, nmea_len);
+
+    size_t ubx_cap = epochs * (UBX_NAV_PVT_LEN + UBX_FRAME_OVERHEAD);
+    uint8_t* ubx = malloc(ubx_cap);
+    if (!ubx) {
+        fprintf(stderr, "cannot allocate capture buffers\n");
+        return 1;
+    }
+    size_t ubx_len = make_ubx_capture(ubx, ubx_cap, epochs);
+
+    double nmea_epoch_bytes = (double)nmea_len / (double)epochs;
+    double ubx_epoch_bytes = (double)ubx_len / (double)epochs;
+    printf("epochs: %zu\n", epochs);
+    printf("GGA+RMC: %6.1f bytes/epoch -> %4.1f Hz max at 9600 baud\n",
+           nmea_epoch_bytes, UART_BYTES_PER_S / nmea_epoch_bytes);
+    printf("NAV-PVT: %6.1f bytes/epoch -> %4.1f Hz max at 9600 baud\n",
+           ubx_epoch_bytes, UART_BYTES_PER_S / ubx_epoch_bytes);
+
+    double t0, t1;
+    size_t fixes;
+
+    /* nmea_parser_feed() per line, NUL-terminated copy as a line reader would make */
+    {
+        nmea_parser_t* p = nmea_parser_create();
+        char line[NMEA_MAX_SENTENCE_LEN + 3];
+        const char* cur = nmea;
+        const char* end = nmea + nmea_len;
+        fixes = 0;
+        t0 = bench_now_s();
+        while (cur < end) {
+            const char* nl = memchr(cur, '\n', (size_t)(end - cur));
+            if (!nl) break;
+            size_t n = (size_t)(nl - cur);
+            if (n < sizeof(line)) {
+                memcpy(line, cur, n);
+                line[n] = '\0';
+                if (nmea_parser_feed(p, line) == NMEA_RESULT_FIX_READY) fixes++;
+            }
+            cur = nl + 1;
+        }
+        t1 = bench_now_s();
+        nmea_parser_destroy(p);
+        report("nmea_parser_feed()", t1 - t0, nmea_len, fixes, epochs);
+    }
+
+    {
+        nmea_parser_t* p = nmea_parser_create();
+        fixes = 0;
+        nmea_parser_set_fix_callback(p, count_fix, &fixes);
+        t0 = bench_now_s();
+        for (size_t off = 0; off < nmea_len; off += CHUNK) {
+            size_t n = (nmea_len - off < CHUNK) ? nmea_len - off : CHUNK;
+            nmea_parser_feed_bytes(p, (const uint8_t*)nmea + off, n);
+        }
+        t1 = bench_now_s();
+        nmea_parser_destroy(p);
+        report("nmea_parser_feed_bytes()", t1 - t0, nmea_len, fixes, epochs);
+    }
+
+    {
+        ubx_parser_t* p = ubx_parser_create();
+        fixes = 0;
+        t0 = bench_now_s();
+        for (size_t off = 0; off < ubx_len; off += CHUNK) {
+            size_t n = (ubx_len - off < CHUNK) ? ubx_len - off : CHUNK;
+            fixes += (size_t)ubx_parser_feed_bytes(p, ubx + off, n);
+        }
+        t1 = bench_now_s();
+        ubx_parser_destroy(p);
+        report("ubx_parser_feed_bytes()", t1 - t0, ubx_len, fixes, epochs);
+    }
+
+    {
+        gps_stream_t* s = gps_stream_create();
+        fixes = 0;
+        t0 = bench_now_s();
+        for (size_t off = 0; off < ubx_len; off += CHUNK) {
+            size_t n = (ubx_len - off < CHUNK) ? ubx_len - off : CHUNK;
+            fixes += (size_t)gps_stream_feed(s, ubx + off, n);
+        }
+        t1 = bench_now_s();
+        gps_stream_destroy(s);
+        report("gps_stream_feed() UBX", t1 - t0, ubx_len, fixes, epochs);
+    }
+
+    free(nmea);
+    free(ubx);
+    return 0;
+}
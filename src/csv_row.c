@@ -0,0 +1,168 @@
+#include "csv_row.h"
+#include <stdio.h>
+#include <string.h>
+
+static const uint32_t POW5[] = {1, 5, 25, 125, 625, 3125, 15625};
+static const uint32_t POW10[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+/* Decimal digits of v, zero-padded to at least width */
+static char* put_uint(char* p, uint32_t v, int width) {
+    char tmp[10];
+    int n = 0;
+    do {
+        tmp[n++] = (char)('0' + v % 10u);
+        v /= 10u;
+    } while (v);
+    while (n < width) tmp[n++] = '0';
+    while (n) *p++ = tmp[--n];
+    return p;
+}
+
+/* printf("%.*f") of the value m * 2^e (m < 2^53, value < 2^31).
+   x = m * 5^d is at most 67 bits, kept as hi:lo; the row value is
+   x * 2^(e + d), rounded half to even when that shifts bits out. */
+static char* put_fixed(char* p, bool neg, uint64_t m, int e, unsigned d) {
+    uint64_t lo32 = (m & 0xFFFFFFFFu) * POW5[d];
+    uint64_t hi32 = (m >> 32) * POW5[d];
+    uint64_t lo = lo32 + (hi32 << 32);
+    uint64_t hi = (hi32 >> 32) + (lo < lo32);
+    int s = -(e + (int)d);
+    uint64_t n;
+
+    if (s <= 0) {
+        n = lo << -s;
+    } else if (s >= 128) {
+        n = 0;                      /* below 2^-60: no tie possible */
+    } else {
+        uint64_t rem_hi, rem_lo, half_hi, half_lo;
+        if (s < 64) {
+            n = (lo >> s) | (hi << (64 - s));
+            rem_hi = 0;
+            rem_lo = lo & ((1ull << s) - 1);
+            half_hi = 0;
+            half_lo = 1ull << (s - 1);
+        } else {
+            n = s == 64 ? hi : hi >> (s - 64);
+            rem_hi = s == 64 ? 0 : hi & ((1ull << (s - 64)) - 1);
+            rem_lo = lo;
+            half_hi = s == 64 ? 0 : 1ull << (s - 65);
+            half_lo = s == 64 ? 1ull << 63 : 0;
+        }
+        if (rem_hi > half_hi || (rem_hi == half_hi && rem_lo > half_lo) ||
+            (rem_hi == half_hi && rem_lo == half_lo && (n & 1u))) {
+            n++;
+        }
+    }
+
+    if (neg) *p++ = '-';
+    p = put_uint(p, (uint32_t)(n / POW10[d]), 1);
+    if (d > 0) {
+        *p++ = '.';
+        p = put_uint(p, (uint32_t)(n % POW10[d]), (int)d);
+    }
+    return p;
+}
+
+static char* put_printf(char* p, double v, unsigned d) {
+    char field[CSV_ROW_FIELD_MAX + 1];
+    int n = snprintf(field, sizeof(field), "%.*f", (int)d, v);
+    if (n < 0) return p;
+    if (n > CSV_ROW_FIELD_MAX) n = CSV_ROW_FIELD_MAX;
+    memcpy(p, field, (size_t)n);
+    return p + n;
+}
+
+static char* put_double(char* p, double v, unsigned d) {
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    int be = (int)(bits >> 52) & 0x7FF;
+    uint64_t m = bits & ((1ull << 52) - 1);
+    if (be - 1023 >= 31) return put_printf(p, v, d);
+    if (be) {
+        m |= 1ull << 52;
+    } else {
+        be = 1;
+    }
+    return put_fixed(p, bits >> 63, m, be - 1075, d);
+}
+
+static char* put_float(char* p, float v, unsigned d) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    int be = (int)(bits >> 23) & 0xFF;
+    uint32_t m = bits & ((1u << 23) - 1);
+    if (be - 127 >= 31) return put_printf(p, (double)v, d);
+    if (be) {
+        m |= 1u << 23;
+    } else {
+        be = 1;
+    }
+    return put_fixed(p, bits >> 31, m, be - 150, d);
+}
+
+size_t csv_row_format(char* line, const gps_fix_t* fix) {
+    char* p = line;
+
+    if ((fix->flags & GPS_HAS_DATE) && (fix->flags & GPS_HAS_TIME)) {
+        p = put_uint(p, fix->year, 4);
+        *p++ = '-';
+        p = put_uint(p, fix->month, 2);
+        *p++ = '-';
+        p = put_uint(p, fix->day, 2);
+        *p++ = 'T';
+        p = put_uint(p, fix->hour, 2);
+        *p++ = ':';
+        p = put_uint(p, fix->minute, 2);
+        *p++ = ':';
+        p = put_uint(p, fix->second, 2);
+        *p++ = 'Z';
+    }
+    *p++ = ',';
+    if (fix->flags & GPS_HAS_LATLON) p = put_double(p, fix->latitude, 6);
+    *p++ = ',';
+    if (fix->flags & GPS_HAS_LATLON) p = put_double(p, fix->longitude, 6);
+    *p++ = ',';
+    if (fix->flags & GPS_HAS_SPEED) p = put_float(p, fix->speed_kmh, 2);
+    *p++ = ',';
+    if (fix->flags & GPS_HAS_ALTITUDE) p = put_float(p, fix->altitude_m, 1);
+    *p++ = ',';
+    if (fix->flags & GPS_HAS_COURSE) p = put_float(p, fix->course_deg, 1);
+    *p++ = ',';
+    if (fix->flags & GPS_HAS_LATLON) p = put_uint(p, fix->satellites, 1);
+    *p++ = ',';
+    if (fix->flags & GPS_HAS_HDOP) p = put_float(p, fix->hdop, 2);
+    *p++ = ',';
+    p = put_uint(p, fix->fix_quality, 1);
+    *p++ = '\n';
+    *p = '\0';
+    return (size_t)(p - line);
+}
+
+size_t csv_row_format_printf(char* line, const gps_fix_t* fix) {
+    char* p = line;
+
+    if ((fix->flags & GPS_HAS_DATE) && (fix->flags & GPS_HAS_TIME)) {
+        p += snprintf(p, CSV_ROW_FIELD_MAX + 1, "%04u-%02u-%02uT%02u:%02u:%02uZ",
+                      fix->year, fix->month, fix->day,
+                      fix->hour, fix->minute, fix->second);
+    }
+    *p++ = ',';
+    if (fix->flags & GPS_HAS_LATLON) p = put_printf(p, fix->latitude, 6);
+    *p++ = ',';
+    if (fix->flags & GPS_HAS_LATLON) p = put_printf(p, fix->longitude, 6);
+    *p++ = ',';
+    if (fix->flags & GPS_HAS_SPEED) p = put_printf(p, (double)fix->speed_kmh, 2);
+    *p++ = ',';
+    if (fix->flags & GPS_HAS_ALTITUDE) p = put_printf(p, (double)fix->altitude_m, 1);
+    *p++ = ',';
+    if (fix->flags & GPS_HAS_COURSE) p = put_printf(p, (double)fix->course_deg, 1);
+    *p++ = ',';
+    if (fix->flags & GPS_HAS_LATLON) p += snprintf(p, 4, "%u", fix->satellites);
+    *p++ = ',';
+    if (fix->flags & GPS_HAS_HDOP) p = put_printf(p, (double)fix->hdop, 2);
+    *p++ = ',';
+    p += snprintf(p, 4, "%u", fix->fix_quality);
+    *p++ = '\n';
+    *p = '\0';
+    return (size_t)(p - line);
+}
@@ -0,0 +1,24 @@
+#ifndef CSV_ROW_H
+#define CSV_ROW_H
+
+#include "nmea_parser.h"
+#include <stddef.h>
+
+/* One CSV data row (specs/data-storage.md) per gps_fix_t, without printf.
+   Doubles and floats are taken apart into mantissa and exponent and rounded
+   to the column's decimals in integer arithmetic, half to even on exact
+   ties as printf does, so the bytes match csv_row_format_printf(). Values
+   of 2^31 and above, infinities and NaN go through snprintf; any field is
+   cut at CSV_ROW_FIELD_MAX characters, which only |value| >= 1e23 reaches. */
+
+#define CSV_ROW_MAX        256      /* line buffer, newline and NUL included */
+#define CSV_ROW_FIELD_MAX  31
+
+/* Writes the row with its '\n' and a NUL into line[CSV_ROW_MAX], returns
+   its length */
+size_t csv_row_format(char* line, const gps_fix_t* fix);
+/* The same row from one snprintf per field: the reference for the
+   equivalence test and the benchmark */
+size_t csv_row_format_printf(char* line, const gps_fix_t* fix);
+
+#endif
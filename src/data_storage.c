@@ -1,32 +1,69 @@
 #include "data_storage.h"
+#include "csv_row.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 
-static void make_filename(char* buf, size_t buf_size, int number) {
+static const char* extension(storage_format_t format) {
+    return format == STORAGE_FORMAT_BINARY ? "bin" : "csv";
+}
+
+static void make_filename(char* buf, size_t buf_size, int number, storage_format_t format) {
     if (number == 0) {
-        snprintf(buf, buf_size, "%s.csv", STORAGE_BASE_FILENAME);
+        snprintf(buf, buf_size, "%s.%s", STORAGE_BASE_FILENAME, extension(format));
     } else {
-        snprintf(buf, buf_size, "%s_%d.csv", STORAGE_BASE_FILENAME, number);
+        snprintf(buf, buf_size, "%s_%d.%s", STORAGE_BASE_FILENAME, number, extension(format));
     }
 }
 
-static int find_highest_file_number(void) {
-    /* Check track.csv first */
-    int highest = -1;
-    if (hal_fs_exists("track.csv")) {
-        highest = 0;
+static bool equals_nocase(const char* a, const char* b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        char ca = (a[i] >= 'A' && a[i] <= 'Z') ? (char)(a[i] + 32) : a[i];
+        char cb = (b[i] >= 'A' && b[i] <= 'Z') ? (char)(b[i] + 32) : b[i];
+        if (ca != cb) return false;
     }
-    for (int i = 1; i <= STORAGE_MAX_FILE_NUMBER; i++) {
-        char name[32];
-        make_filename(name, sizeof(name), i);
-        if (hal_fs_exists(name)) {
-            highest = i;
+    return true;
+}
+
+/* The number make_filename() gives name: 0 for track.csv, 1..999 for
+   track_N.csv; -1 for any other name. Case is ignored, as in FAT lookups. */
+static int file_number(const char* name, storage_format_t format) {
+    size_t base = strlen(STORAGE_BASE_FILENAME);
+    if (!equals_nocase(name, STORAGE_BASE_FILENAME, base)) return -1;
+    const char* p = name + base;
+    int number = 0;
+    if (*p == '_') {
+        p++;
+        if (*p < '1' || *p > '9') return -1;
+        while (*p >= '0' && *p <= '9') {
+            number = number * 10 + (*p++ - '0');
+            if (number > STORAGE_MAX_FILE_NUMBER) return -1;
         }
     }
-    return highest;
+    if (*p++ != '.') return -1;
+    const char* ext = extension(format);
+    return equals_nocase(p, ext, strlen(ext) + 1) ? number : -1;
 }
 
-static bool file_ends_with_newline(const char* filename) {
+/* What init needs from the root directory, gathered in one listing */
+typedef struct {
+    storage_format_t format;
+    int highest;                /* -1: no track file */
+    bool dirty;
+} dir_scan_t;
+
+static bool scan_entry(const char* name, void* user) {
+    dir_scan_t* scan = user;
+    int number = file_number(name, scan->format);
+    if (number > scan->highest) scan->highest = number;
+    if (equals_nocase(name, STORAGE_DIRTY_FILENAME, sizeof(STORAGE_DIRTY_FILENAME))) {
+        scan->dirty = true;
+    }
+    return true;
+}
+
+/* A clean session ends with '\n' (CSV) or a whole end record (binary) */
+static bool file_ends_cleanly(const char* filename, storage_format_t format) {
     hal_file_t f = hal_fs_open(filename, "rb");
     if (!f) return false;
     int size = hal_fs_size(f);
@@ -34,9 +71,18 @@ static bool file_ends_with_newline(const char* filename) {
         hal_fs_close(f);
         return (size == 0); /* empty file is OK */
     }
-    int byte = hal_fs_read_byte_at_end(f);
+    bool clean;
+    if (format == STORAGE_FORMAT_BINARY) {
+        uint8_t tail[TRACK_BIN_END_SIZE];
+        clean = size >= TRACK_BIN_HEADER_SIZE + TRACK_BIN_END_SIZE
+             && hal_fs_seek(f, (uint32_t)size - TRACK_BIN_END_SIZE) == 0
+             && hal_fs_read(f, tail, sizeof(tail)) == (int)sizeof(tail)
+             && track_bin_is_end(tail, sizeof(tail));
+    } else {
+        clean = hal_fs_read_byte_at_end(f) == '\n';
+    }
     hal_fs_close(f);
-    return byte == '\n';
+    return clean;
 }
 
 static bool file_is_empty(const char* filename) {
@@ -47,14 +93,150 @@ static bool file_is_empty(const char* filename) {
     return size == 0;
 }
 
+#if STORAGE_PREALLOC_SIZE > 0
+/* _dirty holds "<file> <length>\n", the length of the data synced so far.
+   Past it the file runs on into the reserved extent, whose bytes are
+   whatever the card held, so recovery cannot tell data from them by
+   content. The length is fixed-width, so a sync rewrites the line in place
+   ("r+b") without reallocating the marker's cluster. */
+static storage_error_t write_marker(data_storage_t* storage, const char* mode) {
+    char line[48];
+    int n = snprintf(line, sizeof(line), "%s %010lu\n",
+                     storage->filename, (unsigned long)storage->file_size);
+    hal_file_t f = hal_fs_open(STORAGE_DIRTY_FILENAME, mode);
+    if (!f) return STORAGE_ERR_SYNC;
+    int err = hal_fs_write(f, line, (size_t)n);
+    if (hal_fs_close(f) != 0 || err != 0) return STORAGE_ERR_SYNC;
+    return STORAGE_OK;
+}
+
+/* Truncates the file _dirty names to the length it records */
+static void recover_length(void) {
+    char line[48];
+    hal_file_t f = hal_fs_open(STORAGE_DIRTY_FILENAME, "rb");
+    if (!f) return;
+    int n = hal_fs_read(f, line, sizeof(line) - 1);
+    hal_fs_close(f);
+    if (n <= 0) return;
+    line[n] = '\0';
+    char* sp = strchr(line, ' ');
+    if (!sp) return;
+    *sp = '\0';
+    char* end;
+    unsigned long length = strtoul(sp + 1, &end, 10);
+    if (end == sp + 1 || *end != '\n') return;
+
+    f = hal_fs_open(line, "r+b");
+    if (!f) return;
+    int size = hal_fs_size(f);
+    if (size > 0 && (unsigned long)size > length && hal_fs_seek(f, (uint32_t)length) == 0) {
+        hal_fs_truncate(f);
+    }
+    hal_fs_close(f);
+}
+#else
+/* _dirty only marks the session open: the file ends at its data */
+static storage_error_t write_marker(data_storage_t* storage, const char* mode) {
+    (void)storage;
+    hal_file_t f = hal_fs_open(STORAGE_DIRTY_FILENAME, mode);
+    if (!f) return STORAGE_ERR_SYNC;
+    hal_fs_close(f);
+    return STORAGE_OK;
+}
+#endif
+
+/* Seeks to the end of the data, first reserving STORAGE_PREALLOC_SIZE past
+   it when less than a quarter of that is left: at 1 Hz CSV one extent
+   lasts under an hour. Best effort: a failure is retried an extent later,
+   and meanwhile the file grows per write as without it. */
+static int reserve(data_storage_t* storage) {
+#if STORAGE_PREALLOC_SIZE > 0
+    if (storage->file_size + STORAGE_PREALLOC_SIZE / 4 <= storage->reserved_end) return 0;
+    storage->reserved_end = storage->file_size + STORAGE_PREALLOC_SIZE;
+    hal_fs_expand(storage->file, storage->reserved_end);
+    return hal_fs_seek(storage->file, storage->file_size);
+#else
+    (void)storage;
+    return 0;
+#endif
+}
+
+#if STORAGE_BUFFER_SECTORS > 0
+#define BUF_SIZE (STORAGE_BUFFER_SECTORS * STORAGE_SECTOR_SIZE)
+
+static storage_error_t write_out(data_storage_t* storage, size_t n) {
+    if (n == 0) return STORAGE_OK;
+    if (hal_fs_write(storage->file, storage->buf, n) < 0) return STORAGE_ERR_WRITE;
+    storage->file_size += (uint32_t)n;
+    storage->buf_len = (uint16_t)(storage->buf_len - n);
+    memmove(storage->buf, storage->buf + n, storage->buf_len);
+    return reserve(storage) == 0 ? STORAGE_OK : STORAGE_ERR_WRITE;
+}
+
+/* Full buffer: write up to the last sector boundary it reaches; the tail of
+   the sector stays buffered */
+static storage_error_t flush_sectors(data_storage_t* storage) {
+    uint32_t tail = (storage->file_size + storage->buf_len) % STORAGE_SECTOR_SIZE;
+    return write_out(storage, storage->buf_len - tail);
+}
+
+static storage_error_t flush_all(data_storage_t* storage) {
+    return write_out(storage, storage->buf_len);
+}
+
+static storage_error_t append(data_storage_t* storage, const void* data, size_t len) {
+    const char* p = data;
+    while (len > 0) {
+        size_t n = BUF_SIZE - storage->buf_len;
+        if (n > len) n = len;
+        memcpy(storage->buf + storage->buf_len, p, n);
+        storage->buf_len = (uint16_t)(storage->buf_len + n);
+        p += n;
+        len -= n;
+        if (storage->buf_len == BUF_SIZE) {
+            storage_error_t err = flush_sectors(storage);
+            if (err != STORAGE_OK) return err;
+        }
+    }
+    return STORAGE_OK;
+}
+#else
+static storage_error_t flush_all(data_storage_t* storage) {
+    (void)storage;
+    return STORAGE_OK;
+}
+
+static storage_error_t append(data_storage_t* storage, const void* data, size_t len) {
+    if (hal_fs_write(storage->file, data, len) < 0) return STORAGE_ERR_WRITE;
+    storage->file_size += (uint32_t)len;
+    return reserve(storage) == 0 ? STORAGE_OK : STORAGE_ERR_WRITE;
+}
+#endif
+
+/* Init failed with the file open: give the handle back to the HAL pool */
+static storage_error_t abandon(data_storage_t* storage, storage_error_t err) {
+    hal_fs_close(storage->file);
+    storage->file = NULL;
+    storage->is_open = false;
+    return err;
+}
+
 storage_error_t data_storage_init(data_storage_t* storage) {
+    return data_storage_init_format(storage, STORAGE_FORMAT_CSV);
+}
+
+storage_error_t data_storage_init_format(data_storage_t* storage, storage_format_t format) {
     if (!storage) return STORAGE_ERR_MOUNT;
     memset(storage, 0, sizeof(data_storage_t));
+    storage->format = format;
+    track_bin_encoder_init(&storage->enc);
 
     if (hal_fs_mount() != 0) return STORAGE_ERR_MOUNT;
 
-    int highest = find_highest_file_number();
-    bool dirty = hal_fs_exists(STORAGE_DIRTY_FILENAME);
+    dir_scan_t scan = {format, -1, false};
+    if (hal_fs_list_dir("", scan_entry, &scan) != 0) return STORAGE_ERR_MOUNT;
+    int highest = scan.highest;
+    bool dirty = scan.dirty;
     bool need_new_file = false;
     bool need_header = false;
 
@@ -63,18 +245,20 @@ storage_error_t data_storage_init(data_storage_t* storage) {
         highest = 0;
         need_new_file = true;
         need_header = true;
-    } else if (dirty) {
-        /* Unclean shutdown — rotate */
-        need_new_file = true;
-        need_header = true;
-        hal_fs_remove(STORAGE_DIRTY_FILENAME);
     } else {
-        /* Check if last file is clean */
         char name[32];
-        make_filename(name, sizeof(name), highest);
-        if (file_is_empty(name)) {
+        make_filename(name, sizeof(name), highest, format);
+        if (dirty) {
+            /* Unclean shutdown — cut the file back to its synced data, rotate */
+#if STORAGE_PREALLOC_SIZE > 0
+            recover_length();
+#endif
+            need_new_file = true;
+            need_header = true;
+            hal_fs_remove(STORAGE_DIRTY_FILENAME);
+        } else if (file_is_empty(name)) {
             need_header = true;
-        } else if (!file_ends_with_newline(name)) {
+        } else if (!file_ends_cleanly(name, format)) {
             /* Incomplete write — rotate */
             need_new_file = true;
             need_header = true;
@@ -83,124 +267,162 @@ storage_error_t data_storage_init(data_storage_t* storage) {
 
     if (need_new_file) {
         /* Rotate to next file number */
-        highest = find_highest_file_number() + 1;
+        highest = scan.highest + 1;
     }
 
     if (highest > STORAGE_MAX_FILE_NUMBER) {
         return STORAGE_ERR_TOO_MANY_FILES;
     }
 
-    make_filename(storage->filename, sizeof(storage->filename), highest);
+    make_filename(storage->filename, sizeof(storage->filename), highest, format);
 
-    /* Open for append */
-    storage->file = hal_fs_open(storage->filename, "ab");
+    /* Writes continue at the end of the data, inside the reserved extent */
+    storage->file = hal_fs_open(storage->filename, need_new_file ? "wb" : "r+b");
     if (!storage->file) return STORAGE_ERR_OPEN;
     storage->is_open = true;
+    int size = hal_fs_size(storage->file);
+    storage->file_size = size > 0 ? (uint32_t)size : 0;
+    storage->synced_len = storage->file_size;
+
+    /* Create the dirty marker, with the length to recover to, before the
+       extent makes the file longer than its data */
+    if (write_marker(storage, "wb") != STORAGE_OK) return abandon(storage, STORAGE_ERR_OPEN);
+    reserve(storage);
+    if (hal_fs_seek(storage->file, storage->file_size) != 0) {
+        return abandon(storage, STORAGE_ERR_OPEN);
+    }
 
     if (need_header) {
-        if (hal_fs_write(storage->file, CSV_HEADER, strlen(CSV_HEADER)) < 0) {
-            return STORAGE_ERR_WRITE;
-        }
+        uint8_t header[TRACK_BIN_HEADER_SIZE];
+        storage_error_t err = format == STORAGE_FORMAT_BINARY
+            ? append(storage, header, track_bin_write_header(header))
+            : append(storage, CSV_HEADER, strlen(CSV_HEADER));
+        if (err != STORAGE_OK) return abandon(storage, STORAGE_ERR_WRITE);
     }
 
-    /* Create dirty marker */
-    hal_file_t dirty_f = hal_fs_open(STORAGE_DIRTY_FILENAME, "wb");
-    if (dirty_f) hal_fs_close(dirty_f);
-
     storage->last_sync_ms = hal_time_ms();
     return STORAGE_OK;
 }
 
-storage_error_t data_storage_write_fix(data_storage_t* storage, const gps_fix_t* fix) {
-    if (!storage || !storage->is_open) return STORAGE_ERR_WRITE;
-
-    char line[256];
-    int pos = 0;
-
-    /* Timestamp */
-    if ((fix->flags & GPS_HAS_DATE) && (fix->flags & GPS_HAS_TIME)) {
-        pos += snprintf(line + pos, sizeof(line) - (size_t)pos,
-                        "%04u-%02u-%02uT%02u:%02u:%02uZ",
-                        fix->year, fix->month, fix->day,
-                        fix->hour, fix->minute, fix->second);
-    }
-    line[pos++] = ',';
+/* Bytes written so far, on the card or still buffered */
+static uint32_t data_length(const data_storage_t* storage) {
+#if STORAGE_BUFFER_SECTORS > 0
+    return storage->file_size + storage->buf_len;
+#else
+    return storage->file_size;
+#endif
+}
 
-    /* Latitude */
-    if (fix->flags & GPS_HAS_LATLON) {
-        pos += snprintf(line + pos, sizeof(line) - (size_t)pos, "%.6f", fix->latitude);
+/* Write out and sync if the interval elapsed since the last sync. With
+   nothing written since, the card is left alone: a parked tracker polls
+   this on every loop pass. */
+static storage_error_t sync_if_due(data_storage_t* storage) {
+    uint32_t now = hal_time_ms();
+    if (now - storage->last_sync_ms >= STORAGE_SYNC_INTERVAL_S * 1000u) {
+        storage->last_sync_ms = now;
+        if (data_length(storage) == storage->synced_len) {
+            return STORAGE_OK;
+        }
+        if (flush_all(storage) != STORAGE_OK) {
+            return STORAGE_ERR_WRITE;
+        }
+        if (hal_fs_sync(storage->file) != 0) {
+            return STORAGE_ERR_SYNC;
+        }
+#if STORAGE_PREALLOC_SIZE > 0
+        /* Only after the data it covers is on the card */
+        if (write_marker(storage, "r+b") != STORAGE_OK) {
+            return STORAGE_ERR_SYNC;
+        }
+#endif
+        storage->synced_len = storage->file_size;
     }
-    line[pos++] = ',';
 
-    /* Longitude */
-    if (fix->flags & GPS_HAS_LATLON) {
-        pos += snprintf(line + pos, sizeof(line) - (size_t)pos, "%.6f", fix->longitude);
-    }
-    line[pos++] = ',';
+    return STORAGE_OK;
+}
 
-    /* Speed */
-    if (fix->flags & GPS_HAS_SPEED) {
-        pos += snprintf(line + pos, sizeof(line) - (size_t)pos, "%.2f", (double)fix->speed_kmh);
+/* Append one record, then write out and sync if the interval elapsed */
+static storage_error_t write_record(data_storage_t* storage, const void* data, size_t len) {
+    if (append(storage, data, len) != STORAGE_OK) {
+        return STORAGE_ERR_WRITE;
     }
-    line[pos++] = ',';
+    return sync_if_due(storage);
+}
 
-    /* Altitude */
-    if (fix->flags & GPS_HAS_ALTITUDE) {
-        pos += snprintf(line + pos, sizeof(line) - (size_t)pos, "%.1f", (double)fix->altitude_m);
-    }
-    line[pos++] = ',';
+storage_error_t data_storage_write_fix(data_storage_t* storage, const gps_fix_t* fix) {
+    if (!storage || !storage->is_open) return STORAGE_ERR_WRITE;
 
-    /* Course */
-    if (fix->flags & GPS_HAS_COURSE) {
-        pos += snprintf(line + pos, sizeof(line) - (size_t)pos, "%.1f", (double)fix->course_deg);
+    if (storage->format == STORAGE_FORMAT_BINARY) {
+        gps_fix_packed_t packed;
+        gps_fix_pack(fix, &packed);
+        return data_storage_write_packed(storage, &packed);
     }
-    line[pos++] = ',';
+    char line[CSV_ROW_MAX];
+    size_t len = csv_row_format(line, fix);
+    return write_record(storage, line, len);
+}
 
-    /* Satellites */
-    if (fix->flags & GPS_HAS_LATLON) {
-        pos += snprintf(line + pos, sizeof(line) - (size_t)pos, "%u", fix->satellites);
-    }
-    line[pos++] = ',';
+storage_error_t data_storage_write_packed(data_storage_t* storage, const gps_fix_packed_t* fix) {
+    if (!storage || !storage->is_open || !fix) return STORAGE_ERR_WRITE;
 
-    /* HDOP */
-    if (fix->flags & GPS_HAS_HDOP) {
-        pos += snprintf(line + pos, sizeof(line) - (size_t)pos, "%.2f", (double)fix->hdop);
+    if (storage->format == STORAGE_FORMAT_BINARY) {
+        uint8_t record[TRACK_BIN_RECORD_MAX];
+        return write_record(storage, record, track_bin_encode_fix(&storage->enc, fix, record));
     }
-    line[pos++] = ',';
-
-    /* Fix quality */
-    pos += snprintf(line + pos, sizeof(line) - (size_t)pos, "%u", fix->fix_quality);
-    line[pos++] = '\n';
-    line[pos] = '\0';
+    gps_fix_t unpacked;
+    gps_fix_unpack(fix, &unpacked);
+    return data_storage_write_fix(storage, &unpacked);
+}
 
-    if (hal_fs_write(storage->file, line, (size_t)pos) < 0) {
-        return STORAGE_ERR_WRITE;
-    }
+storage_error_t data_storage_write_comment(data_storage_t* storage, const char* text, size_t len) {
+    if (!storage || !storage->is_open || !text) return STORAGE_ERR_WRITE;
+    if (len > STORAGE_MAX_COMMENT_LEN) return STORAGE_ERR_WRITE;
 
-    /* Sync if interval elapsed */
-    uint32_t now = hal_time_ms();
-    if (now - storage->last_sync_ms >= STORAGE_SYNC_INTERVAL_S * 1000u) {
-        if (hal_fs_sync(storage->file) != 0) {
-            return STORAGE_ERR_SYNC;
-        }
-        storage->last_sync_ms = now;
+    if (storage->format == STORAGE_FORMAT_BINARY) {
+        uint8_t record[TRACK_BIN_RECORD_MAX];
+        return write_record(storage, record, track_bin_encode_comment(text, len, record));
     }
+    char line[STORAGE_MAX_COMMENT_LEN + 3];
+    line[0] = '#';
+    line[1] = ' ';
+    memcpy(line + 2, text, len);
+    line[len + 2] = '\n';
+    return write_record(storage, line, len + 3);
+}
 
-    return STORAGE_OK;
+storage_error_t data_storage_poll(data_storage_t* storage) {
+    if (!storage || !storage->is_open) return STORAGE_ERR_WRITE;
+    return sync_if_due(storage);
 }
 
 storage_error_t data_storage_shutdown(data_storage_t* storage) {
     if (!storage || !storage->is_open) return STORAGE_ERR_WRITE;
 
-    hal_fs_sync(storage->file);
+    storage_error_t err = STORAGE_OK;
+    if (storage->format == STORAGE_FORMAT_BINARY) {
+        uint8_t end[TRACK_BIN_END_SIZE];
+        err = append(storage, end, track_bin_encode_end(&storage->enc, end));
+    }
+    if (err == STORAGE_OK) err = flush_all(storage);
+    if (err == STORAGE_OK) {
+        /* Drop what is left of the reserved extent */
+        hal_fs_truncate(storage->file);
+        hal_fs_sync(storage->file);
+#if STORAGE_PREALLOC_SIZE > 0
+        /* A power loss before _dirty is removed must not cut the tail off */
+        write_marker(storage, "r+b");
+#endif
+    }
     hal_fs_close(storage->file);
     storage->file = NULL;
     storage->is_open = false;
 
-    hal_fs_remove(STORAGE_DIRTY_FILENAME);
+    /* After a failed write the position is not the end of the data: keep
+       _dirty, and the next init recovers to the synced length instead */
+    if (err == STORAGE_OK) hal_fs_remove(STORAGE_DIRTY_FILENAME);
     hal_fs_unmount();
 
-    return STORAGE_OK;
+    return err;
 }
 
 const char* data_storage_get_filename(const data_storage_t* storage) {
@@ -2,12 +2,35 @@
 #define DATA_STORAGE_H
 
 #include "nmea_parser.h"
+#include "gps_fix_packed.h"
+#include "track_bin.h"
 #include "hal/hal.h"
 
 #define STORAGE_SYNC_INTERVAL_S   5
 #define STORAGE_MAX_FILE_NUMBER   999
 #define STORAGE_DIRTY_FILENAME    "_dirty"
 #define STORAGE_BASE_FILENAME     "track"
+#define STORAGE_MAX_COMMENT_LEN   160
+#define STORAGE_SECTOR_SIZE       512
+
+/* Rows collect in a buffer of this many sectors and go to the card only as
+   writes that end on a sector boundary of the file (and, after the first,
+   start on one), so FatFs never reads back a partial sector. The sync
+   deadline and shutdown write out the rest. 0 writes each row through. */
+#ifndef STORAGE_BUFFER_SECTORS
+#define STORAGE_BUFFER_SECTORS    2
+#endif
+/* Each session reserves this many bytes past the data when it opens the
+   file (hal_fs_expand()), and again whenever the data comes within a
+   quarter of the end, so FatFs allocates no clusters and updates no FAT
+   while rows are written within them. Only a new, empty file gets one
+   contiguous extent (f_expand()); later reservations extend the cluster
+   chain, wherever the free clusters are. Shutdown truncates the file to its
+   data; after a power loss the next init truncates it to the length the
+   last sync recorded in _dirty. 0 grows the file per write. */
+#ifndef STORAGE_PREALLOC_SIZE
+#define STORAGE_PREALLOC_SIZE     (256u * 1024u)
+#endif
 #define CSV_HEADER                "timestamp,latitude,longitude,speed_kmh,altitude_m,course_deg,satellites,hdop,fix_quality\n"
 
 typedef enum {
@@ -20,15 +43,46 @@ typedef enum {
     STORAGE_ERR_TOO_MANY_FILES
 } storage_error_t;
 
+/* CSV rows in track*.csv, or binary records (track_bin.h) in track*.bin
+   that tools/track2csv turns back into the same CSV */
+typedef enum {
+    STORAGE_FORMAT_CSV = 0,
+    STORAGE_FORMAT_BINARY
+} storage_format_t;
+
 typedef struct {
     hal_file_t file;
     char filename[32];
     uint32_t last_sync_ms;
+    uint32_t synced_len;        /* data length at the last sync */
     bool is_open;
+    storage_format_t format;
+    track_bin_encoder_t enc;
+    uint32_t file_size;         /* bytes of data written to the file */
+#if STORAGE_PREALLOC_SIZE > 0
+    uint32_t reserved_end;      /* end of the extent last reserved */
+#endif
+#if STORAGE_BUFFER_SECTORS > 0
+    uint16_t buf_len;
+    char buf[STORAGE_BUFFER_SECTORS * STORAGE_SECTOR_SIZE];
+#endif
 } data_storage_t;
 
+/* Same as data_storage_init_format(storage, STORAGE_FORMAT_CSV) */
 storage_error_t data_storage_init(data_storage_t* storage);
+storage_error_t data_storage_init_format(data_storage_t* storage, storage_format_t format);
+/* The binary format logs gps_fix_pack(fix), which takes date and time from
+   fix->unix_ms */
 storage_error_t data_storage_write_fix(data_storage_t* storage, const gps_fix_t* fix);
+/* Writes the same row data_storage_write_fix() writes for the unpacked fix */
+storage_error_t data_storage_write_packed(data_storage_t* storage, const gps_fix_packed_t* fix);
+/* Appends "# <text>\n" (text up to STORAGE_MAX_COMMENT_LEN, no newline), e.g.
+   the filter trailer before shutdown; CSV readers skip '#' lines */
+storage_error_t data_storage_write_comment(data_storage_t* storage, const char* text, size_t len);
+/* Writes out and syncs the buffered rows once STORAGE_SYNC_INTERVAL_S has
+   passed since the last sync, as a write does. Call from the main loop so
+   rows do not wait in RAM for the next write while no fixes are logged. */
+storage_error_t data_storage_poll(data_storage_t* storage);
 storage_error_t data_storage_shutdown(data_storage_t* storage);
 const char*     data_storage_get_filename(const data_storage_t* storage);
 
@@ -1,5 +1,8 @@
 #include "gps_filter.h"
 #include "geo_utils.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 void gps_filter_init(gps_filter_t* filter) {
@@ -7,83 +10,244 @@ void gps_filter_init(gps_filter_t* filter) {
     memset(filter, 0, sizeof(gps_filter_t));
     filter->state = FILTER_STATE_COLD_START;
     filter->has_last_fix = false;
+    filter->course_ref_ddeg = GPS_FILTER_NO_COURSE;
 }
 
-static double fix_to_epoch_seconds(const gps_fix_t* fix) {
-    double s = 0.0;
-    if (fix->flags & GPS_HAS_DATE) {
-        /* Approximate days since epoch for comparison — exact value not needed,
-           just consistent offsets between fixes */
-        s += (double)fix->year * 365.25 * 86400.0;
-        s += (double)fix->month * 30.44 * 86400.0;
-        s += (double)fix->day * 86400.0;
+void gps_filter_set_trace(gps_filter_t* filter, gps_filter_trace_t* trace, uint32_t mask) {
+    if (!filter) return;
+    filter->trace = trace;
+    if (trace) {
+        memset(trace, 0, sizeof(*trace));
+        trace->mask = mask;
+    }
+}
+
+void gps_filter_set_policy(gps_filter_t* filter, const gps_filter_policy_t* policy) {
+    if (!filter) return;
+    if (policy) {
+        filter->policy = *policy;
+    } else {
+        memset(&filter->policy, 0, sizeof(filter->policy));
     }
-    s += (double)fix->hour * 3600.0;
-    s += (double)fix->minute * 60.0;
-    s += (double)fix->second;
-    s += (double)fix->centisecond / 100.0;
-    return s;
 }
 
-static bool is_stationary(const gps_fix_t* fix) {
+#define WINDOW_MAX_OFFSET_E6 (1 << 24)  /* keeps n * sum of squares in 64 bits */
+
+static bool is_slow(const gps_fix_packed_t* fix) {
     if (!(fix->flags & GPS_HAS_SPEED)) return true;
-    return fix->speed_kmh < GPS_FILTER_STATIONARY_THRESHOLD_KMH;
+    return fix->speed_ckmh < GPS_FILTER_STATIONARY_THRESHOLD_KMH * 100.0f;
 }
 
-gps_filter_result_t gps_filter_process(gps_filter_t* filter, const gps_fix_t* fix) {
-    if (!filter || !fix) return FILTER_REJECT_INVALID;
+static void window_reset(gps_filter_window_t* w, const gps_fix_packed_t* fix) {
+    memset(w, 0, sizeof(*w));
+    w->ref_lat_e6 = fix->lat_e6;
+    w->ref_lon_e6 = fix->lon_e6;
+    w->m_per_e6_lon = geo_m_per_e6_lon_f(fix->lat_e6);
+}
 
-    /* 1. Validity gate */
-    if (!(fix->flags & GPS_FIX_VALID)) return FILTER_REJECT_INVALID;
-    if (!(fix->flags & GPS_HAS_LATLON)) return FILTER_REJECT_INVALID;
+static void window_offset(const gps_filter_window_t* w, const gps_fix_packed_t* fix,
+                          int32_t* dlat, int32_t* dlon) {
+    *dlat = fix->lat_e6 - w->ref_lat_e6;
+    *dlon = geo_dlon_e6(w->ref_lon_e6, fix->lon_e6);
+}
+
+/* Add a fix at most once per GPS_FILTER_WINDOW_STEP_MS, evicting the oldest */
+static void window_push(gps_filter_window_t* w, const gps_fix_packed_t* fix, uint64_t unix_ms) {
+    if (w->count > 0) {
+        uint64_t dt = unix_ms - w->last_unix_ms;
+        if (unix_ms < w->last_unix_ms || dt < GPS_FILTER_WINDOW_STEP_MS) return;
+        if (dt > GPS_FILTER_WINDOW_GAP_MS) w->count = 0;
+    }
+    int32_t dlat, dlon;
+    if (w->count == 0) window_reset(w, fix);
+    window_offset(w, fix, &dlat, &dlon);
+    if (abs(dlat) >= WINDOW_MAX_OFFSET_E6 || abs(dlon) >= WINDOW_MAX_OFFSET_E6) {
+        window_reset(w, fix);
+        dlat = dlon = 0;
+    }
+
+    uint8_t slot = w->head;
+    if (w->count == GPS_FILTER_WINDOW) {
+        w->sum_lat -= w->dlat[slot];
+        w->sum_lon -= w->dlon[slot];
+        w->sum_lat2 -= (int64_t)w->dlat[slot] * w->dlat[slot];
+        w->sum_lon2 -= (int64_t)w->dlon[slot] * w->dlon[slot];
+        w->head = (uint8_t)((slot + 1) % GPS_FILTER_WINDOW);
+    } else {
+        slot = (uint8_t)((w->head + w->count) % GPS_FILTER_WINDOW);
+        w->count++;
+    }
+    w->dlat[slot] = dlat;
+    w->dlon[slot] = dlon;
+    w->sum_lat += dlat;
+    w->sum_lon += dlon;
+    w->sum_lat2 += (int64_t)dlat * dlat;
+    w->sum_lon2 += (int64_t)dlon * dlon;
+    w->last_unix_ms = unix_ms;
+}
+
+/* Dwell and radius: a full window whose RMS distance from its mean is
+   inside GPS_FILTER_STOP_RADIUS_M */
+static bool window_settled(const gps_filter_window_t* w) {
+    if (w->count < GPS_FILTER_WINDOW) return false;
+    const int64_t n = GPS_FILTER_WINDOW;
+    /* n^2 * variance, exact */
+    float var_lat = (float)(n * w->sum_lat2 - w->sum_lat * w->sum_lat) / (float)(n * n);
+    float var_lon = (float)(n * w->sum_lon2 - w->sum_lon * w->sum_lon) / (float)(n * n);
+    float var_m2 = var_lat * GEO_M_PER_E6_F * GEO_M_PER_E6_F + var_lon * w->m_per_e6_lon * w->m_per_e6_lon;
+    return var_m2 <= GPS_FILTER_STOP_RADIUS_M * GPS_FILTER_STOP_RADIUS_M;
+}
+
+/* Displacement of a fix from the window mean, in metres */
+static float window_distance_m(const gps_filter_window_t* w, const gps_fix_packed_t* fix) {
+    if (w->count == 0) return 0.0f;
+    int32_t dlat, dlon;
+    window_offset(w, fix, &dlat, &dlon);
+    float n = (float)w->count;
+    float y = ((float)dlat - (float)w->sum_lat / n) * GEO_M_PER_E6_F;
+    float x = ((float)dlon - (float)w->sum_lon / n) * w->m_per_e6_lon;
+    return sqrtf(x * x + y * y);
+}
+
+static void window_restart(gps_filter_window_t* w, const gps_fix_packed_t* fix, uint64_t unix_ms) {
+    w->count = 0;
+    window_push(w, fix, unix_ms);
+}
+
+/* MOVING -> STOPPED */
+static bool is_stationary(const gps_filter_t* filter, const gps_fix_packed_t* fix) {
+    return is_slow(fix) || window_settled(&filter->window);
+}
+
+/* COLD_START / STOPPED -> MOVING: fast, or past walking pace and clearly
+   away from where it has been standing */
+static bool is_going(const gps_filter_t* filter, const gps_fix_packed_t* fix) {
+    if (is_slow(fix)) return false;
+    if (fix->speed_ckmh >= GPS_FILTER_GO_SPEED_KMH * 100.0f) return true;
+    return window_distance_m(&filter->window, fix) >= GPS_FILTER_GO_DISTANCE_M;
+}
+
+static void remember(gps_filter_t* filter, const gps_fix_packed_t* fix, uint64_t unix_ms) {
+    filter->last_accepted_fix = *fix;
+    filter->last_unix_ms = unix_ms;
+    filter->has_last_fix = true;
+}
+
+static bool course_usable(const gps_fix_packed_t* fix) {
+    return (fix->flags & GPS_HAS_COURSE) && (fix->flags & GPS_HAS_SPEED) &&
+           fix->speed_ckmh >= GPS_FILTER_LOG_COURSE_MIN_KMH * 100.0f;
+}
+
+/* Every accepted fix is a logged fix: it is the reference for the policy */
+static gps_filter_result_t accept(gps_filter_t* filter, const gps_fix_packed_t* fix,
+                                  uint64_t unix_ms) {
+    remember(filter, fix, unix_ms);
+    filter->logged_unix_ms = unix_ms;
+    filter->logged_lat_e6 = fix->lat_e6;
+    filter->logged_lon_e6 = fix->lon_e6;
+    filter->course_ref_ddeg = course_usable(fix) ? fix->course_ddeg : GPS_FILTER_NO_COURSE;
+    return FILTER_ACCEPT;
+}
+
+/* 4. Logging policy, on a moving fix that passed the gates */
+static bool log_due(gps_filter_t* filter, const gps_fix_packed_t* fix, uint64_t unix_ms) {
+    const gps_filter_policy_t* p = &filter->policy;
+    if (p->course_deg <= 0.0f && p->distance_m <= 0.0f && p->interval_ms == 0) return true;
+
+    if (p->interval_ms > 0 && unix_ms - filter->logged_unix_ms >= p->interval_ms) return true;
+
+    if (p->course_deg > 0.0f && course_usable(fix)) {
+        if (filter->course_ref_ddeg == GPS_FILTER_NO_COURSE) {
+            /* Logged slow or without course: measure turns from here */
+            filter->course_ref_ddeg = fix->course_ddeg;
+        } else {
+            int turn = abs((int)fix->course_ddeg - (int)filter->course_ref_ddeg) % 3600;
+            if (turn > 1800) turn = 3600 - turn;
+            if ((float)turn > p->course_deg * 10.0f) return true;
+        }
+    }
+
+    if (p->distance_m > 0.0f) {
+        geo_real_t dist = geo_distance_e6_m(&filter->cos_cache, filter->logged_lat_e6,
+                                            filter->logged_lon_e6, fix->lat_e6, fix->lon_e6);
+        if (dist >= (geo_real_t)p->distance_m) return true;
+    }
+    return false;
+}
 
-    bool stationary = is_stationary(fix);
+/* Steps 2 to 4 on a fix that passed the validity gate */
+static gps_filter_result_t decide(gps_filter_t* filter, const gps_fix_packed_t* fix,
+                                   uint64_t unix_ms) {
+#if GPS_FILTER_KALMAN
+    /* 3. Mahalanobis gate, on every valid fix in every state so the model
+       keeps tracking while stopped */
+    float hdop = (fix->flags & GPS_HAS_HDOP) ? fix->hdop_c / 100.0f : 0.0f;
+    gps_kalman_result_t kr = gps_kalman_step(&filter->kalman, fix->lat_e6, fix->lon_e6, hdop, unix_ms);
+    if (kr == GPS_KALMAN_REJECTED) return FILTER_REJECT_OUTLIER;
+    /* A re-seed follows the fixes wherever they went; whether they got
+       there at a believable speed is the implied-speed gate's call */
+    if (kr == GPS_KALMAN_RESEEDED) filter->speed_gate = true;
+    bool speed_gate = filter->speed_gate;
+#else
+    const bool speed_gate = true;
+#endif
 
-    /* 2. State machine + stationary rejection */
+    /* 2. State machine + stationary rejection. The window is restarted on
+       every transition, so it only holds positions from the current state. */
+    bool going;
     switch (filter->state) {
     case FILTER_STATE_COLD_START:
-        if (stationary) return FILTER_REJECT_STATIONARY;
+        going = is_going(filter, fix);
+        window_push(&filter->window, fix, unix_ms);
+        if (!going) return FILTER_REJECT_STATIONARY;
         /* First valid, non-stationary fix — accept and go to MOVING */
         filter->state = FILTER_STATE_MOVING;
-        filter->last_accepted_fix = *fix;
-        filter->has_last_fix = true;
-        return FILTER_ACCEPT;
+        window_restart(&filter->window, fix, unix_ms);
+        return accept(filter, fix, unix_ms);
 
     case FILTER_STATE_MOVING:
         /* 3. Speed gate (outlier rejection) — only if we have a previous fix */
         if (filter->has_last_fix) {
-            double dt = fix_to_epoch_seconds(fix) - fix_to_epoch_seconds(&filter->last_accepted_fix);
-            if (dt < 0.0) return FILTER_REJECT_NO_TIME_DELTA;
-            if (dt == 0.0) return FILTER_REJECT_NO_TIME_DELTA;
-            if (dt >= 0.5) {
-                double dist = haversine_distance_m(
-                    filter->last_accepted_fix.latitude,
-                    filter->last_accepted_fix.longitude,
-                    fix->latitude, fix->longitude);
-                double implied_kmh = (dist / dt) * 3.6;
-                if (implied_kmh > GPS_FILTER_MAX_SPEED_KMH) {
+            int64_t dt_ms = (int64_t)(unix_ms - filter->last_unix_ms);
+            if (dt_ms <= 0) return FILTER_REJECT_NO_TIME_DELTA;
+            if (speed_gate && dt_ms >= 500) {
+                geo_real_t dist = geo_distance_e6_m(
+                    &filter->cos_cache, filter->last_accepted_fix.lat_e6, filter->last_accepted_fix.lon_e6,
+                    fix->lat_e6, fix->lon_e6);
+                /* implied km/h = dist / dt_ms * 3600, without the division */
+                if (dist * (geo_real_t)3600 > (geo_real_t)GPS_FILTER_MAX_SPEED_KMH * (geo_real_t)dt_ms) {
                     return FILTER_REJECT_OUTLIER;
                 }
+#if GPS_FILTER_KALMAN
+                filter->speed_gate = false;
+#endif
             }
         }
 
-        if (stationary) {
+        window_push(&filter->window, fix, unix_ms);
+        if (is_stationary(filter, fix)) {
             /* Stop point: accept this fix, transition to STOPPED */
             filter->state = FILTER_STATE_STOPPED;
-            filter->last_accepted_fix = *fix;
-            return FILTER_ACCEPT;
+            window_restart(&filter->window, fix, unix_ms);
+            return accept(filter, fix, unix_ms);
         }
 
-        /* Normal moving fix */
-        filter->last_accepted_fix = *fix;
-        return FILTER_ACCEPT;
+        /* Normal moving fix: the speed gate's reference even when the
+           policy skips it, so outliers are judged over one fix interval */
+        if (!log_due(filter, fix, unix_ms)) {
+            remember(filter, fix, unix_ms);
+            return FILTER_REJECT_POLICY;
+        }
+        return accept(filter, fix, unix_ms);
 
     case FILTER_STATE_STOPPED:
-        if (!stationary) {
+        going = is_going(filter, fix);
+        window_push(&filter->window, fix, unix_ms);
+        if (going) {
             /* Resume point: accept and transition to MOVING */
             filter->state = FILTER_STATE_MOVING;
-            filter->last_accepted_fix = *fix;
-            return FILTER_ACCEPT;
+            window_restart(&filter->window, fix, unix_ms);
+            return accept(filter, fix, unix_ms);
         }
         return FILTER_REJECT_STATIONARY;
     }
@@ -91,7 +255,140 @@ gps_filter_result_t gps_filter_process(gps_filter_t* filter, const gps_fix_t* fi
     return FILTER_REJECT_INVALID;
 }
 
+/* Note a rejection in the trace, measured against prev: the gate's previous
+   fix as it was before the decision, or NULL */
+static void trace_reject(gps_filter_t* filter, const gps_fix_packed_t* fix, uint64_t unix_ms,
+                         gps_filter_result_t r, const gps_fix_packed_t* prev, uint64_t prev_ms) {
+    gps_filter_trace_t* trace = filter->trace;
+    gps_filter_reject_t* e = &trace->entries[trace->total % GPS_FILTER_TRACE_DEPTH];
+    trace->total++;
+    e->unix_ms = unix_ms;
+    e->lat_e6 = fix->lat_e6;
+    e->lon_e6 = fix->lon_e6;
+    e->speed_ckmh = (fix->flags & GPS_HAS_SPEED) ? fix->speed_ckmh : 0;
+    e->result = (uint8_t)r;
+    e->dt_ms = 0;
+    e->implied_kmh = 0.0f;
+    if (prev) {
+        e->dt_ms = (int32_t)(int64_t)(unix_ms - prev_ms);
+        if (e->dt_ms > 0) {
+            geo_real_t dist = geo_distance_e6_m(&filter->cos_cache, prev->lat_e6, prev->lon_e6,
+                                                fix->lat_e6, fix->lon_e6);
+            e->implied_kmh = (float)dist * 3600.0f / (float)e->dt_ms;
+        }
+    }
+}
+
+static gps_filter_result_t process(gps_filter_t* filter, const gps_fix_packed_t* fix,
+                                   uint64_t unix_ms) {
+    if (!filter->trace) {
+        gps_filter_result_t r = decide(filter, fix, unix_ms);
+        filter->results[r]++;
+        return r;
+    }
+
+    /* A policy skip moves the gate's reference, so keep the old one */
+    gps_fix_packed_t prev = filter->last_accepted_fix;
+    uint64_t prev_ms = filter->last_unix_ms;
+    bool had_prev = filter->has_last_fix;
+    gps_filter_result_t r = decide(filter, fix, unix_ms);
+    filter->results[r]++;
+    if (filter->trace->mask & GPS_FILTER_TRACE_MASK(r)) {
+        trace_reject(filter, fix, unix_ms, r, had_prev ? &prev : NULL, prev_ms);
+    }
+    return r;
+}
+
+gps_filter_result_t gps_filter_process(gps_filter_t* filter, const gps_fix_t* fix) {
+    if (!filter || !fix) return FILTER_REJECT_INVALID;
+
+    /* 1. Validity gate, before paying for the conversion. Counted, never
+       traced: there may be no position to record. */
+    if (!(fix->flags & GPS_FIX_VALID) || !(fix->flags & GPS_HAS_LATLON)) {
+        filter->results[FILTER_REJECT_INVALID]++;
+        return FILTER_REJECT_INVALID;
+    }
+
+    gps_fix_packed_t packed;
+    gps_fix_pack(fix, &packed);
+    return process(filter, &packed, fix->unix_ms);
+}
+
+gps_filter_result_t gps_filter_process_packed(gps_filter_t* filter, const gps_fix_packed_t* fix) {
+    if (!filter || !fix) return FILTER_REJECT_INVALID;
+
+    /* 1. Validity gate */
+    if (!(fix->flags & GPS_FIX_VALID) || !(fix->flags & GPS_HAS_LATLON)) {
+        filter->results[FILTER_REJECT_INVALID]++;
+        return FILTER_REJECT_INVALID;
+    }
+
+    return process(filter, fix, gps_fix_packed_unix_ms(fix));
+}
+
+#if GPS_FILTER_KALMAN
+void gps_filter_smooth(const gps_filter_t* filter, gps_fix_t* fix) {
+    if (!filter || !fix || !filter->kalman.seeded) return;
+    int32_t lat_e6, lon_e6;
+    gps_kalman_position(&filter->kalman, &lat_e6, &lon_e6);
+    fix->latitude = lat_e6 / 1e6;
+    fix->longitude = lon_e6 / 1e6;
+}
+#endif
+
 gps_filter_state_t gps_filter_get_state(const gps_filter_t* filter) {
     if (!filter) return FILTER_STATE_COLD_START;
     return filter->state;
 }
+
+static const char* const result_names[GPS_FILTER_RESULT_COUNT] = {
+    "accept", "invalid", "stationary", "outlier", "no_time_delta", "policy",
+};
+
+const char* gps_filter_result_name(gps_filter_result_t result) {
+    if ((unsigned)result >= GPS_FILTER_RESULT_COUNT) return "unknown";
+    return result_names[result];
+}
+
+/* Micro-degrees as %.6f without going through double */
+static int format_e6(char* buf, size_t size, int32_t v) {
+    uint32_t a = v < 0 ? 0u - (uint32_t)v : (uint32_t)v;
+    return snprintf(buf, size, "%s%lu.%06lu", v < 0 ? "-" : "",
+                    (unsigned long)(a / 1000000u), (unsigned long)(a % 1000000u));
+}
+
+void gps_filter_dump(const gps_filter_t* filter, gps_filter_line_fn fn, void* user) {
+    if (!filter || !fn) return;
+    char line[GPS_FILTER_DUMP_LINE_MAX];
+    int pos = snprintf(line, sizeof(line), "filter_results");
+    for (int r = 0; r < GPS_FILTER_RESULT_COUNT; r++) {
+        pos += snprintf(line + pos, sizeof(line) - (size_t)pos, " %s=%lu",
+                        result_names[r], (unsigned long)filter->results[r]);
+        /* Cut, never past the buffer, should a counter be added */
+        if (pos >= (int)sizeof(line)) {
+            pos = (int)sizeof(line) - 1;
+            break;
+        }
+    }
+    fn(line, (size_t)pos, user);
+
+    const gps_filter_trace_t* trace = filter->trace;
+    if (!trace) return;
+    uint32_t n = trace->total < GPS_FILTER_TRACE_DEPTH ? trace->total : GPS_FILTER_TRACE_DEPTH;
+    pos = snprintf(line, sizeof(line), "filter_rejects total=%lu last=%lu: "
+                   "unix_ms,result,latitude,longitude,speed_kmh,implied_kmh,dt_ms",
+                   (unsigned long)trace->total, (unsigned long)n);
+    fn(line, (size_t)pos, user);
+    for (uint32_t i = trace->total - n; i != trace->total; i++) {
+        const gps_filter_reject_t* e = &trace->entries[i % GPS_FILTER_TRACE_DEPTH];
+        pos = snprintf(line, sizeof(line), "%llu,%s,", (unsigned long long)e->unix_ms,
+                       gps_filter_result_name((gps_filter_result_t)e->result));
+        pos += format_e6(line + pos, sizeof(line) - (size_t)pos, e->lat_e6);
+        line[pos++] = ',';
+        pos += format_e6(line + pos, sizeof(line) - (size_t)pos, e->lon_e6);
+        pos += snprintf(line + pos, sizeof(line) - (size_t)pos, ",%u.%02u,%.1f,%ld",
+                        e->speed_ckmh / 100u, e->speed_ckmh % 100u,
+                        (double)e->implied_kmh, (long)e->dt_ms);
+        fn(line, (size_t)pos, user);
+    }
+}
@@ -2,32 +2,152 @@
 #define GPS_FILTER_H
 
 #include "nmea_parser.h"
+#include "gps_fix_packed.h"
+#include "geo_utils.h"
+#include "gps_kalman.h"
+
+/* GPS_FILTER_KALMAN=1 replaces the implied-speed gate with the Mahalanobis
+   gate of a constant-velocity Kalman filter (gps_kalman.h), fed with every
+   valid fix, and adds gps_filter_smooth(). */
+#ifndef GPS_FILTER_KALMAN
+#define GPS_FILTER_KALMAN 0
+#endif
 
 #define GPS_FILTER_STATIONARY_THRESHOLD_KMH 3.0f
 #define GPS_FILTER_MAX_SPEED_KMH            250.0f
 
+/* Stop/go window: one position per GPS_FILTER_WINDOW_STEP_MS. Parked-car
+   drift reports 3-5 km/h, so speed alone is not enough. MOVING stops when
+   slow, or when a full window (the dwell time) is within the stop radius
+   of its mean. STOPPED and COLD_START go at GPS_FILTER_GO_SPEED_KMH, or at
+   walking speed once the fix is GPS_FILTER_GO_DISTANCE_M from the mean. */
+#define GPS_FILTER_WINDOW                   20
+#define GPS_FILTER_WINDOW_STEP_MS           1000u
+#define GPS_FILTER_WINDOW_GAP_MS            5000u   /* longer gaps restart the window */
+#define GPS_FILTER_STOP_RADIUS_M            4.0f    /* RMS distance from the mean */
+#define GPS_FILTER_GO_DISTANCE_M            10.0f
+#define GPS_FILTER_GO_SPEED_KMH             10.0f
+
+/* Logging policy (gps_filter_set_policy): while MOVING, a fix that passed
+   the gates is logged only when one trigger fires against the last logged
+   fix. State changes are always logged. */
+#define GPS_FILTER_LOG_COURSE_DEG           20.0f
+#define GPS_FILTER_LOG_DISTANCE_M           200.0f
+#define GPS_FILTER_LOG_INTERVAL_MS          10000u
+#define GPS_FILTER_LOG_COURSE_MIN_KMH       10.0f   /* course is noise below this */
+
 typedef enum {
     FILTER_STATE_COLD_START = 0,
     FILTER_STATE_MOVING,
     FILTER_STATE_STOPPED
 } gps_filter_state_t;
 
+/* Positions are micro-degree offsets from ref, summed exactly in 64 bits,
+   so the mean and variance update in O(1) without drift */
 typedef struct {
-    gps_filter_state_t state;
-    gps_fix_t last_accepted_fix;
-    bool has_last_fix;
-} gps_filter_t;
+    int32_t ref_lat_e6;
+    int32_t ref_lon_e6;
+    float m_per_e6_lon;         /* at ref */
+    uint8_t count;
+    uint8_t head;               /* oldest entry once full */
+    uint64_t last_unix_ms;      /* of the newest entry */
+    int64_t sum_lat, sum_lon;
+    int64_t sum_lat2, sum_lon2;
+    int32_t dlat[GPS_FILTER_WINDOW];
+    int32_t dlon[GPS_FILTER_WINDOW];
+} gps_filter_window_t;
+
+/* A zero field disables that trigger; all zero logs every fix */
+typedef struct {
+    float course_deg;           /* course change */
+    float distance_m;           /* distance travelled */
+    uint32_t interval_ms;       /* time elapsed */
+} gps_filter_policy_t;
+
+#define GPS_FILTER_POLICY_DEFAULT \
+    { GPS_FILTER_LOG_COURSE_DEG, GPS_FILTER_LOG_DISTANCE_M, GPS_FILTER_LOG_INTERVAL_MS }
 
 typedef enum {
     FILTER_ACCEPT = 0,
     FILTER_REJECT_INVALID,
     FILTER_REJECT_STATIONARY,
     FILTER_REJECT_OUTLIER,
-    FILTER_REJECT_NO_TIME_DELTA
+    FILTER_REJECT_NO_TIME_DELTA,
+    FILTER_REJECT_POLICY        /* good fix, no logging trigger fired */
 } gps_filter_result_t;
 
+#define GPS_FILTER_RESULT_COUNT (FILTER_REJECT_POLICY + 1)
+
+/* Rejected-fix trace (gps_filter_set_trace): the last GPS_FILTER_TRACE_DEPTH
+   rejections whose result is in the mask. dt_ms and implied_kmh are against
+   the last fix that passed the gates, 0 before there is one. */
+#ifndef GPS_FILTER_TRACE_DEPTH
+#define GPS_FILTER_TRACE_DEPTH 16
+#endif
+
+#define GPS_FILTER_TRACE_MASK(result) (1u << (result))
+
+typedef struct {
+    uint64_t unix_ms;
+    int32_t lat_e6;
+    int32_t lon_e6;
+    int32_t dt_ms;
+    float implied_kmh;
+    uint16_t speed_ckmh;        /* reported; 0 without GPS_HAS_SPEED */
+    uint8_t result;             /* gps_filter_result_t */
+} gps_filter_reject_t;
+
+typedef struct {
+    uint32_t mask;
+    uint32_t total;             /* recorded, including overwritten */
+    gps_filter_reject_t entries[GPS_FILTER_TRACE_DEPTH];
+} gps_filter_trace_t;
+
+typedef struct {
+    gps_filter_state_t state;
+    bool has_last_fix;
+    gps_fix_packed_t last_accepted_fix;
+    uint64_t last_unix_ms;      /* of last_accepted_fix */
+    geo_cos_cache_t cos_cache;  /* speed gate's cos(latitude) */
+    gps_filter_policy_t policy;
+    uint64_t logged_unix_ms;    /* last logged fix */
+    int32_t logged_lat_e6;
+    int32_t logged_lon_e6;
+    uint16_t course_ref_ddeg;   /* GPS_FILTER_NO_COURSE until a usable course */
+    gps_filter_window_t window;
+    uint32_t results[GPS_FILTER_RESULT_COUNT];  /* per result; wrap */
+    gps_filter_trace_t* trace;  /* NULL: no trace */
+#if GPS_FILTER_KALMAN
+    gps_kalman_t kalman;
+    bool speed_gate;            /* re-seeded: implied-speed gate until a fix passes it */
+#endif
+} gps_filter_t;
+
+#define GPS_FILTER_NO_COURSE 0xFFFFu
+
 void               gps_filter_init(gps_filter_t* filter);
 gps_filter_result_t gps_filter_process(gps_filter_t* filter, const gps_fix_t* fix);
+/* Same decision for a packed fix; gps_filter_process() packs and calls this */
+gps_filter_result_t gps_filter_process_packed(gps_filter_t* filter, const gps_fix_packed_t* fix);
 gps_filter_state_t  gps_filter_get_state(const gps_filter_t* filter);
+/* NULL logs every fix again (the default after gps_filter_init) */
+void               gps_filter_set_policy(gps_filter_t* filter, const gps_filter_policy_t* policy);
+/* Record rejections with a result in mask (GPS_FILTER_TRACE_MASK bits) into
+   trace, which is cleared; NULL stops tracing. The caller owns trace. */
+void               gps_filter_set_trace(gps_filter_t* filter, gps_filter_trace_t* trace, uint32_t mask);
+const char*        gps_filter_result_name(gps_filter_result_t result);
+
+/* Counters and trace as text lines (no newline), for a storage trailer:
+   one line of counters, then the trace oldest first under a column line.
+   Lines are shorter than GPS_FILTER_DUMP_LINE_MAX, so each fits a storage
+   comment (STORAGE_MAX_COMMENT_LEN); all counters at 2^32 - 1 take 135. */
+#define GPS_FILTER_DUMP_LINE_MAX 160
+typedef void (*gps_filter_line_fn)(const char* line, size_t len, void* user);
+void               gps_filter_dump(const gps_filter_t* filter, gps_filter_line_fn fn, void* user);
+
+#if GPS_FILTER_KALMAN
+/* Replace the position of an accepted fix with the filtered estimate */
+void gps_filter_smooth(const gps_filter_t* filter, gps_fix_t* fix);
+#endif
 
 #endif
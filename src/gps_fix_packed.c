@@ -0,0 +1,86 @@
+#include "gps_fix_packed.h"
+#include <math.h>
+#include <string.h>
+
+_Static_assert(sizeof(gps_fix_packed_t) <= 24, "gps_fix_packed_t grew past 24 bytes");
+_Static_assert((GPS_FIX_VALID | GPS_HAS_ALL) <= 0xFF, "GPS_HAS_* flags no longer fit the packed fix");
+
+#define ALTITUDE_DM_MAX  ((1L << 23) - 1)
+
+/* Round half to even, as printf does for exact ties, and clamp to [lo, hi] */
+static long round_clamp(double v, long lo, long hi) {
+    if (v <= (double)lo) return lo;
+    if (v >= (double)hi) return hi;
+    return lrint(v);
+}
+
+void gps_fix_pack(const gps_fix_t* fix, gps_fix_packed_t* out) {
+    memset(out, 0, sizeof(*out));
+    uint32_t flags = fix->flags & (GPS_FIX_VALID | GPS_HAS_ALL);
+
+    if (flags & GPS_HAS_TIME) {
+        out->time_cs = (uint32_t)(fix->unix_ms % MS_PER_DAY) / 10u;
+    }
+    uint64_t days = fix->unix_ms / MS_PER_DAY;
+    if ((flags & GPS_HAS_DATE) && days > 0 && days <= UINT16_MAX) {
+        out->date = (uint16_t)days;
+    } else {
+        flags &= ~(uint32_t)GPS_HAS_DATE;
+    }
+    if (flags & GPS_HAS_LATLON) {
+        out->lat_e6 = (int32_t)lrint(fix->latitude * 1e6);
+        out->lon_e6 = (int32_t)lrint(fix->longitude * 1e6);
+    }
+    if (flags & GPS_HAS_ALTITUDE) {
+        out->altitude_dm = (int32_t)round_clamp(fix->altitude_m * 10.0, -ALTITUDE_DM_MAX,
+                                                ALTITUDE_DM_MAX);
+    }
+    if (flags & GPS_HAS_SPEED) {
+        out->speed_ckmh = (uint16_t)round_clamp(fix->speed_kmh * 100.0, 0, UINT16_MAX);
+    }
+    if (flags & GPS_HAS_COURSE) {
+        out->course_ddeg = (uint16_t)round_clamp(fix->course_deg * 10.0, 0, 3600);
+    }
+    if (flags & GPS_HAS_HDOP) {
+        out->hdop_c = (uint16_t)round_clamp(fix->hdop * 100.0, 0, UINT16_MAX);
+    }
+    out->flags = flags;
+    out->satellites = fix->satellites;
+    out->fix_quality = fix->fix_quality & 0x0Fu;
+}
+
+void gps_fix_unpack(const gps_fix_packed_t* packed, gps_fix_t* out) {
+    memset(out, 0, sizeof(*out));
+    out->flags = packed->flags;
+
+    uint32_t t = packed->time_cs;
+    out->centisecond = (uint8_t)(t % 100u);
+    t /= 100u;
+    out->second = (uint8_t)(t % 60u);
+    t /= 60u;
+    out->minute = (uint8_t)(t % 60u);
+    out->hour = (uint8_t)(t / 60u);
+
+    if (packed->date) {
+        int32_t year;
+        uint32_t month, day;
+        civil_from_days(packed->date, &year, &month, &day);
+        out->year = (uint16_t)year;
+        out->month = (uint8_t)month;
+        out->day = (uint8_t)day;
+    }
+    out->unix_ms = gps_fix_packed_unix_ms(packed);
+
+    out->latitude = packed->lat_e6 / 1e6;
+    out->longitude = packed->lon_e6 / 1e6;
+    out->altitude_m = (float)(packed->altitude_dm / 10.0);
+    out->speed_kmh = (float)(packed->speed_ckmh / 100.0);
+    out->course_deg = (float)(packed->course_ddeg / 10.0);
+    out->hdop = (float)(packed->hdop_c / 100.0);
+    out->satellites = packed->satellites;
+    out->fix_quality = packed->fix_quality;
+}
+
+uint64_t gps_fix_packed_unix_ms(const gps_fix_packed_t* packed) {
+    return (uint64_t)packed->date * MS_PER_DAY + packed->time_cs * 10u;
+}
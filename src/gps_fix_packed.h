@@ -0,0 +1,32 @@
+#ifndef GPS_FIX_PACKED_H
+#define GPS_FIX_PACKED_H
+
+#include "nmea_parser.h"
+
+/* 24-byte fixed-point form of gps_fix_t (56 bytes on the Pico) for RAM ring
+   buffers, queues and filter state. Each field is stored on the grid
+   data_storage logs it at (altitude and course 0.1, not finer, so logging
+   never rounds twice): unpacking and logging gives the same CSV row.
+   Fields without their GPS_HAS_* flag are 0. */
+typedef struct {
+    int32_t  lat_e6;                /* micro-degrees */
+    int32_t  lon_e6;
+    int32_t  altitude_dm : 24;      /* saturates at +-838 km */
+    uint32_t flags       : 8;       /* GPS_FIX_VALID | GPS_HAS_* */
+    uint32_t time_cs     : 24;      /* centiseconds since 00:00 UTC */
+    uint32_t satellites  : 8;
+    uint16_t date;                  /* days since 1970-01-01, 0 without GPS_HAS_DATE */
+    uint16_t speed_ckmh;            /* 0.01 km/h, saturates at 655.35 */
+    uint16_t hdop_c;                /* 0.01, saturates at 655.35 */
+    uint16_t course_ddeg : 12;      /* 0.1 deg */
+    uint16_t fix_quality : 4;
+} gps_fix_packed_t;
+
+/* Date and time come from fix->unix_ms. Dates after 2149-06-06 drop
+   GPS_HAS_DATE. */
+void     gps_fix_pack(const gps_fix_t* fix, gps_fix_packed_t* out);
+void     gps_fix_unpack(const gps_fix_packed_t* packed, gps_fix_t* out);
+/* Same value as gps_fix_t.unix_ms */
+uint64_t gps_fix_packed_unix_ms(const gps_fix_packed_t* packed);
+
+#endif
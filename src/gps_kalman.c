@@ -0,0 +1,112 @@
+#include "gps_kalman.h"
+#include "geo_utils.h"
+#include <math.h>
+#include <string.h>
+
+void gps_kalman_init(gps_kalman_t* kf) {
+    if (!kf) return;
+    memset(kf, 0, sizeof(*kf));
+}
+
+static void set_origin(gps_kalman_t* kf, int32_t lat_e6, int32_t lon_e6) {
+    kf->origin_lat_e6 = lat_e6;
+    kf->origin_lon_e6 = lon_e6;
+    kf->m_per_e6_lon = geo_m_per_e6_lon_f(lat_e6);
+}
+
+static void offset_m(const gps_kalman_t* kf, int32_t lat_e6, int32_t lon_e6, float* east, float* north) {
+    geo_e6_delta_m(kf->origin_lat_e6, kf->origin_lon_e6, kf->m_per_e6_lon, lat_e6, lon_e6, east, north);
+}
+
+static void seed_axis(gps_kalman_axis_t* ax, float pos, float r) {
+    ax->pos = pos;
+    ax->vel = 0.0f;
+    ax->p_pp = r;
+    ax->p_pv = 0.0f;
+    ax->p_vv = GPS_KALMAN_VEL0_MPS * GPS_KALMAN_VEL0_MPS;
+}
+
+static void seed(gps_kalman_t* kf, int32_t lat_e6, int32_t lon_e6, float r, uint64_t unix_ms) {
+    set_origin(kf, lat_e6, lon_e6);
+    seed_axis(&kf->east, 0.0f, r);
+    seed_axis(&kf->north, 0.0f, r);
+    kf->last_unix_ms = unix_ms;
+    kf->rejects = 0;
+    kf->seeded = true;
+}
+
+/* x = F x, P = F P F' + Q with F = [1 dt; 0 1] and Q for white acceleration q */
+static void predict(gps_kalman_axis_t* ax, float dt, float q) {
+    float dt2 = dt * dt;
+    ax->pos += ax->vel * dt;
+    ax->p_pp += dt * (2.0f * ax->p_pv + dt * ax->p_vv) + q * dt2 * dt * (1.0f / 3.0f);
+    ax->p_pv += dt * ax->p_vv + q * dt2 * 0.5f;
+    ax->p_vv += q * dt;
+}
+
+/* H = [1 0]: K = P H' / S, P = (I - K H) P */
+static void update(gps_kalman_axis_t* ax, float innov, float s) {
+    float kp = ax->p_pp / s, kv = ax->p_pv / s;
+    ax->pos += kp * innov;
+    ax->vel += kv * innov;
+    ax->p_vv -= kv * ax->p_pv;
+    ax->p_pv -= kp * ax->p_pv;
+    ax->p_pp -= kp * ax->p_pp;
+}
+
+/* Keep positions small so float resolution stays at millimetres */
+static void reorigin(gps_kalman_t* kf) {
+    if (fabsf(kf->east.pos) < GPS_KALMAN_REORIGIN_M && fabsf(kf->north.pos) < GPS_KALMAN_REORIGIN_M) return;
+    int32_t lat_e6, lon_e6;
+    gps_kalman_position(kf, &lat_e6, &lon_e6);
+    float de, dn;
+    offset_m(kf, lat_e6, lon_e6, &de, &dn);
+    set_origin(kf, lat_e6, lon_e6);
+    kf->east.pos -= de;
+    kf->north.pos -= dn;
+}
+
+gps_kalman_result_t gps_kalman_step(gps_kalman_t* kf, int32_t lat_e6, int32_t lon_e6,
+                                    float hdop, uint64_t unix_ms) {
+    float sigma = (hdop > 0.0f ? hdop : GPS_KALMAN_DEFAULT_HDOP) * GPS_KALMAN_UERE_M;
+    float r = sigma * sigma;
+    if (!kf->seeded) {
+        seed(kf, lat_e6, lon_e6, r, unix_ms);
+        return GPS_KALMAN_SEEDED;
+    }
+
+    int64_t dt_ms = (int64_t)(unix_ms - kf->last_unix_ms);
+    if (dt_ms <= 0) return GPS_KALMAN_STALE;
+    float dt = (float)dt_ms * 1e-3f;
+    const float q = GPS_KALMAN_ACCEL_MPS2 * GPS_KALMAN_ACCEL_MPS2;
+    predict(&kf->east, dt, q);
+    predict(&kf->north, dt, q);
+    kf->last_unix_ms = unix_ms;
+
+    float ie, in;
+    offset_m(kf, lat_e6, lon_e6, &ie, &in);
+    ie -= kf->east.pos;
+    in -= kf->north.pos;
+    float se = kf->east.p_pp + r, sn = kf->north.p_pp + r;
+    if (ie * ie / se + in * in / sn > GPS_KALMAN_GATE_D2) {
+        if (++kf->rejects < GPS_KALMAN_MAX_REJECTS) return GPS_KALMAN_REJECTED;
+        /* The track moved on without us (or we were poisoned): start over */
+        seed(kf, lat_e6, lon_e6, r, unix_ms);
+        return GPS_KALMAN_RESEEDED;
+    }
+
+    kf->rejects = 0;
+    update(&kf->east, ie, se);
+    update(&kf->north, in, sn);
+    reorigin(kf);
+    return GPS_KALMAN_UPDATED;
+}
+
+void gps_kalman_position(const gps_kalman_t* kf, int32_t* lat_e6, int32_t* lon_e6) {
+    *lat_e6 = kf->origin_lat_e6 + (int32_t)lrintf(kf->north.pos / GEO_M_PER_E6_F);
+    *lon_e6 = geo_wrap_lon_e6(kf->origin_lon_e6 + (int64_t)lrintf(kf->east.pos / kf->m_per_e6_lon));
+}
+
+float gps_kalman_speed_mps(const gps_kalman_t* kf) {
+    return sqrtf(kf->east.vel * kf->east.vel + kf->north.vel * kf->north.vel);
+}
@@ -0,0 +1,52 @@
+#ifndef GPS_KALMAN_H
+#define GPS_KALMAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* 2D constant-velocity Kalman filter in a local east/north tangent plane,
+   float32 throughout for the M33 FPU. x and y share no terms in the model,
+   process noise or measurement noise, so the 4-state filter runs as two
+   independent [position, velocity] filters with 2x2 covariances. */
+
+#define GPS_KALMAN_UERE_M       3.0f    /* horizontal error per axis at HDOP 1, 1 sigma */
+#define GPS_KALMAN_DEFAULT_HDOP 2.0f    /* used when the fix has no HDOP */
+#define GPS_KALMAN_ACCEL_MPS2   1.0f    /* white-acceleration process noise, 1 sigma */
+#define GPS_KALMAN_VEL0_MPS     50.0f   /* velocity uncertainty when seeded */
+#define GPS_KALMAN_GATE_D2      13.82f  /* chi-square, 2 dof, 99.9 % */
+#define GPS_KALMAN_MAX_REJECTS  5       /* consecutive gate rejections before re-seeding */
+#define GPS_KALMAN_REORIGIN_M   5000.0f /* move the tangent plane origin past this */
+
+typedef struct {
+    float pos;                  /* m from the origin */
+    float vel;                  /* m/s */
+    float p_pp, p_pv, p_vv;     /* covariance */
+} gps_kalman_axis_t;
+
+typedef struct {
+    uint64_t last_unix_ms;
+    bool seeded;
+    uint8_t rejects;            /* consecutive */
+    int32_t origin_lat_e6;
+    int32_t origin_lon_e6;
+    float m_per_e6_lon;         /* metres per micro-degree of longitude at the origin */
+    gps_kalman_axis_t east, north;
+} gps_kalman_t;
+
+typedef enum {
+    GPS_KALMAN_SEEDED = 0,      /* first fix */
+    GPS_KALMAN_RESEEDED,        /* started over on the fix after GPS_KALMAN_MAX_REJECTS rejections */
+    GPS_KALMAN_UPDATED,
+    GPS_KALMAN_REJECTED,        /* Mahalanobis distance past the gate; state only predicted */
+    GPS_KALMAN_STALE            /* time did not advance; nothing changed */
+} gps_kalman_result_t;
+
+void gps_kalman_init(gps_kalman_t* kf);
+/* Predict to unix_ms, gate the measurement on its squared Mahalanobis
+   distance, update. hdop <= 0 means unknown. */
+gps_kalman_result_t gps_kalman_step(gps_kalman_t* kf, int32_t lat_e6, int32_t lon_e6,
+                                    float hdop, uint64_t unix_ms);
+void  gps_kalman_position(const gps_kalman_t* kf, int32_t* lat_e6, int32_t* lon_e6);
+float gps_kalman_speed_mps(const gps_kalman_t* kf);
+
+#endif
@@ -0,0 +1,95 @@
+#include "gps_stream.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct gps_stream {
+    nmea_parser_storage_t nmea_storage;
+    ubx_parser_storage_t ubx_storage;
+    nmea_parser_t* nmea;
+    ubx_parser_t* ubx;
+    gps_protocol_t protocol;
+    int delivered;
+
+    nmea_fix_callback_t fix_cb;
+    void* fix_cb_user;
+};
+
+static void deliver(gps_stream_t* stream, const gps_fix_t* fix) {
+    stream->delivered++;
+    if (stream->fix_cb) {
+        stream->fix_cb(fix, stream->fix_cb_user);
+    }
+}
+
+static void on_nmea_fix(const gps_fix_t* fix, void* user) {
+    gps_stream_t* stream = (gps_stream_t*)user;
+    if (stream->protocol == GPS_PROTOCOL_UBX) return;
+    stream->protocol = GPS_PROTOCOL_NMEA;
+    deliver(stream, fix);
+}
+
+static void on_ubx_fix(const gps_fix_t* fix, void* user) {
+    gps_stream_t* stream = (gps_stream_t*)user;
+    stream->protocol = GPS_PROTOCOL_UBX;
+    deliver(stream, fix);
+}
+
+_Static_assert(sizeof(struct gps_stream) <= sizeof(gps_stream_storage_t),
+               "GPS_STREAM_STORAGE_SIZE too small");
+
+gps_stream_t* gps_stream_init(gps_stream_storage_t* storage) {
+    if (!storage) return NULL;
+    gps_stream_t* stream = (gps_stream_t*)storage;
+    memset(stream, 0, sizeof(*stream));
+
+    /* Parsers live inside the stream: one block, nothing else to free */
+    stream->nmea = nmea_parser_init(&stream->nmea_storage);
+    stream->ubx = ubx_parser_init(&stream->ubx_storage);
+    nmea_parser_set_fix_callback(stream->nmea, on_nmea_fix, stream);
+    ubx_parser_set_fix_callback(stream->ubx, on_ubx_fix, stream);
+    return stream;
+}
+
+gps_stream_t* gps_stream_create(void) {
+    gps_stream_storage_t* storage = malloc(sizeof(gps_stream_storage_t));
+    return gps_stream_init(storage);
+}
+
+void gps_stream_destroy(gps_stream_t* stream) {
+    free(stream);
+}
+
+void gps_stream_set_fix_callback(gps_stream_t* stream, nmea_fix_callback_t cb, void* user) {
+    if (!stream) return;
+    stream->fix_cb = cb;
+    stream->fix_cb_user = user;
+}
+
+int gps_stream_feed(gps_stream_t* stream, const uint8_t* buf, size_t len) {
+    if (!stream || (!buf && len > 0)) return -1;
+
+    stream->delivered = 0;
+    size_t i = 0;
+    while (i < len) {
+        if (!ubx_parser_in_frame(stream->ubx)) {
+            /* Text run up to the next UBX sync byte (never valid in NMEA) */
+            const uint8_t* sync = memchr(buf + i, UBX_SYNC_1, len - i);
+            size_t end = sync ? (size_t)(sync - buf) : len;
+            if (end > i) {
+                nmea_parser_feed_bytes(stream->nmea, buf + i, end - i);
+                i = end;
+            }
+            if (i == len) break;
+        }
+        i += ubx_parser_scan(stream->ubx, buf + i, len - i, NULL);
+    }
+    return stream->delivered;
+}
+
+gps_protocol_t gps_stream_protocol(const gps_stream_t* stream) {
+    return stream ? stream->protocol : GPS_PROTOCOL_NONE;
+}
+
+nmea_parser_t* gps_stream_nmea(gps_stream_t* stream) {
+    return stream ? stream->nmea : NULL;
+}
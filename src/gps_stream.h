@@ -0,0 +1,46 @@
+#ifndef GPS_STREAM_H
+#define GPS_STREAM_H
+
+#include "nmea_parser.h"
+#include "ubx_parser.h"
+
+/* Receiver byte stream demultiplexer: UBX frames (0xB5 0x62 ...) go to the
+   UBX parser, everything else to the NMEA parser. Both produce gps_fix_t. */
+
+typedef enum {
+    GPS_PROTOCOL_NONE = 0,
+    GPS_PROTOCOL_NMEA,
+    GPS_PROTOCOL_UBX
+} gps_protocol_t;
+
+typedef struct gps_stream gps_stream_t;
+
+/* Caller-owned memory for gps_stream_init(): both parsers plus stream state */
+#define GPS_STREAM_STORAGE_SIZE (NMEA_PARSER_STORAGE_SIZE + UBX_PARSER_STORAGE_SIZE + 64)
+
+typedef union {
+    uint8_t bytes[GPS_STREAM_STORAGE_SIZE];
+    uint64_t align_u64;
+    void* align_ptr;
+} gps_stream_storage_t;
+
+gps_stream_t*  gps_stream_create(void);
+void           gps_stream_destroy(gps_stream_t* stream);
+/* Heap-free alternative to create (the firmware uses a static one); never
+   pass the result to gps_stream_destroy() */
+gps_stream_t*  gps_stream_init(gps_stream_storage_t* storage);
+void           gps_stream_set_fix_callback(gps_stream_t* stream, nmea_fix_callback_t cb, void* user);
+
+/* Returns the number of fixes delivered to the callback, -1 on bad args.
+   Once a NAV-PVT fix has been seen the stream locks to UBX and NMEA fixes
+   are no longer delivered, so a receiver emitting both is not logged twice. */
+int            gps_stream_feed(gps_stream_t* stream, const uint8_t* buf, size_t len);
+
+/* Protocol currently delivering fixes (NONE until the first fix) */
+gps_protocol_t gps_stream_protocol(const gps_stream_t* stream);
+
+/* The underlying NMEA parser, for epoch policy, ticks and sentence handlers.
+   Its fix callback belongs to the stream and must not be replaced. */
+nmea_parser_t* gps_stream_nmea(gps_stream_t* stream);
+
+#endif
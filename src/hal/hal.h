@@ -8,6 +8,8 @@
 /* UART */
 void hal_uart_init(uint32_t baud_rate);
 int hal_uart_read_line(char* buf, size_t buf_size, uint32_t timeout_ms);
+/* Waits up to timeout_ms for data, then returns whatever is buffered (0 on timeout) */
+int hal_uart_read(uint8_t* buf, size_t len, uint32_t timeout_ms);
 
 /* GPIO */
 void hal_gpio_init_input(uint32_t pin);
@@ -15,7 +17,10 @@ bool hal_gpio_read(uint32_t pin);
 typedef void (*hal_gpio_irq_callback_t)(uint32_t pin, uint32_t events);
 void hal_gpio_set_irq(uint32_t pin, uint32_t edge_mask, hal_gpio_irq_callback_t cb);
 
-/* Filesystem */
+/* Filesystem. At most HAL_FS_MAX_OPEN files are open at once; handles
+   come from a static pool, so hal_fs_open() returns NULL when it is empty. */
+#define HAL_FS_MAX_OPEN 4
+
 typedef void* hal_file_t;
 int hal_fs_mount(void);
 int hal_fs_unmount(void);
@@ -29,6 +34,21 @@ bool hal_fs_exists(const char* path);
 int hal_fs_seek_end(hal_file_t file);
 int hal_fs_read_byte_at_end(hal_file_t file);
 int hal_fs_size(hal_file_t file);
+/* Moves the position for the next read or write to pos */
+int hal_fs_seek(hal_file_t file, uint32_t pos);
+/* Cuts the file off at the current position */
+int hal_fs_truncate(hal_file_t file);
+/* Grows the file to size bytes, allocating them now rather than as writes
+   reach them: one contiguous extent on the Pico when the file is empty.
+   Nothing is written; the new bytes hold whatever the card held. Returns
+   -1 if they cannot all be reserved. The position afterwards is
+   unspecified. */
+int hal_fs_expand(hal_file_t file, uint32_t size);
+/* Calls fn with the name of each file in directory path ("" for the root)
+   in one pass over the directory, until fn returns false. Returns 0, or -1
+   if the directory cannot be read. */
+typedef bool (*hal_fs_dir_fn)(const char* name, void* user);
+int hal_fs_list_dir(const char* path, hal_fs_dir_fn fn, void* user);
 
 /* Time */
 uint32_t hal_time_ms(void);
@@ -1,9 +1,13 @@
 #ifdef HOST_BUILD
 
 #include "hal/hal.h"
+#include "hal/hal_mock.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 /* ---- Mock state ---- */
 
@@ -24,6 +28,11 @@ static uint32_t mock_time_ms_val;
 
 static char mock_fs_root[HAL_MOCK_MAX_PATH];
 static bool mock_fs_mounted;
+static int mock_fs_open_count;
+static hal_mock_fs_stats_t mock_fs_stats;
+static char mock_fs_watch[HAL_MOCK_MAX_PATH];
+static FILE* mock_fs_unwatched[HAL_FS_MAX_OPEN];
+static bool mock_fs_write_error;
 
 /* ---- Mock control API ---- */
 
@@ -38,6 +47,11 @@ void hal_mock_reset(void) {
     mock_time_ms_val = 0;
     memset(mock_fs_root, 0, sizeof(mock_fs_root));
     mock_fs_mounted = false;
+    mock_fs_open_count = 0;
+    memset(&mock_fs_stats, 0, sizeof(mock_fs_stats));
+    mock_fs_watch[0] = '\0';
+    memset(mock_fs_unwatched, 0, sizeof(mock_fs_unwatched));
+    mock_fs_write_error = false;
 }
 
 void hal_mock_uart_set_data(const char* nmea_data) {
@@ -119,6 +133,17 @@ int hal_uart_read_line(char* buf, size_t buf_size, uint32_t timeout_ms) {
     return (i > 0) ? (int)i : -1;
 }
 
+int hal_uart_read(uint8_t* buf, size_t len, uint32_t timeout_ms) {
+    (void)timeout_ms;
+    if (!buf || len == 0) return -1;
+
+    size_t avail = mock_uart_len - mock_uart_pos;
+    if (len > avail) len = avail;
+    memcpy(buf, mock_uart_buf + mock_uart_pos, len);
+    mock_uart_pos += len;
+    return (int)len;
+}
+
 /* ---- HAL GPIO implementation ---- */
 
 void hal_gpio_init_input(uint32_t pin) {
@@ -146,53 +171,110 @@ static void build_path(char* out, size_t out_size, const char* name) {
 }
 
 int hal_fs_mount(void) {
+    mock_fs_stats.calls++;
     if (mock_fs_root[0] == '\0') return -1;
     mock_fs_mounted = true;
     return 0;
 }
 
 int hal_fs_unmount(void) {
+    mock_fs_stats.calls++;
     mock_fs_mounted = false;
     return 0;
 }
 
 hal_file_t hal_fs_open(const char* path, const char* mode) {
+    mock_fs_stats.calls++;
     if (!mock_fs_mounted) return NULL;
+    /* Same handle limit as the Pico FIL pool */
+    if (mock_fs_open_count >= HAL_FS_MAX_OPEN) return NULL;
     char full[HAL_MOCK_MAX_PATH * 2];
     build_path(full, sizeof(full), path);
     FILE* f = fopen(full, mode);
+    if (f) {
+        mock_fs_open_count++;
+        if (mock_fs_watch[0] != '\0' && strcmp(path, mock_fs_watch) != 0) {
+            for (int i = 0; i < HAL_FS_MAX_OPEN; i++) {
+                if (!mock_fs_unwatched[i]) { mock_fs_unwatched[i] = f; break; }
+            }
+        }
+    }
     return (hal_file_t)f;
 }
 
+void hal_mock_fs_get_stats(hal_mock_fs_stats_t* out) {
+    if (out) *out = mock_fs_stats;
+}
+
+void hal_mock_fs_set_write_error(bool fail) {
+    mock_fs_write_error = fail;
+}
+
+void hal_mock_fs_watch(const char* name) {
+    snprintf(mock_fs_watch, sizeof(mock_fs_watch), "%s", name ? name : "");
+}
+
+static bool watched(hal_file_t file) {
+    for (int i = 0; i < HAL_FS_MAX_OPEN; i++) {
+        if (mock_fs_unwatched[i] == (FILE*)file) return false;
+    }
+    return true;
+}
+
 int hal_fs_write(hal_file_t file, const void* buf, size_t len) {
+    mock_fs_stats.calls++;
     if (!file) return -1;
+    if (mock_fs_write_error) return -1;
     size_t written = fwrite(buf, 1, len, (FILE*)file);
+    long start = ftell((FILE*)file) - (long)written;
+    uint32_t n = (uint32_t)len;
+    hal_mock_fs_stats_t* st = &mock_fs_stats;
+    if (!watched(file)) return (written == len) ? 0 : -1;
+    st->writes++;
+    st->bytes += n;
+    if (st->min_len == 0 || n < st->min_len) st->min_len = n;
+    if (n > st->max_len) st->max_len = n;
+    if ((start + (long)n) % HAL_MOCK_SECTOR_SIZE == 0) {
+        st->aligned_ends++;
+        if (start % HAL_MOCK_SECTOR_SIZE == 0) st->sector_writes++;
+    }
     return (written == len) ? 0 : -1;
 }
 
 int hal_fs_read(hal_file_t file, void* buf, size_t len) {
+    mock_fs_stats.calls++;
     if (!file) return -1;
     size_t rd = fread(buf, 1, len, (FILE*)file);
     return (int)rd;
 }
 
 int hal_fs_sync(hal_file_t file) {
+    mock_fs_stats.calls++;
     if (!file) return -1;
+    if (watched(file)) mock_fs_stats.syncs++;
     return fflush((FILE*)file);
 }
 
 int hal_fs_close(hal_file_t file) {
+    mock_fs_stats.calls++;
     if (!file) return -1;
+    if (mock_fs_open_count > 0) mock_fs_open_count--;
+    for (int i = 0; i < HAL_FS_MAX_OPEN; i++) {
+        if (mock_fs_unwatched[i] == (FILE*)file) mock_fs_unwatched[i] = NULL;
+    }
     return fclose((FILE*)file);
 }
 
 int hal_fs_remove(const char* path) {
+    mock_fs_stats.calls++;
     char full[HAL_MOCK_MAX_PATH * 2];
     build_path(full, sizeof(full), path);
     return remove(full);
 }
 
 bool hal_fs_exists(const char* path) {
+    mock_fs_stats.calls++;
+    mock_fs_stats.exists++;
     char full[HAL_MOCK_MAX_PATH * 2];
     build_path(full, sizeof(full), path);
     FILE* f = fopen(full, "r");
@@ -204,11 +286,13 @@ bool hal_fs_exists(const char* path) {
 }
 
 int hal_fs_seek_end(hal_file_t file) {
+    mock_fs_stats.calls++;
     if (!file) return -1;
     return fseek((FILE*)file, 0, SEEK_END);
 }
 
 int hal_fs_read_byte_at_end(hal_file_t file) {
+    mock_fs_stats.calls++;
     if (!file) return -1;
     FILE* f = (FILE*)file;
     long pos = ftell(f);
@@ -220,6 +304,7 @@ int hal_fs_read_byte_at_end(hal_file_t file) {
 }
 
 int hal_fs_size(hal_file_t file) {
+    mock_fs_stats.calls++;
     if (!file) return -1;
     FILE* f = (FILE*)file;
     long cur = ftell(f);
@@ -229,4 +314,59 @@ int hal_fs_size(hal_file_t file) {
     return (int)size;
 }
 
+int hal_fs_seek(hal_file_t file, uint32_t pos) {
+    mock_fs_stats.calls++;
+    if (!file) return -1;
+    return fseek((FILE*)file, (long)pos, SEEK_SET);
+}
+
+int hal_fs_truncate(hal_file_t file) {
+    mock_fs_stats.calls++;
+    if (!file) return -1;
+    FILE* f = (FILE*)file;
+    long pos = ftell(f);
+    if (pos < 0 || fflush(f) != 0) return -1;
+    return ftruncate(fileno(f), (off_t)pos);
+}
+
+/* No extents on the host: the file just grows, by what reused clusters
+   might hold: rows of an old session, which look like data to anything
+   that reads past the end of it */
+int hal_fs_expand(hal_file_t file, uint32_t size) {
+    static const char stale[] = "2020-01-01T00:00:00Z,0.000000,0.000000,0.00,0.0,0.0,0,0.00,0\n";
+    mock_fs_stats.calls++;
+    mock_fs_stats.expands++;
+    if (!file) return -1;
+    FILE* f = (FILE*)file;
+    if (fseek(f, 0, SEEK_END) != 0) return -1;
+    long pos = ftell(f);
+    while (pos >= 0 && pos < (long)size) {
+        size_t n = (long)size - pos > (long)sizeof(stale) - 1 ? sizeof(stale) - 1 : (size_t)((long)size - pos);
+        if (fwrite(stale, 1, n, f) != n) return -1;
+        pos += (long)n;
+    }
+    return pos < 0 ? -1 : 0;
+}
+
+int hal_fs_list_dir(const char* path, hal_fs_dir_fn fn, void* user) {
+    mock_fs_stats.calls++;
+    mock_fs_stats.list_dirs++;
+    if (!mock_fs_mounted || !path || !fn) return -1;
+    char full[HAL_MOCK_MAX_PATH * 2];
+    build_path(full, sizeof(full), path);
+    DIR* dir = opendir(full);
+    if (!dir) return -1;
+    struct dirent* e;
+    while ((e = readdir(dir)) != NULL) {
+        /* Files only, as f_readdir() entries without AM_DIR */
+        char entry[HAL_MOCK_MAX_PATH * 3];
+        struct stat st;
+        snprintf(entry, sizeof(entry), "%s/%s", full, e->d_name);
+        if (stat(entry, &st) != 0 || !S_ISREG(st.st_mode)) continue;
+        if (!fn(e->d_name, user)) break;
+    }
+    closedir(dir);
+    return 0;
+}
+
 #endif /* HOST_BUILD */
@@ -16,6 +16,31 @@ void hal_mock_time_set_ms(uint32_t ms);
 void hal_mock_time_advance_ms(uint32_t ms);
 void hal_mock_fs_set_root(const char* path);
 
+/* Filesystem calls since hal_mock_reset() */
+#define HAL_MOCK_SECTOR_SIZE 512
+
+typedef struct {
+    uint32_t calls;             /* every hal_fs_*() call */
+    uint32_t exists;            /* hal_fs_exists() */
+    uint32_t list_dirs;         /* hal_fs_list_dir() */
+    uint32_t expands;           /* hal_fs_expand() */
+    uint32_t writes;            /* hal_fs_write() */
+    uint32_t bytes;
+    uint32_t min_len;           /* 0 before the first write */
+    uint32_t max_len;
+    uint32_t sector_writes;     /* start and end on a sector boundary of the file */
+    uint32_t aligned_ends;      /* end on one, wherever they start */
+    uint32_t syncs;             /* hal_fs_sync() */
+} hal_mock_fs_stats_t;
+
+void hal_mock_fs_get_stats(hal_mock_fs_stats_t* out);
+/* From now on writes and syncs are counted only for files opened by this
+   name, e.g. a track file apart from _dirty ("" or NULL: all files) */
+void hal_mock_fs_watch(const char* name);
+/* While set, hal_fs_write() writes nothing and returns -1, as on a card
+   that has failed */
+void hal_mock_fs_set_write_error(bool fail);
+
 #endif /* HOST_BUILD */
 
 #endif /* HAL_MOCK_H */
@@ -41,6 +41,23 @@ int hal_uart_read_line(char* buf, size_t buf_size, uint32_t timeout_ms) {
     return (i > 0) ? (int)i : -1;
 }
 
+int hal_uart_read(uint8_t* buf, size_t len, uint32_t timeout_ms) {
+    if (!buf || len == 0) {
+        return -1;
+    }
+
+    if (!uart_is_readable_within_us(GPS_UART, (uint64_t)(timeout_ms) * 1000)) {
+        return 0;
+    }
+
+    /* Drain the FIFO without waiting for more */
+    size_t n = 0;
+    while (n < len && uart_is_readable(GPS_UART)) {
+        buf[n++] = (uint8_t)uart_getc(GPS_UART);
+    }
+    return (int)n;
+}
+
 /* ---- GPIO ---- */
 
 void hal_gpio_init_input(uint32_t pin) {
@@ -102,12 +119,33 @@ int hal_fs_unmount(void) {
     return -1;
 }
 
+/* FIL objects are several hundred bytes; keep them out of the heap */
+static FIL fil_pool[HAL_FS_MAX_OPEN];
+static bool fil_in_use[HAL_FS_MAX_OPEN];
+
+static FIL* fil_alloc(void) {
+    for (int i = 0; i < HAL_FS_MAX_OPEN; i++) {
+        if (!fil_in_use[i]) {
+            fil_in_use[i] = true;
+            return &fil_pool[i];
+        }
+    }
+    return NULL;
+}
+
+static void fil_release(FIL* file) {
+    int i = (int)(file - fil_pool);
+    if (i >= 0 && i < HAL_FS_MAX_OPEN) {
+        fil_in_use[i] = false;
+    }
+}
+
 hal_file_t hal_fs_open(const char* path, const char* mode) {
     if (!path || !mode) {
         return NULL;
     }
 
-    FIL *file = malloc(sizeof(FIL));
+    FIL *file = fil_alloc();
     if (!file) {
         return NULL;
     }
@@ -122,10 +160,13 @@ hal_file_t hal_fs_open(const char* path, const char* mode) {
     if (strchr(mode, 'a')) {
         f_mode |= (FA_WRITE | FA_OPEN_ALWAYS);
     }
+    if (strchr(mode, '+')) {
+        f_mode |= FA_WRITE;
+    }
 
     FRESULT res = f_open(file, path, f_mode);
     if (res != FR_OK) {
-        free(file);
+        fil_release(file);
         return NULL;
     }
 
@@ -184,7 +225,7 @@ int hal_fs_close(hal_file_t file) {
     }
 
     FRESULT res = f_close((FIL *)file);
-    free(file);
+    fil_release((FIL *)file);
     if (res != FR_OK) {
         return -1;
     }
@@ -278,6 +319,92 @@ int hal_fs_size(hal_file_t file) {
     return (int)size;
 }
 
+int hal_fs_seek(hal_file_t file, uint32_t pos) {
+    if (!file) {
+        return -1;
+    }
+
+    FRESULT res = f_lseek((FIL *)file, pos);
+    if (res != FR_OK) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int hal_fs_truncate(hal_file_t file) {
+    if (!file) {
+        return -1;
+    }
+
+    FRESULT res = f_truncate((FIL *)file);
+    if (res != FR_OK) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* hal_fs_expand() lays the first extent of a track file with f_expand(),
+   which ffconf.h leaves out by default */
+#if !FF_USE_EXPAND
+#error "Set FF_USE_EXPAND to 1 in the FatFs ffconf.h (README, FatFS SD card library)"
+#endif
+
+/* Allocates clusters without writing them. f_expand() only takes an empty
+   file; for one with data, a seek past the end in write mode grows the
+   cluster chain, which FatFs documents as pre-allocation. That chain, and
+   the fallback when no free area is large enough, need not be contiguous. */
+int hal_fs_expand(hal_file_t file, uint32_t size) {
+    if (!file) {
+        return -1;
+    }
+
+    FIL *f = (FIL *)file;
+    FSIZE_t pos = f_size(f);
+    if (size <= pos) {
+        return 0;
+    }
+
+    /* One contiguous extent when there is a free area that large */
+    if (pos == 0 && f_expand(f, size, 1) == FR_OK) {
+        return 0;
+    }
+
+    /* Stops short when the card is full: the writes allocate the rest */
+    FRESULT res = f_lseek(f, size);
+    if (res != FR_OK || f_tell(f) != size) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int hal_fs_list_dir(const char* path, hal_fs_dir_fn fn, void* user) {
+    if (!path || !fn) {
+        return -1;
+    }
+
+    DIR dir;
+    if (f_opendir(&dir, path) != FR_OK) {
+        return -1;
+    }
+
+    FILINFO fno;
+    FRESULT res;
+    while ((res = f_readdir(&dir, &fno)) == FR_OK && fno.fname[0] != '\0') {
+        if (fno.fattrib & AM_DIR) {
+            continue;
+        }
+        if (!fn(fno.fname, user)) {
+            break;
+        }
+    }
+    f_closedir(&dir);
+
+    return (res == FR_OK) ? 0 : -1;
+}
+
 /* ---- Time ---- */
 
 #include "ff.h"
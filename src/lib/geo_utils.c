@@ -1,5 +1,6 @@
 #include "geo_utils.h"
 #include <math.h>
+#include <stdbool.h>
 
 #define DEG_TO_RAD (3.14159265358979323846 / 180.0)
 
@@ -14,3 +15,93 @@ double haversine_distance_m(double lat1, double lon1, double lat2, double lon2)
     double c = 2.0 * atan2(sqrt(a), sqrt(1.0 - a));
     return EARTH_RADIUS_M * c;
 }
+
+#define DEG_TO_RAD_F 0.017453292519943295f
+
+static float haversine_f(float lat1, float lat2, float dlat, float dlon) {
+    float sdlat = sinf(dlat * 0.5f);
+    float sdlon = sinf(dlon * 0.5f);
+    float a = sdlat * sdlat + cosf(lat1) * cosf(lat2) * sdlon * sdlon;
+    float c = 2.0f * atan2f(sqrtf(a), sqrtf(1.0f - a));
+    return (float)EARTH_RADIUS_M * c;
+}
+
+float haversine_distance_mf(float lat1, float lon1, float lat2, float lon2) {
+    return haversine_f(lat1 * DEG_TO_RAD_F, lat2 * DEG_TO_RAD_F,
+                       (lat2 - lat1) * DEG_TO_RAD_F, (lon2 - lon1) * DEG_TO_RAD_F);
+}
+
+float haversine_distance_e6_mf(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2) {
+    /* Integer deltas are exact; only the result of the subtraction is rounded */
+    const float e6_to_rad = DEG_TO_RAD_F * 1e-6f;
+    return haversine_f((float)lat1 * e6_to_rad, (float)lat2 * e6_to_rad,
+                       (float)(lat2 - lat1) * e6_to_rad,
+                       (float)geo_dlon_e6(lon1, lon2) * e6_to_rad);
+}
+
+#define E6_TO_RAD_F (DEG_TO_RAD_F * 1e-6f)
+
+float geo_m_per_e6_lon_f(int32_t lat_e6) {
+    return GEO_M_PER_E6_F * cosf((float)lat_e6 * E6_TO_RAD_F);
+}
+
+/* Re-take cos/sin once the reference latitude is 0.01 deg (1.1 km) behind */
+#define COS_CACHE_REKEY_E6 10000
+
+/* Deltas and cos(mid-latitude) for the equirectangular path, or false when
+   the pair is past the latitude threshold or clearly past the distance one.
+   cos(k + h) ~ cos k - h sin k; h stays under 2.6e-4 rad on the fast path,
+   so the dropped h^2/2 term is below 4e-8. */
+static bool fast_setup(geo_cos_cache_t* cache, int32_t lat1, int32_t lon1,
+                       int32_t lat2, int32_t lon2,
+                       int32_t* dlat, int32_t* dlon, float* cos_mid) {
+    const int32_t max_lat = (int32_t)(GEO_FAST_MAX_LAT_DEG * 1e6);
+    const int32_t max_delta = (int32_t)(GEO_FAST_MAX_DISTANCE_M / GEO_M_PER_E6) + 1;
+    if (lat1 > max_lat || lat1 < -max_lat || lat2 > max_lat || lat2 < -max_lat) return false;
+
+    int32_t dx = geo_dlon_e6(lon1, lon2);
+    int32_t dy = lat2 - lat1;
+    if (dy > max_delta || dy < -max_delta) return false;
+    if (dx > 6 * max_delta || dx < -6 * max_delta) return false;   /* 1/cos(80 deg) < 6 */
+
+    geo_cos_cache_t local = {0};
+    if (!cache) cache = &local;
+    int32_t off = lat1 - cache->lat_e6;
+    if (cache->cos_lat == 0.0f || off > COS_CACHE_REKEY_E6 || off < -COS_CACHE_REKEY_E6) {
+        float r = (float)lat1 * E6_TO_RAD_F;
+        cache->lat_e6 = lat1;
+        cache->cos_lat = cosf(r);
+        cache->sin_lat = sinf(r);
+    }
+    float h = ((float)(lat1 - cache->lat_e6) + (float)dy * 0.5f) * E6_TO_RAD_F;
+    *cos_mid = cache->cos_lat - h * cache->sin_lat;
+    *dlat = dy;
+    *dlon = dx;
+    return true;
+}
+
+double geo_distance_fast_m(geo_cos_cache_t* cache, int32_t lat1, int32_t lon1,
+                           int32_t lat2, int32_t lon2) {
+    int32_t dlat, dlon;
+    float cos_mid;
+    if (fast_setup(cache, lat1, lon1, lat2, lon2, &dlat, &dlon, &cos_mid)) {
+        double y = dlat * GEO_M_PER_E6;
+        double x = dlon * GEO_M_PER_E6 * cos_mid;
+        double d2 = x * x + y * y;
+        if (d2 <= GEO_FAST_MAX_DISTANCE_M * GEO_FAST_MAX_DISTANCE_M) return sqrt(d2);
+    }
+    return haversine_distance_m(lat1 / 1e6, lon1 / 1e6, lat2 / 1e6, lon2 / 1e6);
+}
+
+float geo_distance_fast_mf(geo_cos_cache_t* cache, int32_t lat1, int32_t lon1,
+                           int32_t lat2, int32_t lon2) {
+    int32_t dlat, dlon;
+    float cos_mid;
+    if (fast_setup(cache, lat1, lon1, lat2, lon2, &dlat, &dlon, &cos_mid)) {
+        float y = (float)dlat * GEO_M_PER_E6_F;
+        float x = (float)dlon * GEO_M_PER_E6_F * cos_mid;
+        float d2 = x * x + y * y;
+        if (d2 <= (float)(GEO_FAST_MAX_DISTANCE_M * GEO_FAST_MAX_DISTANCE_M)) return sqrtf(d2);
+    }
+    return haversine_distance_e6_mf(lat1, lon1, lat2, lon2);
+}
@@ -1,8 +1,109 @@
 #ifndef GEO_UTILS_H
 #define GEO_UTILS_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #define EARTH_RADIUS_M 6371000.0
 
 double haversine_distance_m(double lat1, double lon1, double lat2, double lon2);
 
+/* float32 haversine for single-precision FPUs (Cortex-M33). Worst error
+   against haversine_distance_m() over random pairs (tests/test_geo_utils.c
+   checks these bounds):
+   - _mf, float degrees: up to 1.7 m below 1 km, from rounding the inputs
+     to float (1.5e-5 deg at |lon| > 128).
+   - _e6_mf, micro-degrees as in gps_fix_packed_t: the deltas are exact
+     integers, so under 6 cm below 1 km (2 mm up to 85 deg latitude). That
+     is under 0.1 km/h at the filter's 250 km/h gate even at 0.5 s.
+   Both stay within 6 m up to 15,000 km; near-antipodal pairs are
+   ill-conditioned in float and can be off by ~1.5 km. */
+float  haversine_distance_mf(float lat1, float lon1, float lat2, float lon2);
+float  haversine_distance_e6_mf(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2);
+
+/* Short-range distance between micro-degree positions: an equirectangular
+   projection at the mid-latitude, within 1 mm of haversine_distance_m().
+   Pairs further apart than GEO_FAST_MAX_DISTANCE_M, or with a latitude past
+   GEO_FAST_MAX_LAT_DEG, go to haversine_distance_m() (_mf:
+   haversine_distance_e6_mf()). */
+#define GEO_FAST_MAX_DISTANCE_M 1000.0
+#define GEO_FAST_MAX_LAT_DEG    80.0
+
+/* cos/sin of a reference latitude, re-taken when lat1 moves 0.01 deg away
+   from it, so a track pays for the trig about once per kilometre.
+   Zero-initialise before first use; NULL disables caching. */
+typedef struct {
+    int32_t lat_e6;
+    float cos_lat;              /* 0 = empty */
+    float sin_lat;
+} geo_cos_cache_t;
+
+double geo_distance_fast_m(geo_cos_cache_t* cache, int32_t lat1, int32_t lon1,
+                           int32_t lat2, int32_t lon2);
+float  geo_distance_fast_mf(geo_cos_cache_t* cache, int32_t lat1, int32_t lon1,
+                            int32_t lat2, int32_t lon2);
+
+/* Local east/north metres around a reference point, for the modules that
+   work on a tangent plane (Kalman origin, simplifier anchor, stationary
+   window). One micro-degree of latitude is GEO_M_PER_E6 metres; one of
+   longitude is geo_m_per_e6_lon_f() of the reference latitude, taken once
+   per reference. */
+#define GEO_M_PER_E6   (EARTH_RADIUS_M * 3.14159265358979323846 / 180.0 * 1e-6)
+#define GEO_M_PER_E6_F ((float)GEO_M_PER_E6)
+
+float geo_m_per_e6_lon_f(int32_t lat_e6);
+
+/* A longitude up to 360 deg out of range, wrapped back to [-180, 180] deg */
+static inline int32_t geo_wrap_lon_e6(int64_t lon_e6) {
+    if (lon_e6 > 180000000) lon_e6 -= 360000000;
+    if (lon_e6 < -180000000) lon_e6 += 360000000;
+    return (int32_t)lon_e6;
+}
+
+/* lon2 - lon1 in micro-degrees, wrapped so that pairs across the
+   antimeridian keep a small, exactly representable delta */
+static inline int32_t geo_dlon_e6(int32_t lon1, int32_t lon2) {
+    return geo_wrap_lon_e6((int64_t)lon2 - lon1);
+}
+
+/* Metres east and north of (ref_lat_e6, ref_lon_e6), with m_per_e6_lon
+   from geo_m_per_e6_lon_f(ref_lat_e6) */
+static inline void geo_e6_delta_m(int32_t ref_lat_e6, int32_t ref_lon_e6, float m_per_e6_lon,
+                                  int32_t lat_e6, int32_t lon_e6, float* east_m, float* north_m) {
+    *east_m = (float)geo_dlon_e6(ref_lon_e6, lon_e6) * m_per_e6_lon;
+    *north_m = (float)(lat_e6 - ref_lat_e6) * GEO_M_PER_E6_F;
+}
+
+/* Haversine over a structure-of-arrays track in degrees: out[i] is the
+   distance from point i to point i + 1, so out receives n - 1 values.
+   Vectorised on x86 (AVX2+FMA or SSE2, picked at run time), within 1e-11
+   relative of haversine_distance_m(); haversine_distance_m() per pair
+   elsewhere. _simd runs at most the given level, for tests and benchmarks. */
+typedef enum {
+    GEO_SIMD_SCALAR = 0,
+    GEO_SIMD_SSE2,
+    GEO_SIMD_AVX2
+} geo_simd_t;
+
+geo_simd_t geo_simd_available(void);
+void       geo_distance_batch(const double* lat, const double* lon, size_t n, double* out);
+void       geo_distance_batch_simd(geo_simd_t simd, const double* lat, const double* lon,
+                                   size_t n, double* out);
+
+/* Distance for the filter's speed gate, as geo_real_t: the float32 kernels
+   when built with GEO_USE_FLOAT=1 (default on the Pico), double otherwise */
+#ifndef GEO_USE_FLOAT
+#define GEO_USE_FLOAT 0
+#endif
+
+#if GEO_USE_FLOAT
+typedef float geo_real_t;
+#define geo_distance_e6_m(cache, lat1, lon1, lat2, lon2) \
+    geo_distance_fast_mf(cache, lat1, lon1, lat2, lon2)
+#else
+typedef double geo_real_t;
+#define geo_distance_e6_m(cache, lat1, lon1, lat2, lon2) \
+    geo_distance_fast_m(cache, lat1, lon1, lat2, lon2)
+#endif
+
 #endif
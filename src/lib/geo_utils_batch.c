@@ -0,0 +1,205 @@
+#include "geo_utils.h"
+#include <math.h>
+
+/* geo_distance_batch(): haversine over SoA tracks. On x86 the pairs go four
+   (AVX2+FMA) or two (SSE2) at a time through polynomial sin/cos/asin
+   kernels, chosen once at run time; elsewhere, and for the tail, it is
+   haversine_distance_m() per pair. */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GEO_BATCH_X86 1
+#include <immintrin.h>
+#else
+#define GEO_BATCH_X86 0
+#endif
+
+#define DEG_TO_RAD (3.14159265358979323846 / 180.0)
+#define HALF_PI    1.57079632679489661923
+#define PI         3.14159265358979323846
+
+static void batch_scalar(const double* lat, const double* lon, size_t from, size_t n, double* out) {
+    for (size_t i = from; i + 1 < n; i++) {
+        out[i] = haversine_distance_m(lat[i], lon[i], lat[i + 1], lon[i + 1]);
+    }
+}
+
+#if GEO_BATCH_X86
+
+/* Taylor coefficients. Every argument is kept within [-pi/2, pi/2] (sin,
+   cos) or [0, 1/2] (asin), where the dropped terms are below 1e-17. */
+static const double SIN_C[] = {
+    -3.8681701706306841e-23, 1.9572941063391263e-20, -8.2206352466243295e-18,
+    2.8114572543455206e-15, -7.6471637318198164e-13, 1.6059043836821613e-10,
+    -2.505210838544172e-08, 2.7557319223985893e-06, -0.00019841269841269841,
+    0.0083333333333333332, -0.16666666666666666, 1.0,
+};
+static const double COS_C[] = {
+    1.6117375710961184e-24, -8.8967913924505741e-22, 4.1103176233121648e-19,
+    -1.5619206968586225e-16, 4.7794773323873853e-14, -1.1470745597729725e-11,
+    2.08767569878681e-09, -2.7557319223985888e-07, 2.4801587301587302e-05,
+    -0.0013888888888888889, 0.041666666666666664, -0.5, 1.0,
+};
+static const double ASIN_C[] = {
+    0.0022014739737101384, 0.002338091892111975, 0.0024894486782468836,
+    0.0026578706382072901, 0.0028461784011089421, 0.0030578216492580306,
+    0.0032970595034734849, 0.0035692053938259347, 0.0038809645588376691,
+    0.0042409070936793632, 0.0046601434869150962, 0.0051533096823199046,
+    0.0057400376708419236, 0.0064472103118896487, 0.0073125258735988454,
+    0.0083903358096168151, 0.0097616095291940784, 0.011551800896139705,
+    0.013964843750000001, 0.017352764423076924, 0.022372159090909092,
+    0.030381944444444444, 0.044642857142857144, 0.074999999999999997,
+    0.16666666666666666, 1.0,
+};
+#define N_COEF(c) (sizeof(c) / sizeof((c)[0]))
+
+/* ---- AVX2 + FMA, four pairs per step ---- */
+
+#define AVX2 __attribute__((target("avx2,fma")))
+
+AVX2 static inline __m256d horner4(__m256d t, const double* c, size_t n) {
+    __m256d r = _mm256_set1_pd(c[0]);
+    for (size_t k = 1; k < n; k++) r = _mm256_fmadd_pd(r, t, _mm256_set1_pd(c[k]));
+    return r;
+}
+
+AVX2 static inline __m256d sin4(__m256d x) {
+    return _mm256_mul_pd(x, horner4(_mm256_mul_pd(x, x), SIN_C, N_COEF(SIN_C)));
+}
+
+AVX2 static inline __m256d cos4(__m256d x) {
+    return horner4(_mm256_mul_pd(x, x), COS_C, N_COEF(COS_C));
+}
+
+/* 2 asin(s) for s in [0, 1]; above 1/2 via asin(s) = pi/2 - 2 asin(sqrt((1 - s) / 2)) */
+AVX2 static inline __m256d two_asin4(__m256d s) {
+    __m256d half = _mm256_set1_pd(0.5);
+    __m256d big = _mm256_cmp_pd(s, half, _CMP_GT_OQ);
+    __m256d r = _mm256_sqrt_pd(_mm256_mul_pd(_mm256_sub_pd(_mm256_set1_pd(1.0), s), half));
+    __m256d x = _mm256_blendv_pd(s, r, big);
+    __m256d p = _mm256_mul_pd(x, horner4(_mm256_mul_pd(x, x), ASIN_C, N_COEF(ASIN_C)));
+    __m256d two_p = _mm256_add_pd(p, p);
+    __m256d from_big = _mm256_sub_pd(_mm256_set1_pd(PI), _mm256_add_pd(two_p, two_p));
+    return _mm256_blendv_pd(two_p, from_big, big);
+}
+
+/* Half angle in [-pi/2, pi/2] with the same sin^2: shift by pi past pi/2 */
+AVX2 static inline __m256d fold4(__m256d h) {
+    __m256d pi = _mm256_set1_pd(PI), hp = _mm256_set1_pd(HALF_PI);
+    h = _mm256_sub_pd(h, _mm256_and_pd(_mm256_cmp_pd(h, hp, _CMP_GT_OQ), pi));
+    return _mm256_add_pd(h, _mm256_and_pd(_mm256_cmp_pd(h, _mm256_sub_pd(_mm256_setzero_pd(), hp),
+                                                        _CMP_LT_OQ), pi));
+}
+
+AVX2 static size_t batch_avx2(const double* lat, const double* lon, size_t n, double* out) {
+    const __m256d k = _mm256_set1_pd(DEG_TO_RAD);
+    const __m256d k_half = _mm256_set1_pd(DEG_TO_RAD * 0.5);
+    const __m256d one = _mm256_set1_pd(1.0), zero = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 < n; i += 4) {
+        __m256d lat1 = _mm256_loadu_pd(lat + i), lat2 = _mm256_loadu_pd(lat + i + 1);
+        __m256d lon1 = _mm256_loadu_pd(lon + i), lon2 = _mm256_loadu_pd(lon + i + 1);
+        __m256d sdlat = sin4(_mm256_mul_pd(_mm256_sub_pd(lat2, lat1), k_half));
+        __m256d sdlon = sin4(fold4(_mm256_mul_pd(_mm256_sub_pd(lon2, lon1), k_half)));
+        __m256d cc = _mm256_mul_pd(cos4(_mm256_mul_pd(lat1, k)), cos4(_mm256_mul_pd(lat2, k)));
+        __m256d a = _mm256_fmadd_pd(_mm256_mul_pd(cc, sdlon), sdlon, _mm256_mul_pd(sdlat, sdlat));
+        a = _mm256_min_pd(_mm256_max_pd(a, zero), one);
+        __m256d c = two_asin4(_mm256_sqrt_pd(a));
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(c, _mm256_set1_pd(EARTH_RADIUS_M)));
+    }
+    return i;
+}
+
+/* ---- SSE2, two pairs per step ---- */
+
+#define SSE2 __attribute__((target("sse2")))
+
+SSE2 static inline __m128d horner2(__m128d t, const double* c, size_t n) {
+    __m128d r = _mm_set1_pd(c[0]);
+    for (size_t k = 1; k < n; k++) r = _mm_add_pd(_mm_mul_pd(r, t), _mm_set1_pd(c[k]));
+    return r;
+}
+
+SSE2 static inline __m128d sin2(__m128d x) {
+    return _mm_mul_pd(x, horner2(_mm_mul_pd(x, x), SIN_C, N_COEF(SIN_C)));
+}
+
+SSE2 static inline __m128d cos2(__m128d x) {
+    return horner2(_mm_mul_pd(x, x), COS_C, N_COEF(COS_C));
+}
+
+SSE2 static inline __m128d select2(__m128d mask, __m128d a, __m128d b) {
+    return _mm_or_pd(_mm_and_pd(mask, b), _mm_andnot_pd(mask, a));
+}
+
+SSE2 static inline __m128d two_asin2(__m128d s) {
+    __m128d half = _mm_set1_pd(0.5);
+    __m128d big = _mm_cmpgt_pd(s, half);
+    __m128d r = _mm_sqrt_pd(_mm_mul_pd(_mm_sub_pd(_mm_set1_pd(1.0), s), half));
+    __m128d x = select2(big, s, r);
+    __m128d p = _mm_mul_pd(x, horner2(_mm_mul_pd(x, x), ASIN_C, N_COEF(ASIN_C)));
+    __m128d two_p = _mm_add_pd(p, p);
+    __m128d from_big = _mm_sub_pd(_mm_set1_pd(PI), _mm_add_pd(two_p, two_p));
+    return select2(big, two_p, from_big);
+}
+
+SSE2 static inline __m128d fold2(__m128d h) {
+    __m128d pi = _mm_set1_pd(PI), hp = _mm_set1_pd(HALF_PI);
+    h = _mm_sub_pd(h, _mm_and_pd(_mm_cmpgt_pd(h, hp), pi));
+    return _mm_add_pd(h, _mm_and_pd(_mm_cmplt_pd(h, _mm_sub_pd(_mm_setzero_pd(), hp)), pi));
+}
+
+SSE2 static size_t batch_sse2(const double* lat, const double* lon, size_t n, double* out) {
+    const __m128d k = _mm_set1_pd(DEG_TO_RAD);
+    const __m128d k_half = _mm_set1_pd(DEG_TO_RAD * 0.5);
+    const __m128d one = _mm_set1_pd(1.0), zero = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 2 < n; i += 2) {
+        __m128d lat1 = _mm_loadu_pd(lat + i), lat2 = _mm_loadu_pd(lat + i + 1);
+        __m128d lon1 = _mm_loadu_pd(lon + i), lon2 = _mm_loadu_pd(lon + i + 1);
+        __m128d sdlat = sin2(_mm_mul_pd(_mm_sub_pd(lat2, lat1), k_half));
+        __m128d sdlon = sin2(fold2(_mm_mul_pd(_mm_sub_pd(lon2, lon1), k_half)));
+        __m128d cc = _mm_mul_pd(cos2(_mm_mul_pd(lat1, k)), cos2(_mm_mul_pd(lat2, k)));
+        __m128d a = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(cc, sdlon), sdlon), _mm_mul_pd(sdlat, sdlat));
+        a = _mm_min_pd(_mm_max_pd(a, zero), one);
+        __m128d c = two_asin2(_mm_sqrt_pd(a));
+        _mm_storeu_pd(out + i, _mm_mul_pd(c, _mm_set1_pd(EARTH_RADIUS_M)));
+    }
+    return i;
+}
+
+#endif /* GEO_BATCH_X86 */
+
+geo_simd_t geo_simd_available(void) {
+#if GEO_BATCH_X86
+    static int level = -1;
+    if (level < 0) {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            level = GEO_SIMD_AVX2;
+        } else if (__builtin_cpu_supports("sse2")) {
+            level = GEO_SIMD_SSE2;
+        } else {
+            level = GEO_SIMD_SCALAR;
+        }
+    }
+    return (geo_simd_t)level;
+#else
+    return GEO_SIMD_SCALAR;
+#endif
+}
+
+void geo_distance_batch_simd(geo_simd_t simd, const double* lat, const double* lon,
+                             size_t n, double* out) {
+    if (!lat || !lon || !out) return;
+    if (simd > geo_simd_available()) simd = geo_simd_available();
+    size_t done = 0;
+#if GEO_BATCH_X86
+    if (simd == GEO_SIMD_AVX2) done = batch_avx2(lat, lon, n, out);
+    else if (simd == GEO_SIMD_SSE2) done = batch_sse2(lat, lon, n, out);
+#endif
+    batch_scalar(lat, lon, done, n, out);
+}
+
+void geo_distance_batch(const double* lat, const double* lon, size_t n, double* out) {
+    geo_distance_batch_simd(geo_simd_available(), lat, lon, n, out);
+}
@@ -0,0 +1,34 @@
+#include "time_utils.h"
+
+/* H. Hinnant, "chrono-Compatible Low-Level Date Algorithms": eras of 400
+   years starting on March 1st, so the leap day is the last day of a year */
+int32_t days_from_civil(int32_t year, uint32_t month, uint32_t day) {
+    year -= month <= 2;
+    int32_t era = (year >= 0 ? year : year - 399) / 400;
+    uint32_t yoe = (uint32_t)(year - era * 400);                        /* [0, 399] */
+    uint32_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;               /* [0, 146096] */
+    return era * 146097 + (int32_t)doe - 719468;
+}
+
+void civil_from_days(int32_t days, int32_t* year, uint32_t* month, uint32_t* day) {
+    days += 719468;
+    int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+    uint32_t doe = (uint32_t)(days - era * 146097);
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    *day = doy - (153 * mp + 2) / 5 + 1;
+    *month = mp < 10 ? mp + 3 : mp - 9;
+    *year = (int32_t)yoe + era * 400 + (*month <= 2);
+}
+
+int32_t civil_day_cache_days(civil_day_cache_t* cache, uint16_t year, uint8_t month, uint8_t day) {
+    uint32_t key = ((uint32_t)year << 9) | ((uint32_t)month << 5) | day;
+    if (!cache) return days_from_civil(year, month, day);
+    if (cache->key != key) {
+        cache->days = days_from_civil(year, month, day);
+        cache->key = key;
+    }
+    return cache->days;
+}
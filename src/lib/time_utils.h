@@ -0,0 +1,21 @@
+#ifndef TIME_UTILS_H
+#define TIME_UTILS_H
+
+#include <stdint.h>
+
+#define MS_PER_DAY 86400000u
+
+/* Days since 1970-01-01 of a proleptic Gregorian date, and back */
+int32_t days_from_civil(int32_t year, uint32_t month, uint32_t day);
+void    civil_from_days(int32_t days, int32_t* year, uint32_t* month, uint32_t* day);
+
+/* One-entry memo for days_from_civil(). Fixes arrive in date order, so the
+   conversion runs once per day. Zero-initialise before first use. */
+typedef struct {
+    uint32_t key;               /* year << 9 | month << 5 | day, 0 = empty */
+    int32_t days;
+} civil_day_cache_t;
+
+int32_t civil_day_cache_days(civil_day_cache_t* cache, uint16_t year, uint8_t month, uint8_t day);
+
+#endif
@@ -1,7 +1,8 @@
 #ifndef HOST_BUILD
 
-#include "nmea_parser.h"
+#include "gps_stream.h"
 #include "gps_filter.h"
+#include "track_simplify.h"
 #include "data_storage.h"
 #include "power_mgmt.h"
 #include "hal/hal.h"
@@ -10,11 +11,85 @@
 
 #define GPS_BAUD_RATE 9600
 
+#define GPS_UART_CHUNK 64
+#define GPS_UART_TIMEOUT_MS 100
+
+/* Emit each fix once GGA+RMC are in; flush after this if one is missing */
+#define GPS_EPOCH_TIMEOUT_MS 500
+
 #ifdef HW_VALIDATION_TEST
 #define HW_TEST_WRITE_WINDOW_MS 30000
 #endif
 
+typedef struct {
+    gps_filter_t filter;
+    gps_filter_trace_t filter_trace;
+    track_simplify_t simplify;
+    data_storage_t storage;
+#ifdef HW_VALIDATION_TEST
+    uint32_t fix_count;
+    bool got_first_fix;
+    uint32_t write_window_start;
+#endif
+} tracker_t;
+
+/* Simplifier output: the fixes that make it to the SD card */
+static void on_simplified(const gps_fix_packed_t* fix, void* user) {
+    tracker_t* t = (tracker_t*)user;
+    data_storage_write_packed(&t->storage, fix);
+}
+
+/* Filter counters and rejected-fix trace, as comment lines at the end of the track */
+static void on_trailer_line(const char* line, size_t len, void* user) {
+    data_storage_write_comment((data_storage_t*)user, line, len);
+}
+
+/* Fix callback: runs once per completed epoch, straight from the NMEA or UBX parser */
+static void on_fix(const gps_fix_t* fix, void* user) {
+    tracker_t* t = (tracker_t*)user;
+
+    /* Validity gate */
+    if (!(fix->flags & GPS_FIX_VALID) || !(fix->flags & GPS_HAS_LATLON)) return;
+
+#ifdef HW_VALIDATION_TEST
+    /* Skip filter in validation mode (stationary device) */
+    if (!t->got_first_fix) {
+        t->got_first_fix = true;
+        t->write_window_start = hal_time_ms();
+        printf("*** FIRST FIX! lat=%.6f lon=%.6f sats=%d ***\n",
+               fix->latitude, fix->longitude, fix->satellites);
+        printf("Starting 30s write window...\n");
+    }
+
+    /* Store */
+    data_storage_write_fix(&t->storage, fix);
+    t->fix_count++;
+    printf("FIX #%lu: %.6f,%.6f sats=%d\n",
+           (unsigned long)t->fix_count, fix->latitude, fix->longitude, fix->satellites);
+#else
+    /* Filter: reject stationary and outlier fixes */
+    if (gps_filter_process(&t->filter, fix) != FILTER_ACCEPT) return;
+#if GPS_FILTER_KALMAN
+    gps_fix_t smoothed = *fix;
+    gps_filter_smooth(&t->filter, &smoothed);
+    fix = &smoothed;
+#endif
+
+    /* Simplify, then store through on_simplified(). A stop point is
+       written at once rather than held until the car moves again. */
+    gps_fix_packed_t packed;
+    gps_fix_pack(fix, &packed);
+    track_simplify_push(&t->simplify, &packed);
+    if (gps_filter_get_state(&t->filter) == FILTER_STATE_STOPPED) {
+        track_simplify_flush(&t->simplify);
+    }
+#endif
+}
+
 int main(void) {
+    static tracker_t tracker;
+    static gps_stream_storage_t gps_storage;
+
     stdio_init_all();
 
 #ifdef HW_VALIDATION_TEST
@@ -31,41 +106,46 @@ int main(void) {
     hal_uart_init(GPS_BAUD_RATE);
 
     /* 3. Initialize storage */
-    data_storage_t storage;
-    if (data_storage_init(&storage) != STORAGE_OK) {
+    if (data_storage_init(&tracker.storage) != STORAGE_OK) {
         printf("ERROR: storage init failed\n");
         while (1) { /* halt */ }
     }
-    printf("Storage OK, file: %s\n", data_storage_get_filename(&storage));
-
-    /* 4. Initialize NMEA parser */
-    nmea_parser_t* parser = nmea_parser_create();
-    if (!parser) {
-        data_storage_shutdown(&storage);
-        while (1) { /* halt */ }
-    }
-
-    /* 5. Initialize GPS filter (COLD_START) */
-    gps_filter_t filter;
-    gps_filter_init(&filter);
-
-#ifdef HW_VALIDATION_TEST
-    uint32_t fix_count = 0;
-    bool got_first_fix = false;
-    uint32_t write_window_start = 0;
-#endif
+    printf("Storage OK, file: %s\n", data_storage_get_filename(&tracker.storage));
+
+    /* 4. Initialize GPS stream parsers (NMEA or UBX NAV-PVT, auto-detected).
+       Static storage: nothing in the firmware touches the heap. */
+    gps_stream_t* gps = gps_stream_init(&gps_storage);
+    nmea_parser_t* parser = gps_stream_nmea(gps);
+    gps_stream_set_fix_callback(gps, on_fix, &tracker);
+    nmea_parser_set_epoch_policy(parser, NMEA_SENTENCE_GGA | NMEA_SENTENCE_RMC, GPS_EPOCH_TIMEOUT_MS);
+
+    /* 5. Initialize GPS filter (COLD_START), logging policy and track simplification */
+    static const gps_filter_policy_t log_policy = GPS_FILTER_POLICY_DEFAULT;
+    gps_filter_init(&tracker.filter);
+    gps_filter_set_policy(&tracker.filter, &log_policy);
+    gps_filter_set_trace(&tracker.filter, &tracker.filter_trace,
+                         GPS_FILTER_TRACE_MASK(FILTER_REJECT_OUTLIER) |
+                         GPS_FILTER_TRACE_MASK(FILTER_REJECT_NO_TIME_DELTA));
+    track_simplify_init(&tracker.simplify, TRACK_SIMPLIFY_TOLERANCE_M, on_simplified, &tracker);
 
     /* 6. Main loop */
-    char line_buf[NMEA_MAX_SENTENCE_LEN + 1];
+    uint8_t rx_buf[GPS_UART_CHUNK];
 
     while (1) {
 #ifdef HW_VALIDATION_TEST
         /* After first fix, run 30s write window then clean shutdown */
-        if (got_first_fix && (hal_time_ms() - write_window_start > HW_TEST_WRITE_WINDOW_MS)) {
+        if (tracker.got_first_fix &&
+            (hal_time_ms() - tracker.write_window_start > HW_TEST_WRITE_WINDOW_MS)) {
             printf("\n--- 30s write window complete ---\n");
-            printf("Fixes written: %lu\n", (unsigned long)fix_count);
-            data_storage_shutdown(&storage);
-            nmea_parser_destroy(parser);
+            printf("Fixes written: %lu\n", (unsigned long)tracker.fix_count);
+            nmea_parser_stats_t st;
+            if (nmea_parser_get_stats(parser, &st)) {
+                printf("NMEA: %lu epochs, dropped %lu long / %lu no-cs / %lu bad-cs / %lu short / %lu no-time\n",
+                       (unsigned long)st.epochs, (unsigned long)st.too_long,
+                       (unsigned long)st.no_checksum, (unsigned long)st.bad_checksum,
+                       (unsigned long)st.too_short, (unsigned long)st.bad_time);
+            }
+            data_storage_shutdown(&tracker.storage);
             printf("Storage shutdown OK — safe to unplug\n");
             while (1) { /* halt */ }
         }
@@ -73,48 +153,27 @@ int main(void) {
 
         /* Check power — FIRST thing each iteration */
         if (power_mgmt_is_shutdown_requested()) {
-            data_storage_shutdown(&storage);
-            nmea_parser_destroy(parser);
+            track_simplify_flush(&tracker.simplify);
+            gps_filter_dump(&tracker.filter, on_trailer_line, &tracker.storage);
+            data_storage_shutdown(&tracker.storage);
             while (1) { /* halt, wait for power to die */ }
         }
 
-        /* Read NMEA line from UART */
-        int len = hal_uart_read_line(line_buf, sizeof(line_buf), 1100);
-        if (len <= 0) continue;
-
-        /* Parse */
-        nmea_result_t result = nmea_parser_feed(parser, line_buf);
-        if (result != NMEA_RESULT_FIX_READY) continue;
-
-        /* Get completed fix */
-        gps_fix_t fix;
-        if (!nmea_parser_get_fix(parser, &fix)) continue;
-
-        /* Validity gate */
-        if (!(fix.flags & GPS_FIX_VALID) || !(fix.flags & GPS_HAS_LATLON)) continue;
-
-#ifdef HW_VALIDATION_TEST
-        /* Skip filter in validation mode (stationary device) */
-        if (!got_first_fix) {
-            got_first_fix = true;
-            write_window_start = hal_time_ms();
-            printf("*** FIRST FIX! lat=%.6f lon=%.6f sats=%d ***\n",
-                   fix.latitude, fix.longitude, fix.satellites);
-            printf("Starting 30s write window...\n");
-        }
-#else
-        /* Filter: reject stationary and outlier fixes */
-        if (gps_filter_process(&filter, &fix) != FILTER_ACCEPT) continue;
+        /* Read whatever the UART has; the parser handles partial sentences */
+        int len = hal_uart_read(rx_buf, sizeof(rx_buf), GPS_UART_TIMEOUT_MS);
+        uint32_t now = hal_time_ms();
+        nmea_parser_tick(parser, now);
+#ifndef HW_VALIDATION_TEST
+        /* Held-back fixes reach storage within a sync interval even when
+           no more come (parked, or the logging policy skipping fixes) */
+        track_simplify_poll(&tracker.simplify, now, STORAGE_SYNC_INTERVAL_S * 1000u);
 #endif
+        /* Buffered rows reach the card by the sync deadline without a new row */
+        data_storage_poll(&tracker.storage);
+        if (len <= 0) continue;
 
-        /* Store */
-        data_storage_write_fix(&storage, &fix);
-
-#ifdef HW_VALIDATION_TEST
-        fix_count++;
-        printf("FIX #%lu: %.6f,%.6f sats=%d\n",
-               (unsigned long)fix_count, fix.latitude, fix.longitude, fix.satellites);
-#endif
+        /* Parse — completed fixes go through on_fix() */
+        gps_stream_feed(gps, rx_buf, (size_t)len);
     }
 }
 
@@ -4,80 +4,178 @@
 #include <stdio.h>
 
 #define MAX_FIELDS 20
-#define MAX_FIELD_LEN 16
+
+/* KNOTS_TO_KMH as an exact integer ratio: knots * 10^3 -> km/h * 10^6 */
+#define KNOTS_E3_TO_KMH_E6 1852u
+
+/* Decode profile (NMEA_BUILD_SENTENCES / NMEA_BUILD_FIELDS), all usable in #if */
+#define BUILD_GGA (NMEA_BUILD_SENTENCES & NMEA_SENTENCE_GGA)
+#define BUILD_RMC (NMEA_BUILD_SENTENCES & NMEA_SENTENCE_RMC)
+#define BUILD_VTG (NMEA_BUILD_SENTENCES & NMEA_SENTENCE_VTG)
+#define BUILD_GLL (NMEA_BUILD_SENTENCES & NMEA_SENTENCE_GLL)
+#define BUILD_ZDA (NMEA_BUILD_SENTENCES & NMEA_SENTENCE_ZDA)
+#define DECODE(flags) (NMEA_BUILD_FIELDS & (flags))
+
+#if !(BUILD_GGA || BUILD_RMC || BUILD_GLL || BUILD_ZDA)
+#error "NMEA_BUILD_SENTENCES needs at least one sentence with a UTC time field"
+#endif
+
+/* Helpers needed by the selected profile */
+#define NEED_COORDINATE (DECODE(GPS_HAS_LATLON) && (BUILD_GGA || BUILD_RMC || BUILD_GLL))
+#define NEED_FIXED      (BUILD_GGA || (BUILD_ZDA && DECODE(GPS_HAS_DATE)) || NEED_COORDINATE || \
+                         ((BUILD_RMC || BUILD_VTG) && DECODE(GPS_HAS_SPEED | GPS_HAS_COURSE)))
+
+/* A field is an (offset, length) view into the caller's sentence buffer */
+typedef struct {
+    uint8_t off;
+    uint8_t len;
+} nmea_field_t;
+
+struct nmea_sentence {
+    const char* base;
+    nmea_field_t fields[MAX_FIELDS];
+    int count;
+};
+
+typedef struct {
+    uint32_t id;
+    nmea_sentence_handler_t fn;
+    void* user;
+} nmea_handler_t;
 
 struct nmea_parser {
     gps_fix_t current_fix;
     gps_fix_t completed_fix;
     bool has_completed_fix;
-    bool has_gga;
-    bool has_rmc;
+    uint32_t epoch_seen;        /* NMEA_SENTENCE_* bits parsed this epoch */
     uint8_t epoch_hour;
     uint8_t epoch_minute;
     uint8_t epoch_second;
     uint8_t epoch_centisecond;
     bool epoch_started;
+    bool epoch_published;       /* already emitted by the epoch policy */
+    uint32_t epoch_start_ms;
+
+    /* Epoch termination policy (nmea_parser_set_epoch_policy) */
+    uint32_t epoch_required;
+    uint32_t epoch_timeout_ms;
+    uint32_t now_ms;            /* clock from the latest nmea_parser_tick() */
+
+    /* Sentence selection and user handlers */
+    uint32_t enabled;
+    nmea_handler_t handlers[NMEA_MAX_HANDLERS];
+    uint8_t handler_count;
+
+    nmea_parser_stats_t stats;
+    nmea_cycle_counter_t cycle_fn;
+    civil_day_cache_t day_cache;
+
+    /* Fix sink for completed epochs (optional) */
+    nmea_fix_callback_t fix_cb;
+    void* fix_cb_user;
+
+    /* Byte-stream assembly state for nmea_parser_feed_bytes() */
+    char line[NMEA_MAX_SENTENCE_LEN];
+    uint8_t line_len;
+    uint8_t field_start;
+    uint8_t stream_state;
+    uint8_t stream_checksum;
+    int8_t checksum_hi;
+    nmea_sentence_t stream_tok;
 };
 
-/* ---- Helpers ---- */
+/* nmea_parser_feed_bytes() states */
+enum {
+    STREAM_IDLE = 0,    /* waiting for '$' */
+    STREAM_BODY,        /* between '$' and '*' */
+    STREAM_SKIP,        /* unwanted sentence type: wait for the next '$' */
+    STREAM_CHECKSUM_HI,
+    STREAM_CHECKSUM_LO
+};
 
-static bool validate_checksum(const char* sentence, size_t len) {
-    if (len < 4) return false;
-    if (sentence[0] != '$') return false;
+/* tokenize() and built-in parser outcomes, mapped onto stats counters */
+enum {
+    TOK_OK = 0,
+    TOK_NO_CHECKSUM,
+    TOK_BAD_CHECKSUM
+};
 
-    const char* star = NULL;
-    for (size_t i = len; i > 0; i--) {
-        if (sentence[i - 1] == '*') {
-            star = &sentence[i - 1];
-            break;
-        }
-    }
-    if (!star) return false;
-    if (star + 3 > sentence + len) return false;
+enum {
+    PARSE_OK = 0,
+    PARSE_TOO_SHORT,
+    PARSE_BAD_TIME
+};
 
-    uint8_t calc = 0;
-    for (const char* p = sentence + 1; p < star; p++) {
-        calc ^= (uint8_t)*p;
-    }
+/* ---- Helpers ---- */
 
-    char hex[3] = { star[1], star[2], '\0' };
-    unsigned long expected = strtoul(hex, NULL, 16);
-    return calc == (uint8_t)expected;
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
 }
 
-static int split_fields(const char* sentence, char fields[][MAX_FIELD_LEN], int max_fields) {
-    /* Skip '$' prefix, stop at '*' */
-    const char* start = sentence + 1;
-    const char* star = strchr(start, '*');
-    if (!star) return -1;
+/*
+ * Single pass over "$...*HH": records field views (between '$' and '*')
+ * and accumulates the XOR checksum as it goes. Nothing is copied.
+ */
+static int tokenize(const char* sentence, size_t len, nmea_sentence_t* tok) {
+    if (len < 4) return TOK_NO_CHECKSUM;
 
+    uint8_t calc = 0;
+    size_t field_start = 1;
     int count = 0;
-    const char* p = start;
-    while (p < star && count < max_fields) {
-        const char* comma = p;
-        while (comma < star && *comma != ',') comma++;
-        size_t flen = (size_t)(comma - p);
-        if (flen >= MAX_FIELD_LEN) flen = MAX_FIELD_LEN - 1;
-        memcpy(fields[count], p, flen);
-        fields[count][flen] = '\0';
+    size_t i = 1;
+    for (; i < len; i++) {
+        char c = sentence[i];
+        if (c == '*') break;
+        calc ^= (uint8_t)c;
+        if (c == ',') {
+            if (count < MAX_FIELDS) {
+                tok->fields[count].off = (uint8_t)field_start;
+                tok->fields[count].len = (uint8_t)(i - field_start);
+                count++;
+            }
+            field_start = i + 1;
+        }
+    }
+    if (i + 3 > len) return TOK_NO_CHECKSUM;  /* no '*' or fewer than two hex digits */
+
+    int hi = hex_value(sentence[i + 1]);
+    int lo = hex_value(sentence[i + 2]);
+    if (hi < 0 || lo < 0) return TOK_NO_CHECKSUM;
+    if (calc != (uint8_t)((hi << 4) | lo)) return TOK_BAD_CHECKSUM;
+
+    if (count < MAX_FIELDS) {
+        tok->fields[count].off = (uint8_t)field_start;
+        tok->fields[count].len = (uint8_t)(i - field_start);
         count++;
-        p = (comma < star) ? comma + 1 : star;
     }
-    return count;
+    tok->base = sentence;
+    tok->count = count;
+    return TOK_OK;
 }
 
-static bool parse_time(const char* field, uint8_t* hour, uint8_t* minute,
+static inline const char* field_ptr(const nmea_sentence_t* tok, int index) {
+    return tok->base + tok->fields[index].off;
+}
+
+static inline size_t field_len(const nmea_sentence_t* tok, int index) {
+    return tok->fields[index].len;
+}
+
+static bool parse_time(const char* field, size_t len, uint8_t* hour, uint8_t* minute,
                        uint8_t* second, uint8_t* centisecond) {
-    if (strlen(field) < 6) return false;
+    if (len < 6) return false;
     *hour = (uint8_t)((field[0] - '0') * 10 + (field[1] - '0'));
     *minute = (uint8_t)((field[2] - '0') * 10 + (field[3] - '0'));
     *second = (uint8_t)((field[4] - '0') * 10 + (field[5] - '0'));
     *centisecond = 0;
-    if (field[6] == '.' && field[7] != '\0') {
+    if (len > 7 && field[6] == '.') {
         int cs = 0;
         if (field[7] >= '0' && field[7] <= '9') {
             cs = (field[7] - '0') * 10;
-            if (field[8] >= '0' && field[8] <= '9') {
+            if (len > 8 && field[8] >= '0' && field[8] <= '9') {
                 cs += (field[8] - '0');
             }
         }
@@ -86,38 +184,101 @@ static bool parse_time(const char* field, uint8_t* hour, uint8_t* minute,
     return true;
 }
 
-static bool parse_date(const char* field, uint8_t* day, uint8_t* month, uint16_t* year) {
-    if (strlen(field) < 6) return false;
+#if BUILD_RMC && DECODE(GPS_HAS_DATE)
+static bool parse_date(const char* field, size_t len, uint8_t* day, uint8_t* month, uint16_t* year) {
+    if (len < 6) return false;
     *day   = (uint8_t)((field[0] - '0') * 10 + (field[1] - '0'));
     *month = (uint8_t)((field[2] - '0') * 10 + (field[3] - '0'));
     int yy = (field[4] - '0') * 10 + (field[5] - '0');
     *year  = (uint16_t)(2000 + yy);
     return true;
 }
+#endif
+
+#if NEED_FIXED
+/*
+ * Fixed-point decimal parser for NMEA numeric fields ("123", "12.345"):
+ * returns the value scaled by 10^decimals, rounding half up on excess
+ * fraction digits. No strtod, no locale, no floating point.
+ */
+static bool parse_fixed(const char* s, size_t len, unsigned decimals, uint32_t* out) {
+    uint32_t v = 0;
+    unsigned frac = 0;
+    bool seen_digit = false;
+    bool in_frac = false;
+    bool round_up = false;
+
+    for (size_t i = 0; i < len; i++) {
+        char c = s[i];
+        if (c == '.' && !in_frac) {
+            in_frac = true;
+            continue;
+        }
+        if (c < '0' || c > '9') return false;
+        seen_digit = true;
+        if (in_frac) {
+            if (frac == decimals) {
+                round_up = (c >= '5');
+                frac++;
+                continue;
+            }
+            if (frac > decimals) continue;
+            frac++;
+        }
+        uint32_t d = (uint32_t)(c - '0');
+        if (v > (UINT32_MAX - d) / 10u) return false;
+        v = v * 10u + d;
+    }
+    if (!seen_digit) return false;
 
-static bool parse_coordinate(const char* coord, const char* hemisphere, double* out) {
-    if (coord[0] == '\0' || hemisphere[0] == '\0') return false;
-
-    double raw = strtod(coord, NULL);
-    int degrees;
-    double minutes;
+    for (; frac < decimals; frac++) {
+        if (v > UINT32_MAX / 10u) return false;
+        v *= 10u;
+    }
+    if (round_up) {
+        if (v == UINT32_MAX) return false;
+        v++;
+    }
+    *out = v;
+    return true;
+}
+#endif
 
-    if (hemisphere[0] == 'N' || hemisphere[0] == 'S') {
-        /* Latitude: DDmm.mmmm */
-        degrees = (int)(raw / 100.0);
-        minutes = raw - degrees * 100.0;
-    } else {
-        /* Longitude: DDDmm.mmmm */
-        degrees = (int)(raw / 100.0);
-        minutes = raw - degrees * 100.0;
+#if BUILD_GGA && DECODE(GPS_HAS_ALTITUDE)
+static bool parse_fixed_signed(const char* s, size_t len, unsigned decimals, int32_t* out) {
+    bool neg = (len > 0 && s[0] == '-');
+    if (neg) {
+        s++;
+        len--;
     }
+    uint32_t mag;
+    if (!parse_fixed(s, len, decimals, &mag) || mag > (uint32_t)INT32_MAX) return false;
+    *out = neg ? -(int32_t)mag : (int32_t)mag;
+    return true;
+}
+#endif
+
+#if NEED_COORDINATE
+/* DDmm.mmmmm / DDDmm.mmmmm to integer micro-degrees, then to the fix's double */
+static bool parse_coordinate(const char* coord, size_t coord_len,
+                             const char* hemisphere, size_t hemi_len, double* out) {
+    if (coord_len == 0 || hemi_len == 0) return false;
+
+    uint32_t raw_e5;
+    if (!parse_fixed(coord, coord_len, 5, &raw_e5)) return false;
+
+    uint32_t degrees = raw_e5 / 10000000u;
+    uint32_t minutes_e5 = raw_e5 % 10000000u;
+    /* minutes * 10^5 / 60 * 10^6 == minutes_e5 / 6; +3 rounds to nearest */
+    int32_t udeg = (int32_t)(degrees * 1000000u + (minutes_e5 + 3u) / 6u);
 
-    *out = degrees + minutes / 60.0;
     if (hemisphere[0] == 'S' || hemisphere[0] == 'W') {
-        *out = -(*out);
+        udeg = -udeg;
     }
+    *out = (double)udeg / 1e6;
     return true;
 }
+#endif
 
 static bool times_match(uint8_t h1, uint8_t m1, uint8_t s1, uint8_t cs1,
                         uint8_t h2, uint8_t m2, uint8_t s2, uint8_t cs2) {
@@ -126,16 +287,40 @@ static bool times_match(uint8_t h1, uint8_t m1, uint8_t s1, uint8_t cs1,
 
 /* ---- Epoch management ---- */
 
+uint64_t gps_fix_unix_ms(const gps_fix_t* fix, civil_day_cache_t* cache) {
+    if (!fix || !(fix->flags & GPS_HAS_TIME)) return 0;
+    uint64_t ms = ((fix->hour * 60u + fix->minute) * 60u + fix->second) * 1000u +
+                  fix->centisecond * 10u;
+    if ((fix->flags & GPS_HAS_DATE) && fix->year >= 1970) {
+        ms += (uint64_t)civil_day_cache_days(cache, fix->year, fix->month, fix->day) * MS_PER_DAY;
+    }
+    return ms;
+}
+
+static void publish_epoch(nmea_parser_t* parser) {
+    parser->completed_fix = parser->current_fix;
+    parser->completed_fix.unix_ms = gps_fix_unix_ms(&parser->current_fix, &parser->day_cache);
+    parser->has_completed_fix = true;
+    parser->epoch_published = true;
+    parser->stats.epochs++;
+}
+
+/* Everything the epoch policy waits for has arrived, not yet emitted */
+static bool epoch_complete(const nmea_parser_t* parser) {
+    return parser->epoch_required && parser->epoch_started && !parser->epoch_published &&
+           (parser->epoch_seen & parser->epoch_required) == parser->epoch_required;
+}
+
 static void start_new_epoch(nmea_parser_t* parser, uint8_t h, uint8_t m,
                             uint8_t s, uint8_t cs) {
-    /* If we had a previous epoch, emit it */
-    if (parser->epoch_started) {
-        parser->completed_fix = parser->current_fix;
-        parser->has_completed_fix = true;
+    /* If we had a previous epoch that the policy has not emitted yet, emit it */
+    if (parser->epoch_started && !parser->epoch_published) {
+        publish_epoch(parser);
     }
     memset(&parser->current_fix, 0, sizeof(gps_fix_t));
-    parser->has_gga = false;
-    parser->has_rmc = false;
+    parser->epoch_seen = 0;
+    parser->epoch_published = false;
+    parser->epoch_start_ms = parser->now_ms;
     parser->epoch_hour = h;
     parser->epoch_minute = m;
     parser->epoch_second = s;
@@ -143,13 +328,12 @@ static void start_new_epoch(nmea_parser_t* parser, uint8_t h, uint8_t m,
     parser->epoch_started = true;
 }
 
-/* ---- GGA parsing ---- */
-
-static void parse_gga(nmea_parser_t* parser, char fields[][MAX_FIELD_LEN], int nfields) {
-    if (nfields < 10) return;
-
+/* Moves to the epoch of the sentence's time field; false if it has none */
+static bool enter_epoch(nmea_parser_t* parser, const nmea_sentence_t* tok, int time_field) {
     uint8_t h, m, s, cs;
-    if (!parse_time(fields[1], &h, &m, &s, &cs)) return;
+    if (!parse_time(field_ptr(tok, time_field), field_len(tok, time_field), &h, &m, &s, &cs)) {
+        return false;
+    }
 
     if (!parser->epoch_started ||
         !times_match(parser->epoch_hour, parser->epoch_minute,
@@ -163,37 +347,57 @@ static void parse_gga(nmea_parser_t* parser, char fields[][MAX_FIELD_LEN], int n
     fix->second = s;
     fix->centisecond = cs;
     fix->flags |= GPS_HAS_TIME;
+    return true;
+}
+
+/* ---- GGA parsing ---- */
+
+#if BUILD_GGA
+static int parse_gga(nmea_parser_t* parser, const nmea_sentence_t* tok) {
+    if (tok->count < 10) return PARSE_TOO_SHORT;
+    if (!enter_epoch(parser, tok, 1)) return PARSE_BAD_TIME;
+
+    gps_fix_t* fix = &parser->current_fix;
 
     /* Fix quality */
-    if (fields[6][0] != '\0') {
-        fix->fix_quality = (uint8_t)(fields[6][0] - '0');
+    if (field_len(tok, 6) > 0) {
+        fix->fix_quality = (uint8_t)(field_ptr(tok, 6)[0] - '0');
     }
 
     /* Satellites */
-    if (fields[7][0] != '\0') {
-        fix->satellites = (uint8_t)atoi(fields[7]);
+    uint32_t sats;
+    if (parse_fixed(field_ptr(tok, 7), field_len(tok, 7), 0, &sats) && sats <= UINT8_MAX) {
+        fix->satellites = (uint8_t)sats;
     }
 
+#if DECODE(GPS_HAS_HDOP)
     /* HDOP */
-    if (fields[8][0] != '\0') {
-        fix->hdop = (float)strtod(fields[8], NULL);
+    uint32_t hdop_e2;
+    if (parse_fixed(field_ptr(tok, 8), field_len(tok, 8), 2, &hdop_e2)) {
+        fix->hdop = (float)hdop_e2 / 100.0f;
         fix->flags |= GPS_HAS_HDOP;
     }
+#endif
 
+#if DECODE(GPS_HAS_ALTITUDE)
     /* Altitude */
-    if (fields[9][0] != '\0') {
-        fix->altitude_m = (float)strtod(fields[9], NULL);
+    int32_t alt_cm;
+    if (parse_fixed_signed(field_ptr(tok, 9), field_len(tok, 9), 2, &alt_cm)) {
+        fix->altitude_m = (float)alt_cm / 100.0f;
         fix->flags |= GPS_HAS_ALTITUDE;
     }
+#endif
 
+#if DECODE(GPS_HAS_LATLON)
     /* Lat/Lon */
     double lat, lon;
-    if (parse_coordinate(fields[2], fields[3], &lat) &&
-        parse_coordinate(fields[4], fields[5], &lon)) {
+    if (parse_coordinate(field_ptr(tok, 2), field_len(tok, 2), field_ptr(tok, 3), field_len(tok, 3), &lat) &&
+        parse_coordinate(field_ptr(tok, 4), field_len(tok, 4), field_ptr(tok, 5), field_len(tok, 5), &lon)) {
         fix->latitude = lat;
         fix->longitude = lon;
         fix->flags |= GPS_HAS_LATLON;
     }
+#endif
 
     /* Set valid if fix quality >= 1 */
     if (fix->fix_quality >= 1) {
@@ -202,93 +406,421 @@ static void parse_gga(nmea_parser_t* parser, char fields[][MAX_FIELD_LEN], int n
         fix->flags &= ~GPS_FIX_VALID;
     }
 
-    parser->has_gga = true;
+    parser->epoch_seen |= NMEA_SENTENCE_GGA;
+    return PARSE_OK;
 }
+#endif
 
 /* ---- RMC parsing ---- */
 
-static void parse_rmc(nmea_parser_t* parser, char fields[][MAX_FIELD_LEN], int nfields) {
-    if (nfields < 10) return;
-
-    uint8_t h, m, s, cs;
-    if (!parse_time(fields[1], &h, &m, &s, &cs)) return;
-
-    if (!parser->epoch_started ||
-        !times_match(parser->epoch_hour, parser->epoch_minute,
-                     parser->epoch_second, parser->epoch_centisecond, h, m, s, cs)) {
-        start_new_epoch(parser, h, m, s, cs);
-    }
+#if BUILD_RMC
+static int parse_rmc(nmea_parser_t* parser, const nmea_sentence_t* tok) {
+    if (tok->count < 10) return PARSE_TOO_SHORT;
+    if (!enter_epoch(parser, tok, 1)) return PARSE_BAD_TIME;
 
     gps_fix_t* fix = &parser->current_fix;
-    fix->hour = h;
-    fix->minute = m;
-    fix->second = s;
-    fix->centisecond = cs;
-    fix->flags |= GPS_HAS_TIME;
 
     /* Status: A=valid, V=void */
-    bool active = (fields[2][0] == 'A');
+    bool active = (field_len(tok, 2) > 0 && field_ptr(tok, 2)[0] == 'A');
     if (!active) {
         fix->flags &= ~GPS_FIX_VALID;
     }
 
+#if DECODE(GPS_HAS_LATLON)
     /* Lat/Lon (RMC fields 3-6) */
-    if (!parser->has_gga) {
+    if (!(parser->epoch_seen & NMEA_SENTENCE_GGA)) {
         double lat, lon;
-        if (parse_coordinate(fields[3], fields[4], &lat) &&
-            parse_coordinate(fields[5], fields[6], &lon)) {
+        if (parse_coordinate(field_ptr(tok, 3), field_len(tok, 3), field_ptr(tok, 4), field_len(tok, 4), &lat) &&
+            parse_coordinate(field_ptr(tok, 5), field_len(tok, 5), field_ptr(tok, 6), field_len(tok, 6), &lon)) {
             fix->latitude = lat;
             fix->longitude = lon;
             fix->flags |= GPS_HAS_LATLON;
         }
     }
+#endif
 
+#if DECODE(GPS_HAS_SPEED)
     /* Speed */
-    if (fields[7][0] != '\0') {
-        double knots = strtod(fields[7], NULL);
-        fix->speed_kmh = (float)(knots * KNOTS_TO_KMH);
+    uint32_t knots_e3;
+    if (parse_fixed(field_ptr(tok, 7), field_len(tok, 7), 3, &knots_e3) &&
+        knots_e3 <= UINT32_MAX / KNOTS_E3_TO_KMH_E6) {
+        fix->speed_kmh = (float)(knots_e3 * KNOTS_E3_TO_KMH_E6) / 1e6f;
         fix->flags |= GPS_HAS_SPEED;
     }
+#endif
 
+#if DECODE(GPS_HAS_COURSE)
     /* Course */
-    if (fields[8][0] != '\0') {
-        fix->course_deg = (float)strtod(fields[8], NULL);
+    uint32_t course_e2;
+    if (parse_fixed(field_ptr(tok, 8), field_len(tok, 8), 2, &course_e2)) {
+        fix->course_deg = (float)course_e2 / 100.0f;
         fix->flags |= GPS_HAS_COURSE;
     }
+#endif
 
+#if DECODE(GPS_HAS_DATE)
     /* Date (field 9) */
-    if (nfields > 9 && fields[9][0] != '\0') {
+    if (field_len(tok, 9) > 0) {
         uint8_t day, month;
         uint16_t year;
-        if (parse_date(fields[9], &day, &month, &year)) {
+        if (parse_date(field_ptr(tok, 9), field_len(tok, 9), &day, &month, &year)) {
             fix->day = day;
             fix->month = month;
             fix->year = year;
             fix->flags |= GPS_HAS_DATE;
         }
     }
+#endif
 
     /* Validity: need both GGA fix_quality >= 1 AND RMC status 'A' */
-    if (active && parser->has_gga && fix->fix_quality >= 1) {
+    if (active && (parser->epoch_seen & NMEA_SENTENCE_GGA) && fix->fix_quality >= 1) {
         fix->flags |= GPS_FIX_VALID;
     } else if (!active) {
         fix->flags &= ~GPS_FIX_VALID;
     }
 
-    parser->has_rmc = true;
+    parser->epoch_seen |= NMEA_SENTENCE_RMC;
+    return PARSE_OK;
+}
+#endif
+
+/* ---- VTG / GLL / ZDA parsing ---- */
+
+#if BUILD_VTG
+/* VTG carries no time: it is merged into the epoch in progress, and only
+   fills speed/course that RMC has not already provided. */
+static int parse_vtg(nmea_parser_t* parser, const nmea_sentence_t* tok) {
+    if (tok->count < 9) return PARSE_TOO_SHORT;
+    if (!parser->epoch_started) return PARSE_BAD_TIME;
+
+#if DECODE(GPS_HAS_COURSE | GPS_HAS_SPEED)
+    gps_fix_t* fix = &parser->current_fix;
+#endif
+#if DECODE(GPS_HAS_COURSE)
+    uint32_t course_e2;
+    if (!(fix->flags & GPS_HAS_COURSE) &&
+        parse_fixed(field_ptr(tok, 1), field_len(tok, 1), 2, &course_e2)) {
+        fix->course_deg = (float)course_e2 / 100.0f;
+        fix->flags |= GPS_HAS_COURSE;
+    }
+#endif
+#if DECODE(GPS_HAS_SPEED)
+    uint32_t kmh_e3;
+    if (!(fix->flags & GPS_HAS_SPEED) &&
+        parse_fixed(field_ptr(tok, 7), field_len(tok, 7), 3, &kmh_e3)) {
+        fix->speed_kmh = (float)kmh_e3 / 1000.0f;
+        fix->flags |= GPS_HAS_SPEED;
+    }
+#endif
+    parser->epoch_seen |= NMEA_SENTENCE_VTG;
+    return PARSE_OK;
+}
+#endif
+
+#if BUILD_GLL
+static int parse_gll(nmea_parser_t* parser, const nmea_sentence_t* tok) {
+    if (tok->count < 7) return PARSE_TOO_SHORT;
+    if (!enter_epoch(parser, tok, 5)) return PARSE_BAD_TIME;
+
+#if DECODE(GPS_HAS_LATLON)
+    /* Position only when active and not already taken from GGA/RMC */
+    gps_fix_t* fix = &parser->current_fix;
+    bool active = (field_len(tok, 6) > 0 && field_ptr(tok, 6)[0] == 'A');
+    if (active && !(fix->flags & GPS_HAS_LATLON)) {
+        double lat, lon;
+        if (parse_coordinate(field_ptr(tok, 1), field_len(tok, 1), field_ptr(tok, 2), field_len(tok, 2), &lat) &&
+            parse_coordinate(field_ptr(tok, 3), field_len(tok, 3), field_ptr(tok, 4), field_len(tok, 4), &lon)) {
+            fix->latitude = lat;
+            fix->longitude = lon;
+            fix->flags |= GPS_HAS_LATLON;
+        }
+    }
+#endif
+    parser->epoch_seen |= NMEA_SENTENCE_GLL;
+    return PARSE_OK;
+}
+#endif
+
+#if BUILD_ZDA
+static int parse_zda(nmea_parser_t* parser, const nmea_sentence_t* tok) {
+    if (tok->count < 5) return PARSE_TOO_SHORT;
+    if (!enter_epoch(parser, tok, 1)) return PARSE_BAD_TIME;
+
+#if DECODE(GPS_HAS_DATE)
+    uint32_t day, month, year;
+    if (parse_fixed(field_ptr(tok, 2), field_len(tok, 2), 0, &day) &&
+        parse_fixed(field_ptr(tok, 3), field_len(tok, 3), 0, &month) &&
+        parse_fixed(field_ptr(tok, 4), field_len(tok, 4), 0, &year) &&
+        day >= 1 && day <= 31 && month >= 1 && month <= 12 && year <= UINT16_MAX) {
+        gps_fix_t* fix = &parser->current_fix;
+        fix->day = (uint8_t)day;
+        fix->month = (uint8_t)month;
+        fix->year = (uint16_t)year;
+        fix->flags |= GPS_HAS_DATE;
+    }
+#endif
+    parser->epoch_seen |= NMEA_SENTENCE_ZDA;
+    return PARSE_OK;
+}
+#endif
+
+/* ---- Dispatch table ---- */
+
+typedef int (*builtin_parse_t)(nmea_parser_t* parser, const nmea_sentence_t* tok);
+
+#if BUILD_GGA
+#define GGA_PARSER parse_gga
+#else
+#define GGA_PARSER NULL
+#endif
+#if BUILD_RMC
+#define RMC_PARSER parse_rmc
+#else
+#define RMC_PARSER NULL
+#endif
+#if BUILD_VTG
+#define VTG_PARSER parse_vtg
+#else
+#define VTG_PARSER NULL
+#endif
+#if BUILD_GLL
+#define GLL_PARSER parse_gll
+#else
+#define GLL_PARSER NULL
+#endif
+#if BUILD_ZDA
+#define ZDA_PARSER parse_zda
+#else
+#define ZDA_PARSER NULL
+#endif
+
+/* Indexed by NMEA_SENTENCE_* bit position; NULL outside the build profile */
+static const builtin_parse_t builtin_parsers[] = {
+    GGA_PARSER,
+    RMC_PARSER,
+    NULL,       /* GSA: handler only */
+    NULL,       /* GSV: handler only */
+    VTG_PARSER,
+    GLL_PARSER,
+    ZDA_PARSER,
+};
+
+static int builtin_slot(uint32_t id) {
+    switch (id) {
+    case NMEA_ID_GGA: return 0;
+    case NMEA_ID_RMC: return 1;
+    case NMEA_ID_GSA: return 2;
+    case NMEA_ID_GSV: return 3;
+    case NMEA_ID_VTG: return 4;
+    case NMEA_ID_GLL: return 5;
+    case NMEA_ID_ZDA: return 6;
+    default:          return -1;
+    }
+}
+
+/* Sentence ID from "$ttXXX" */
+static inline uint32_t sentence_id_of(const char* sentence) {
+    return NMEA_SENTENCE_ID(sentence[3], sentence[4], sentence[5]);
+}
+
+static bool sentence_wanted(const nmea_parser_t* parser, uint32_t id) {
+    int slot = builtin_slot(id);
+    if (slot >= 0 && (parser->enabled & (1u << slot))) return true;
+    for (int i = 0; i < parser->handler_count; i++) {
+        if (parser->handlers[i].id == id) return true;
+    }
+    return false;
 }
 
 /* ---- Public API ---- */
 
-nmea_parser_t* nmea_parser_create(void) {
-    nmea_parser_t* p = calloc(1, sizeof(nmea_parser_t));
+_Static_assert(sizeof(struct nmea_parser) <= sizeof(nmea_parser_storage_t),
+               "NMEA_PARSER_STORAGE_SIZE too small");
+
+nmea_parser_t* nmea_parser_init(nmea_parser_storage_t* storage) {
+    if (!storage) return NULL;
+    nmea_parser_t* p = (nmea_parser_t*)storage;
+    memset(p, 0, sizeof(*p));
+    p->enabled = NMEA_SENTENCE_DEFAULT & NMEA_BUILD_SENTENCES;
     return p;
 }
 
+nmea_parser_t* nmea_parser_create(void) {
+    nmea_parser_storage_t* storage = malloc(sizeof(nmea_parser_storage_t));
+    return nmea_parser_init(storage);
+}
+
 void nmea_parser_destroy(nmea_parser_t* parser) {
     free(parser);
 }
 
+void nmea_parser_set_fix_callback(nmea_parser_t* parser, nmea_fix_callback_t cb, void* user) {
+    if (!parser) return;
+    parser->fix_cb = cb;
+    parser->fix_cb_user = user;
+}
+
+void nmea_parser_set_epoch_policy(nmea_parser_t* parser, uint32_t required_mask,
+                                  uint32_t timeout_ms) {
+    if (!parser) return;
+    parser->epoch_required = required_mask;
+    parser->epoch_timeout_ms = timeout_ms;
+}
+
+nmea_result_t nmea_parser_tick(nmea_parser_t* parser, uint32_t now_ms) {
+    if (!parser) return NMEA_RESULT_ERROR;
+    parser->now_ms = now_ms;
+
+    /* Completed by a sentence that had to emit the epoch before it */
+    if (epoch_complete(parser)) {
+        publish_epoch(parser);
+        parser->stats.epochs_early++;
+        if (parser->fix_cb) {
+            parser->fix_cb(&parser->completed_fix, parser->fix_cb_user);
+        }
+        return NMEA_RESULT_FIX_READY;
+    }
+
+    if (parser->epoch_timeout_ms == 0 || !parser->epoch_started || parser->epoch_published) {
+        return NMEA_RESULT_NONE;
+    }
+    if (now_ms - parser->epoch_start_ms < parser->epoch_timeout_ms) return NMEA_RESULT_NONE;
+
+    /* Receiver skipped part of the epoch: flush what we have */
+    publish_epoch(parser);
+    parser->stats.epochs_timeout++;
+    if (parser->fix_cb) {
+        parser->fix_cb(&parser->completed_fix, parser->fix_cb_user);
+    }
+    return NMEA_RESULT_FIX_READY;
+}
+
+void nmea_parser_enable_sentences(nmea_parser_t* parser, uint32_t mask) {
+    if (!parser) return;
+    parser->enabled = mask & NMEA_BUILD_SENTENCES;
+}
+
+bool nmea_parser_register_handler(nmea_parser_t* parser, uint32_t sentence_id,
+                                  nmea_sentence_handler_t fn, void* user) {
+    if (!parser || !fn || parser->handler_count >= NMEA_MAX_HANDLERS) return false;
+    nmea_handler_t* h = &parser->handlers[parser->handler_count++];
+    h->id = sentence_id;
+    h->fn = fn;
+    h->user = user;
+    return true;
+}
+
+bool nmea_parser_get_stats(const nmea_parser_t* parser, nmea_parser_stats_t* out) {
+    if (!parser || !out) return false;
+    *out = parser->stats;
+    return true;
+}
+
+void nmea_parser_reset_stats(nmea_parser_t* parser) {
+    if (!parser) return;
+    memset(&parser->stats, 0, sizeof(parser->stats));
+}
+
+void nmea_parser_set_cycle_counter(nmea_parser_t* parser, nmea_cycle_counter_t fn) {
+    if (!parser) return;
+    parser->cycle_fn = fn;
+}
+
+uint32_t nmea_sentence_id(const nmea_sentence_t* sentence) {
+    return sentence_id_of(sentence->base);
+}
+
+int nmea_sentence_field_count(const nmea_sentence_t* sentence) {
+    return sentence->count;
+}
+
+const char* nmea_sentence_field(const nmea_sentence_t* sentence, int index, size_t* len) {
+    if (index < 0 || index >= sentence->count) {
+        if (len) *len = 0;
+        return NULL;
+    }
+    if (len) *len = field_len(sentence, index);
+    return field_ptr(sentence, index);
+}
+
+/* Dispatch a checksummed, tokenized sentence of body length len */
+static nmea_result_t process_sentence(nmea_parser_t* parser, const nmea_sentence_t* tok, size_t len) {
+    if (len < 6) {
+        parser->stats.too_short++;
+        return NMEA_RESULT_ERROR;
+    }
+    uint32_t id = sentence_id_of(tok->base);
+    uint32_t t0 = parser->cycle_fn ? parser->cycle_fn() : 0;
+
+    /* Reset completed fix flag before processing */
+    parser->has_completed_fix = false;
+
+    int slot = builtin_slot(id);
+    int type = (slot >= 0) ? slot : NMEA_STATS_OTHER;
+    parser->stats.sentences[type]++;
+    if (slot >= 0 && (parser->enabled & (1u << slot)) && builtin_parsers[slot]) {
+        int outcome = builtin_parsers[slot](parser, tok);
+        if (outcome == PARSE_TOO_SHORT) parser->stats.too_short++;
+        else if (outcome == PARSE_BAD_TIME) parser->stats.bad_time++;
+    }
+    for (int i = 0; i < parser->handler_count; i++) {
+        if (parser->handlers[i].id == id) {
+            parser->handlers[i].fn(tok, parser->handlers[i].user);
+        }
+    }
+
+    /* Early completion. If the time change already emitted the previous
+       epoch, this one waits for the next sentence or tick rather than
+       overwrite completed_fix before it is read. */
+    if (!parser->has_completed_fix && epoch_complete(parser)) {
+        publish_epoch(parser);
+        parser->stats.epochs_early++;
+    }
+
+    if (parser->cycle_fn) {
+        parser->stats.cycles[type] += (uint32_t)(parser->cycle_fn() - t0);
+    }
+
+    if (parser->has_completed_fix) {
+        if (parser->fix_cb) {
+            parser->fix_cb(&parser->completed_fix, parser->fix_cb_user);
+        }
+        return NMEA_RESULT_FIX_READY;
+    }
+    return NMEA_RESULT_NONE;
+}
+
+/*
+ * Checks and tokenizes one line without CR/LF. On false the drop reason has
+ * been counted and *rejected holds the result for nmea_parser_feed():
+ * NONE for unwanted types, ERROR otherwise.
+ */
+static bool accept_line(nmea_parser_t* parser, const char* line, size_t len,
+                        nmea_sentence_t* tok, nmea_result_t* rejected) {
+    *rejected = NMEA_RESULT_ERROR;
+    if (len == 0 || line[0] != '$') {
+        parser->stats.not_nmea++;
+        return false;
+    }
+    if (len > NMEA_MAX_SENTENCE_LEN) {
+        parser->stats.too_long++;
+        return false;
+    }
+
+    /* Unwanted types are dropped on their ID alone */
+    if (len >= 6 && !sentence_wanted(parser, sentence_id_of(line))) {
+        parser->stats.unwanted++;
+        *rejected = NMEA_RESULT_NONE;
+        return false;
+    }
+
+    /* Checksum and field views in one pass, directly on the caller's buffer */
+    int status = tokenize(line, len, tok);
+    if (status == TOK_BAD_CHECKSUM) parser->stats.bad_checksum++;
+    else if (status == TOK_NO_CHECKSUM) parser->stats.no_checksum++;
+    return status == TOK_OK;
+}
+
 nmea_result_t nmea_parser_feed(nmea_parser_t* parser, const char* sentence) {
     if (!parser || !sentence) return NMEA_RESULT_ERROR;
 
@@ -297,41 +829,132 @@ nmea_result_t nmea_parser_feed(nmea_parser_t* parser, const char* sentence) {
     while (len > 0 && (sentence[len - 1] == '\r' || sentence[len - 1] == '\n')) {
         len--;
     }
-    if (len == 0) return NMEA_RESULT_ERROR;
-    if (sentence[0] != '$') return NMEA_RESULT_ERROR;
 
-    /* Work with a mutable copy */
-    char buf[NMEA_MAX_SENTENCE_LEN + 1];
-    if (len > NMEA_MAX_SENTENCE_LEN) len = NMEA_MAX_SENTENCE_LEN;
-    memcpy(buf, sentence, len);
-    buf[len] = '\0';
+    nmea_sentence_t tok;
+    nmea_result_t rejected;
+    if (!accept_line(parser, sentence, len, &tok, &rejected)) return rejected;
 
-    if (!validate_checksum(buf, len)) return NMEA_RESULT_ERROR;
+    return process_sentence(parser, &tok, len);
+}
 
-    /* Determine sentence type from positions 3-5 after '$' */
-    if (len < 6) return NMEA_RESULT_ERROR;
-    char type[4] = { buf[3], buf[4], buf[5], '\0' };
+static void stream_push_field(nmea_parser_t* parser) {
+    nmea_sentence_t* tok = &parser->stream_tok;
+    if (tok->count < MAX_FIELDS) {
+        tok->fields[tok->count].off = parser->field_start;
+        tok->fields[tok->count].len = (uint8_t)(parser->line_len - parser->field_start);
+        tok->count++;
+    }
+    parser->field_start = (uint8_t)(parser->line_len + 1);
+}
 
-    char fields[MAX_FIELDS][MAX_FIELD_LEN];
-    memset(fields, 0, sizeof(fields));
-    int nfields = split_fields(buf, fields, MAX_FIELDS);
-    if (nfields < 0) return NMEA_RESULT_ERROR;
+int nmea_parser_feed_bytes(nmea_parser_t* parser, const uint8_t* buf, size_t len) {
+    if (!parser || (!buf && len > 0)) return -1;
 
-    /* Reset completed fix flag before processing */
-    parser->has_completed_fix = false;
+    int fixes = 0;
+    for (size_t i = 0; i < len; i++) {
+        char c = (char)buf[i];
 
-    if (strcmp(type, "GGA") == 0) {
-        parse_gga(parser, fields, nfields);
-    } else if (strcmp(type, "RMC") == 0) {
-        parse_rmc(parser, fields, nfields);
-    } else {
-        return NMEA_RESULT_NONE;
+        /* '$' always (re)starts a sentence, so a dropped byte costs one sentence */
+        if (c == '$') {
+            if (parser->stream_state != STREAM_IDLE && parser->stream_state != STREAM_SKIP) {
+                parser->stats.no_checksum++;
+            }
+            parser->line[0] = '$';
+            parser->line_len = 1;
+            parser->field_start = 1;
+            parser->stream_checksum = 0;
+            parser->stream_tok.count = 0;
+            parser->stream_state = STREAM_BODY;
+            continue;
+        }
+
+        switch (parser->stream_state) {
+        case STREAM_IDLE:
+        case STREAM_SKIP:
+            break;
+
+        case STREAM_BODY:
+            if (c == '*') {
+                stream_push_field(parser);
+                parser->stream_state = STREAM_CHECKSUM_HI;
+            } else if (c == '\r' || c == '\n') {
+                parser->stats.no_checksum++;
+                parser->stream_state = STREAM_IDLE;
+            } else if (parser->line_len + 3 >= NMEA_MAX_SENTENCE_LEN) {
+                /* No room left for "*HH" */
+                parser->stats.too_long++;
+                parser->stream_state = STREAM_IDLE;
+            } else {
+                parser->stream_checksum ^= (uint8_t)c;
+                if (c == ',') stream_push_field(parser);
+                parser->line[parser->line_len++] = c;
+                if (parser->line_len == 6 && !sentence_wanted(parser, sentence_id_of(parser->line))) {
+                    parser->stats.unwanted++;
+                    parser->stream_state = STREAM_SKIP;
+                }
+            }
+            break;
+
+        case STREAM_CHECKSUM_HI:
+            parser->checksum_hi = (int8_t)hex_value(c);
+            if (parser->checksum_hi < 0) {
+                parser->stats.no_checksum++;
+                parser->stream_state = STREAM_IDLE;
+            } else {
+                parser->stream_state = STREAM_CHECKSUM_LO;
+            }
+            break;
+
+        case STREAM_CHECKSUM_LO: {
+            int lo = hex_value(c);
+            parser->stream_state = STREAM_IDLE;
+            if (lo < 0) {
+                parser->stats.no_checksum++;
+                break;
+            }
+            if (parser->stream_checksum != (uint8_t)((parser->checksum_hi << 4) | lo)) {
+                parser->stats.bad_checksum++;
+                break;
+            }
+
+            parser->stream_tok.base = parser->line;
+            if (process_sentence(parser, &parser->stream_tok, parser->line_len) == NMEA_RESULT_FIX_READY) {
+                fixes++;
+            }
+            break;
+        }
+        }
     }
+    return fixes;
+}
 
-    if (parser->has_completed_fix) {
-        return NMEA_RESULT_FIX_READY;
+size_t nmea_parser_parse_buffer(nmea_parser_t* parser, const char* buf, size_t len,
+                                gps_fix_t* out, size_t cap, size_t* consumed) {
+    size_t pos = 0;
+    size_t nfix = 0;
+
+    if (parser && buf && out) {
+        while (pos < len && nfix < cap) {
+            const char* line = buf + pos;
+            const char* nl = memchr(line, '\n', len - pos);
+            if (!nl) break; /* partial last line: leave it for the next call */
+
+            size_t line_len = (size_t)(nl - line);
+            pos += line_len + 1;
+            if (line_len > 0 && line[line_len - 1] == '\r') line_len--;
+
+            nmea_sentence_t tok;
+            nmea_result_t rejected;
+            if (!accept_line(parser, line, line_len, &tok, &rejected)) continue;
+            if (process_sentence(parser, &tok, line_len) == NMEA_RESULT_FIX_READY) {
+                out[nfix++] = parser->completed_fix;
+                parser->has_completed_fix = false;
+            }
+        }
     }
-    return NMEA_RESULT_NONE;
+
+    if (consumed) *consumed = pos;
+    return nfix;
 }
 
 bool nmea_parser_get_fix(nmea_parser_t* parser, gps_fix_t* out_fix) {
@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include "time_utils.h"
 
 #define NMEA_MAX_SENTENCE_LEN 82
 #define KNOTS_TO_KMH          1.852
@@ -22,6 +24,7 @@ typedef struct {
     uint8_t hour, minute, second, centisecond;
     uint8_t day, month;
     uint16_t year;
+    uint64_t unix_ms;       /* gps_fix_unix_ms() of the above, set by the parsers */
 
     double latitude;
     double longitude;
@@ -33,17 +36,180 @@ typedef struct {
     float hdop;
 } gps_fix_t;
 
+/* Milliseconds since 1970-01-01 UTC; time of day only without GPS_HAS_DATE
+   (or before 1970), 0 without GPS_HAS_TIME. cache may be NULL. */
+uint64_t gps_fix_unix_ms(const gps_fix_t* fix, civil_day_cache_t* cache);
+
 typedef struct nmea_parser nmea_parser_t;
 
+/* Caller-owned parser memory for nmea_parser_init(); covers the parser on
+   32- and 64-bit targets (checked at compile time) */
+#define NMEA_PARSER_STORAGE_SIZE 640
+
+typedef union {
+    uint8_t bytes[NMEA_PARSER_STORAGE_SIZE];
+    uint64_t align_u64;
+    void* align_ptr;
+} nmea_parser_storage_t;
+
+/* Sentence type packed from the three characters after the talker ID */
+#define NMEA_SENTENCE_ID(a, b, c) \
+    (((uint32_t)(uint8_t)(a) << 16) | ((uint32_t)(uint8_t)(b) << 8) | (uint32_t)(uint8_t)(c))
+
+#define NMEA_ID_GGA NMEA_SENTENCE_ID('G', 'G', 'A')
+#define NMEA_ID_RMC NMEA_SENTENCE_ID('R', 'M', 'C')
+#define NMEA_ID_GSA NMEA_SENTENCE_ID('G', 'S', 'A')
+#define NMEA_ID_GSV NMEA_SENTENCE_ID('G', 'S', 'V')
+#define NMEA_ID_VTG NMEA_SENTENCE_ID('V', 'T', 'G')
+#define NMEA_ID_GLL NMEA_SENTENCE_ID('G', 'L', 'L')
+#define NMEA_ID_ZDA NMEA_SENTENCE_ID('Z', 'D', 'A')
+
+/* Built-in sentence types for nmea_parser_enable_sentences(). GSA and GSV
+   have no gps_fix_t fields; enabling them only matters with a handler. */
+#define NMEA_SENTENCE_GGA (1u << 0)
+#define NMEA_SENTENCE_RMC (1u << 1)
+#define NMEA_SENTENCE_GSA (1u << 2)
+#define NMEA_SENTENCE_GSV (1u << 3)
+#define NMEA_SENTENCE_VTG (1u << 4)
+#define NMEA_SENTENCE_GLL (1u << 5)
+#define NMEA_SENTENCE_ZDA (1u << 6)
+#define NMEA_SENTENCE_DEFAULT (NMEA_SENTENCE_GGA | NMEA_SENTENCE_RMC)
+#define NMEA_SENTENCE_ALL     0x7Fu
+
+/* Compile-time decode profile. NMEA_BUILD_SENTENCES selects the built-in
+   sentence parsers compiled in and NMEA_BUILD_FIELDS the GPS_HAS_* fields
+   they decode; everything else is removed by the preprocessor. Time,
+   validity, fix quality and satellites are always decoded. Pick a profile
+   with NMEA_PROFILE (CMake: GPS_PARSER_PROFILE) or define both masks. */
+#define NMEA_PROFILE_FULL     0   /* GGA RMC VTG GLL ZDA, all fields */
+#define NMEA_PROFILE_TRACK    1   /* GGA RMC, all fields */
+#define NMEA_PROFILE_POSITION 2   /* GGA RMC, time, date, lat/lon, speed */
+
+#ifndef NMEA_PROFILE
+#define NMEA_PROFILE NMEA_PROFILE_FULL
+#endif
+
+#define GPS_HAS_ALL (GPS_HAS_TIME | GPS_HAS_DATE | GPS_HAS_LATLON | GPS_HAS_ALTITUDE | \
+                     GPS_HAS_SPEED | GPS_HAS_COURSE | GPS_HAS_HDOP)
+
+#if NMEA_PROFILE == NMEA_PROFILE_TRACK
+#define NMEA_PROFILE_SENTENCES NMEA_SENTENCE_DEFAULT
+#define NMEA_PROFILE_FIELDS    GPS_HAS_ALL
+#elif NMEA_PROFILE == NMEA_PROFILE_POSITION
+/* Speed stays: gps_filter treats a fix without it as stationary */
+#define NMEA_PROFILE_SENTENCES NMEA_SENTENCE_DEFAULT
+#define NMEA_PROFILE_FIELDS    (GPS_HAS_TIME | GPS_HAS_DATE | GPS_HAS_LATLON | GPS_HAS_SPEED)
+#else
+#define NMEA_PROFILE_SENTENCES NMEA_SENTENCE_ALL
+#define NMEA_PROFILE_FIELDS    GPS_HAS_ALL
+#endif
+
+#ifndef NMEA_BUILD_SENTENCES
+#define NMEA_BUILD_SENTENCES NMEA_PROFILE_SENTENCES
+#endif
+#ifndef NMEA_BUILD_FIELDS
+#define NMEA_BUILD_FIELDS NMEA_PROFILE_FIELDS
+#endif
+
+#define NMEA_MAX_HANDLERS 4
+
+/* Checksummed sentence passed to registered handlers; valid only during the call */
+typedef struct nmea_sentence nmea_sentence_t;
+typedef void (*nmea_sentence_handler_t)(const nmea_sentence_t* sentence, void* user);
+
 typedef enum {
     NMEA_RESULT_NONE      =  0,
     NMEA_RESULT_FIX_READY =  1,
     NMEA_RESULT_ERROR     = -1
 } nmea_result_t;
 
+/* Per-type stats slots: NMEA_SENTENCE_* bit positions, then one shared by
+   handler-only types */
+#define NMEA_STATS_TYPES 8
+#define NMEA_STATS_OTHER (NMEA_STATS_TYPES - 1)
+
+/* Running counters; all wrap. A line is either dropped under one of the
+   first five reasons or dispatched and counted in sentences[]; too_short and
+   bad_time count dispatched sentences the built-in parser could not use.
+   feed_bytes() skips non-'$' bytes without counting them as not_nmea. */
+typedef struct {
+    uint32_t not_nmea;          /* empty or not starting with '$' */
+    uint32_t too_long;          /* longer than NMEA_MAX_SENTENCE_LEN */
+    uint32_t no_checksum;       /* no '*HH', or cut off by the next '$' */
+    uint32_t bad_checksum;
+    uint32_t unwanted;          /* type neither enabled nor handled */
+    uint32_t too_short;         /* fewer fields than the built-in parser needs */
+    uint32_t bad_time;          /* UTC field unusable, or VTG before any epoch */
+
+    uint32_t sentences[NMEA_STATS_TYPES];
+
+    uint32_t epochs;            /* fixes emitted, by any rule */
+    uint32_t epochs_early;      /* emitted when the required set completed */
+    uint32_t epochs_timeout;    /* flushed by nmea_parser_tick() */
+
+    uint64_t cycles[NMEA_STATS_TYPES];  /* only with a cycle counter set */
+} nmea_parser_stats_t;
+
+/* Free-running counter for per-type cost accounting (e.g. DWT->CYCCNT) */
+typedef uint32_t (*nmea_cycle_counter_t)(void);
+
+/* Called for every completed epoch, from whichever feed function completed it */
+typedef void (*nmea_fix_callback_t)(const gps_fix_t* fix, void* user);
+
 nmea_parser_t* nmea_parser_create(void);
 void           nmea_parser_destroy(nmea_parser_t* parser);
+/* Heap-free alternative to create: resets storage and returns it as a
+   parser. Never pass the result to nmea_parser_destroy(). */
+nmea_parser_t* nmea_parser_init(nmea_parser_storage_t* storage);
 nmea_result_t  nmea_parser_feed(nmea_parser_t* parser, const char* sentence);
 bool           nmea_parser_get_fix(nmea_parser_t* parser, gps_fix_t* out_fix);
 
+/* Raw byte stream input: chunks may split sentences anywhere. Returns the
+   number of fixes completed (and passed to the fix callback), -1 on bad args. */
+int            nmea_parser_feed_bytes(nmea_parser_t* parser, const uint8_t* buf, size_t len);
+void           nmea_parser_set_fix_callback(nmea_parser_t* parser, nmea_fix_callback_t cb, void* user);
+
+/* Sentence selection. Types that are neither enabled nor have a handler are
+   dropped on their ID, before checksum and field splitting. Built-in types
+   outside NMEA_BUILD_SENTENCES cannot be enabled. */
+void           nmea_parser_enable_sentences(nmea_parser_t* parser, uint32_t mask);
+/* Runs fn for every valid sentence of sentence_id (NMEA_ID_* or
+   NMEA_SENTENCE_ID()), after any built-in parsing. False when full. */
+bool           nmea_parser_register_handler(nmea_parser_t* parser, uint32_t sentence_id,
+                                            nmea_sentence_handler_t fn, void* user);
+
+/* Handler-side accessors. Field 0 is the address field ("GPGSV"); fields are
+   not NUL-terminated. Out-of-range fields return NULL with *len = 0. */
+uint32_t       nmea_sentence_id(const nmea_sentence_t* sentence);
+int            nmea_sentence_field_count(const nmea_sentence_t* sentence);
+const char*    nmea_sentence_field(const nmea_sentence_t* sentence, int index, size_t* len);
+
+/* Epoch termination. By default (required_mask 0) an epoch is emitted when
+   a sentence with a different time arrives, one epoch late. With a required
+   set of NMEA_SENTENCE_* bits it is emitted as soon as all of them have been
+   parsed; a time change still emits an incomplete epoch. A sentence emits
+   at most one epoch: when its time change emitted the previous one, its
+   own completed epoch follows on the next sentence or tick. timeout_ms > 0
+   flushes an incomplete epoch that many ms after its first sentence, as
+   seen by nmea_parser_tick(). */
+void           nmea_parser_set_epoch_policy(nmea_parser_t* parser, uint32_t required_mask,
+                                            uint32_t timeout_ms);
+/* Advance the parser clock; call from the main loop even when no bytes
+   arrived. Returns FIX_READY (and calls the fix callback) on a timeout flush
+   or for a completed epoch held back as above. */
+nmea_result_t  nmea_parser_tick(nmea_parser_t* parser, uint32_t now_ms);
+
+/* Statistics. Counting is always on; the cycle counter (NULL to disable)
+   brackets built-in parsing and handlers of each dispatched sentence. */
+bool           nmea_parser_get_stats(const nmea_parser_t* parser, nmea_parser_stats_t* out);
+void           nmea_parser_reset_stats(nmea_parser_t* parser);
+void           nmea_parser_set_cycle_counter(nmea_parser_t* parser, nmea_cycle_counter_t fn);
+
+/* Bulk input for host-side reprocessing of captures: parses complete
+   '\n'-terminated lines from buf, writing up to cap fixes to out. Stops after
+   the sentence that fills out or at a trailing partial line; *consumed is set
+   to the number of bytes processed so the caller can resume from there. */
+size_t         nmea_parser_parse_buffer(nmea_parser_t* parser, const char* buf, size_t len,
+                                        gps_fix_t* out, size_t cap, size_t* consumed);
+
 #endif
@@ -0,0 +1,316 @@
+#include "track_bin.h"
+#include <string.h>
+
+#define TIME_MASK   0xFFFFFFu       /* time_cs is 24 bits; deltas wrap there */
+#define ALT_MIN     (-(1L << 23))
+#define ALT_MAX     ((1L << 23) - 1)
+
+static const uint8_t end_record[TRACK_BIN_END_SIZE] = {TRACK_BIN_TAG_END, 'E', 'N', 'D'};
+
+static uint8_t* put_uvarint(uint8_t* p, uint32_t v) {
+    while (v >= 0x80u) {
+        *p++ = (uint8_t)(v | 0x80u);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+static uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1u);
+}
+
+/* Differences and sums wrap around, so any pair of fields encodes */
+static int32_t diff(int32_t a, int32_t b) {
+    return (int32_t)((uint32_t)a - (uint32_t)b);
+}
+
+static int32_t add(int32_t a, int32_t b) {
+    return (int32_t)((uint32_t)a + (uint32_t)b);
+}
+
+/* CRC-8, polynomial 0x07 */
+static uint8_t crc8(const uint8_t* p, size_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+        crc ^= *p++;
+        for (int k = 0; k < 8; k++) {
+            crc = (uint8_t)((crc & 0x80u) ? ((unsigned)crc << 1) ^ 0x07u : (unsigned)crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t track_bin_write_header(uint8_t* out) {
+    memcpy(out, TRACK_BIN_MAGIC, 4);
+    out[4] = TRACK_BIN_VERSION;
+    out[5] = TRACK_BIN_KEYFRAME_INTERVAL;
+    return TRACK_BIN_HEADER_SIZE;
+}
+
+void track_bin_encoder_init(track_bin_encoder_t* enc) {
+    if (!enc) return;
+    memset(enc, 0, sizeof(*enc));
+}
+
+static size_t encode_keyframe(const gps_fix_packed_t* fix, uint8_t* out) {
+    uint8_t* p = out;
+    *p++ = TRACK_BIN_TAG_KEYFRAME;
+    *p++ = (uint8_t)fix->flags;
+    p = put_uvarint(p, fix->date);
+    p = put_uvarint(p, fix->time_cs);
+    p = put_uvarint(p, zigzag(fix->lat_e6));
+    p = put_uvarint(p, zigzag(fix->lon_e6));
+    p = put_uvarint(p, zigzag(fix->altitude_dm));
+    p = put_uvarint(p, fix->speed_ckmh);
+    p = put_uvarint(p, fix->course_ddeg);
+    p = put_uvarint(p, fix->hdop_c);
+    p = put_uvarint(p, fix->satellites | (uint32_t)fix->fix_quality << 8);
+    *p = crc8(out, (size_t)(p - out));
+    return (size_t)(p + 1 - out);
+}
+
+size_t track_bin_encode_fix(track_bin_encoder_t* enc, const gps_fix_packed_t* fix, uint8_t* out) {
+    if (!enc || !fix || !out) return 0;
+    const gps_fix_packed_t* prev = &enc->prev;
+    size_t n;
+
+    if (enc->since_key == 0 || enc->since_key >= TRACK_BIN_KEYFRAME_INTERVAL) {
+        n = encode_keyframe(fix, out);
+        enc->since_key = 1;
+    } else {
+        uint8_t tag = 0;
+        if (fix->altitude_dm != prev->altitude_dm) tag |= TRACK_BIN_DELTA_ALTITUDE;
+        if (fix->speed_ckmh != prev->speed_ckmh) tag |= TRACK_BIN_DELTA_SPEED;
+        if (fix->course_ddeg != prev->course_ddeg) tag |= TRACK_BIN_DELTA_COURSE;
+        if (fix->hdop_c != prev->hdop_c) tag |= TRACK_BIN_DELTA_HDOP;
+        if (fix->satellites != prev->satellites || fix->fix_quality != prev->fix_quality) {
+            tag |= TRACK_BIN_DELTA_SATELLITES;
+        }
+        if (fix->flags != prev->flags) tag |= TRACK_BIN_DELTA_FLAGS;
+        if (fix->date != prev->date) tag |= TRACK_BIN_DELTA_DATE;
+
+        uint8_t* p = out;
+        *p++ = tag;
+        p = put_uvarint(p, ((uint32_t)fix->time_cs - prev->time_cs) & TIME_MASK);
+        p = put_uvarint(p, zigzag(diff(fix->lat_e6, prev->lat_e6)));
+        p = put_uvarint(p, zigzag(diff(fix->lon_e6, prev->lon_e6)));
+        if (tag & TRACK_BIN_DELTA_ALTITUDE) {
+            p = put_uvarint(p, zigzag(fix->altitude_dm - prev->altitude_dm));
+        }
+        if (tag & TRACK_BIN_DELTA_SPEED) {
+            p = put_uvarint(p, zigzag((int32_t)fix->speed_ckmh - prev->speed_ckmh));
+        }
+        if (tag & TRACK_BIN_DELTA_COURSE) {
+            p = put_uvarint(p, zigzag((int32_t)fix->course_ddeg - prev->course_ddeg));
+        }
+        if (tag & TRACK_BIN_DELTA_HDOP) {
+            p = put_uvarint(p, zigzag((int32_t)fix->hdop_c - prev->hdop_c));
+        }
+        if (tag & TRACK_BIN_DELTA_SATELLITES) {
+            p = put_uvarint(p, fix->satellites | (uint32_t)fix->fix_quality << 8);
+        }
+        if (tag & TRACK_BIN_DELTA_FLAGS) *p++ = (uint8_t)fix->flags;
+        if (tag & TRACK_BIN_DELTA_DATE) {
+            p = put_uvarint(p, zigzag((int32_t)fix->date - prev->date));
+        }
+        n = (size_t)(p - out);
+        enc->since_key++;
+    }
+    enc->prev = *fix;
+    return n;
+}
+
+size_t track_bin_encode_comment(const char* text, size_t len, uint8_t* out) {
+    if (!text || !out) return 0;
+    if (len > TRACK_BIN_COMMENT_MAX) len = TRACK_BIN_COMMENT_MAX;
+    out[0] = TRACK_BIN_TAG_COMMENT;
+    out[1] = (uint8_t)len;
+    memcpy(out + 2, text, len);
+    return len + 2;
+}
+
+size_t track_bin_encode_end(track_bin_encoder_t* enc, uint8_t* out) {
+    if (!enc || !out) return 0;
+    enc->since_key = 0;
+    memcpy(out, end_record, TRACK_BIN_END_SIZE);
+    return TRACK_BIN_END_SIZE;
+}
+
+bool track_bin_is_end(const uint8_t* buf, size_t len) {
+    return buf && len == TRACK_BIN_END_SIZE && memcmp(buf, end_record, TRACK_BIN_END_SIZE) == 0;
+}
+
+bool track_bin_decoder_init(track_bin_decoder_t* dec, const uint8_t* buf, size_t len) {
+    if (!dec) return false;
+    memset(dec, 0, sizeof(*dec));
+    dec->synced = true;
+    if (!buf || len < TRACK_BIN_HEADER_SIZE) return false;
+    if (memcmp(buf, TRACK_BIN_MAGIC, 4) != 0 || buf[4] != TRACK_BIN_VERSION) return false;
+    if (buf[5] == 0) return false;
+    dec->interval = buf[5];
+    return true;
+}
+
+typedef struct {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool incomplete;
+    bool bad;
+} reader_t;
+
+static uint32_t get_uvarint(reader_t* r) {
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (r->p == r->end) {
+            r->incomplete = true;
+            return 0;
+        }
+        uint8_t b = *r->p++;
+        v |= (uint32_t)(b & 0x7Fu) << shift;
+        if (!(b & 0x80u)) {
+            if (shift == 28 && b > 0x0Fu) r->bad = true;
+            return v;
+        }
+    }
+    r->bad = true;
+    return 0;
+}
+
+static uint8_t get_byte(reader_t* r) {
+    if (r->p == r->end) {
+        r->incomplete = true;
+        return 0;
+    }
+    return *r->p++;
+}
+
+/* Field values are checked against gps_fix_packed_t's widths before they
+   are stored, so out-of-range ones flag damage instead of truncating */
+typedef struct {
+    uint32_t flags, date, time_cs, speed, course, hdop, sats;
+    int32_t lat, lon, alt;
+} fields_t;
+
+static bool fields_fit(const fields_t* f) {
+    return f->flags <= 0xFFu && f->date <= 0xFFFFu && f->time_cs <= TIME_MASK &&
+           f->alt >= ALT_MIN && f->alt <= ALT_MAX && f->speed <= 0xFFFFu &&
+           f->course <= 0xFFFu && f->hdop <= 0xFFFFu && f->sats <= 0xFFFu;
+}
+
+static void store_fields(const fields_t* f, gps_fix_packed_t* fix) {
+    memset(fix, 0, sizeof(*fix));
+    fix->lat_e6 = f->lat;
+    fix->lon_e6 = f->lon;
+    fix->altitude_dm = f->alt;
+    fix->flags = f->flags;
+    fix->time_cs = f->time_cs;
+    fix->satellites = f->sats & 0xFFu;
+    fix->date = (uint16_t)f->date;
+    fix->speed_ckmh = (uint16_t)f->speed;
+    fix->hdop_c = (uint16_t)f->hdop;
+    fix->course_ddeg = (uint16_t)f->course;
+    fix->fix_quality = (uint16_t)(f->sats >> 8);
+}
+
+static void load_fields(const gps_fix_packed_t* fix, fields_t* f) {
+    f->flags = fix->flags;
+    f->date = fix->date;
+    f->time_cs = fix->time_cs;
+    f->lat = fix->lat_e6;
+    f->lon = fix->lon_e6;
+    f->alt = fix->altitude_dm;
+    f->speed = fix->speed_ckmh;
+    f->course = fix->course_ddeg;
+    f->hdop = fix->hdop_c;
+    f->sats = fix->satellites | (uint32_t)fix->fix_quality << 8;
+}
+
+static void read_keyframe(reader_t* r, fields_t* f) {
+    f->flags = get_byte(r);
+    f->date = get_uvarint(r);
+    f->time_cs = get_uvarint(r);
+    f->lat = unzigzag(get_uvarint(r));
+    f->lon = unzigzag(get_uvarint(r));
+    f->alt = unzigzag(get_uvarint(r));
+    f->speed = get_uvarint(r);
+    f->course = get_uvarint(r);
+    f->hdop = get_uvarint(r);
+    f->sats = get_uvarint(r);
+}
+
+static void read_delta(reader_t* r, uint8_t tag, fields_t* f) {
+    f->time_cs = (f->time_cs + get_uvarint(r)) & TIME_MASK;
+    f->lat = add(f->lat, unzigzag(get_uvarint(r)));
+    f->lon = add(f->lon, unzigzag(get_uvarint(r)));
+    if (tag & TRACK_BIN_DELTA_ALTITUDE) f->alt = add(f->alt, unzigzag(get_uvarint(r)));
+    if (tag & TRACK_BIN_DELTA_SPEED) f->speed += (uint32_t)unzigzag(get_uvarint(r));
+    if (tag & TRACK_BIN_DELTA_COURSE) f->course += (uint32_t)unzigzag(get_uvarint(r));
+    if (tag & TRACK_BIN_DELTA_HDOP) f->hdop += (uint32_t)unzigzag(get_uvarint(r));
+    if (tag & TRACK_BIN_DELTA_SATELLITES) f->sats = get_uvarint(r);
+    if (tag & TRACK_BIN_DELTA_FLAGS) f->flags = get_byte(r);
+    if (tag & TRACK_BIN_DELTA_DATE) f->date += (uint32_t)unzigzag(get_uvarint(r));
+}
+
+static track_bin_status_t skip(track_bin_decoder_t* dec, size_t* used) {
+    dec->synced = false;
+    dec->since_key = 0;
+    dec->skipped++;
+    *used = 1;
+    return TRACK_BIN_SKIPPED;
+}
+
+track_bin_status_t track_bin_decode(track_bin_decoder_t* dec, const uint8_t* buf, size_t len,
+                                    size_t* used) {
+    *used = 0;
+    if (!dec || !buf || len == 0) return TRACK_BIN_NEED_MORE;
+    reader_t r = {buf + 1, buf + len, false, false};
+    uint8_t tag = buf[0];
+    fields_t f;
+
+    if (tag == TRACK_BIN_TAG_KEYFRAME) {
+        read_keyframe(&r, &f);
+        uint8_t crc = get_byte(&r);
+        if (r.incomplete) return TRACK_BIN_NEED_MORE;
+        if (r.bad || crc != crc8(buf, (size_t)(r.p - 1 - buf)) || !fields_fit(&f)) {
+            return skip(dec, used);
+        }
+        store_fields(&f, &dec->fix);
+        dec->synced = true;
+        dec->since_key = 1;
+        *used = (size_t)(r.p - buf);
+        return TRACK_BIN_FIX;
+    }
+    if (!dec->synced) return skip(dec, used);
+
+    if (tag < TRACK_BIN_TAG_KEYFRAME) {
+        if (dec->since_key == 0 || dec->since_key >= dec->interval) return skip(dec, used);
+        load_fields(&dec->fix, &f);
+        read_delta(&r, tag, &f);
+        if (r.incomplete) return TRACK_BIN_NEED_MORE;
+        if (r.bad || !fields_fit(&f)) return skip(dec, used);
+        store_fields(&f, &dec->fix);
+        dec->since_key++;
+        *used = (size_t)(r.p - buf);
+        return TRACK_BIN_FIX;
+    }
+    if (tag == TRACK_BIN_TAG_COMMENT) {
+        if (len < 2 || len < 2u + buf[1]) return TRACK_BIN_NEED_MORE;
+        dec->text = (const char*)buf + 2;
+        dec->text_len = buf[1];
+        *used = 2u + buf[1];
+        return TRACK_BIN_COMMENT;
+    }
+    if (tag == TRACK_BIN_TAG_END) {
+        if (len < TRACK_BIN_END_SIZE) return TRACK_BIN_NEED_MORE;
+        if (!track_bin_is_end(buf, TRACK_BIN_END_SIZE)) return skip(dec, used);
+        dec->since_key = 0;
+        *used = TRACK_BIN_END_SIZE;
+        return TRACK_BIN_END;
+    }
+    return skip(dec, used);
+}
@@ -0,0 +1,80 @@
+#ifndef TRACK_BIN_H
+#define TRACK_BIN_H
+
+#include "gps_fix_packed.h"
+#include <stddef.h>
+
+/* Binary track records (specs/data-storage.md, Binary Format): a header,
+   then per fix the differences from the previous gps_fix_packed_t as
+   varints, with an absolute, checksummed keyframe at least every
+   TRACK_BIN_KEYFRAME_INTERVAL fixes. Unpacking a decoded fix and
+   formatting it gives the CSV row data_storage writes for it. */
+
+#define TRACK_BIN_MAGIC              "GTRK"
+#define TRACK_BIN_VERSION            1
+#define TRACK_BIN_HEADER_SIZE        6      /* magic, version, keyframe interval */
+#define TRACK_BIN_KEYFRAME_INTERVAL  64
+#define TRACK_BIN_COMMENT_MAX        255
+#define TRACK_BIN_RECORD_MAX         (2 + TRACK_BIN_COMMENT_MAX)
+
+/* Record tags. Below 0x80 the tag is a delta record and its bits say which
+   fields besides time, latitude and longitude changed. */
+#define TRACK_BIN_DELTA_ALTITUDE     0x01
+#define TRACK_BIN_DELTA_SPEED        0x02
+#define TRACK_BIN_DELTA_COURSE       0x04
+#define TRACK_BIN_DELTA_HDOP         0x08
+#define TRACK_BIN_DELTA_SATELLITES   0x10   /* satellites and fix quality */
+#define TRACK_BIN_DELTA_FLAGS        0x20
+#define TRACK_BIN_DELTA_DATE         0x40
+#define TRACK_BIN_TAG_KEYFRAME       0x80
+#define TRACK_BIN_TAG_COMMENT        0x81
+#define TRACK_BIN_TAG_END            0x82   /* clean end of a session */
+/* The end record is the tag and then "END". Checking all of it tells a
+   clean end from a keyframe whose CRC byte happens to equal the tag. */
+#define TRACK_BIN_END_SIZE           4
+
+typedef struct {
+    gps_fix_packed_t prev;
+    uint8_t since_key;          /* fixes since the keyframe, 0: none yet */
+} track_bin_encoder_t;
+
+/* The encoders write at most TRACK_BIN_RECORD_MAX bytes and return the
+   count. After init or an end record the next fix is a keyframe. */
+size_t track_bin_write_header(uint8_t* out);
+void   track_bin_encoder_init(track_bin_encoder_t* enc);
+size_t track_bin_encode_fix(track_bin_encoder_t* enc, const gps_fix_packed_t* fix, uint8_t* out);
+/* len is cut at TRACK_BIN_COMMENT_MAX */
+size_t track_bin_encode_comment(const char* text, size_t len, uint8_t* out);
+size_t track_bin_encode_end(track_bin_encoder_t* enc, uint8_t* out);
+/* buf[0..len) is exactly one end record */
+bool   track_bin_is_end(const uint8_t* buf, size_t len);
+
+typedef enum {
+    TRACK_BIN_NEED_MORE = 0,    /* incomplete record: append bytes and retry */
+    TRACK_BIN_FIX,
+    TRACK_BIN_COMMENT,
+    TRACK_BIN_END,
+    TRACK_BIN_SKIPPED           /* a byte that starts no valid record */
+} track_bin_status_t;
+
+typedef struct {
+    uint8_t interval;           /* from the header */
+    bool synced;                /* false after damage until a valid keyframe */
+    uint8_t since_key;
+    gps_fix_packed_t fix;       /* last decoded fix */
+    const char* text;           /* TRACK_BIN_COMMENT: into the caller's buffer */
+    size_t text_len;
+    uint32_t skipped;           /* bytes dropped resyncing */
+} track_bin_decoder_t;
+
+/* Checks the header in buf[0..TRACK_BIN_HEADER_SIZE) and resets dec */
+bool track_bin_decoder_init(track_bin_decoder_t* dec, const uint8_t* buf, size_t len);
+/* Decodes the record at the start of buf[0..len) and sets *used to its
+   size: 0 for TRACK_BIN_NEED_MORE, 1 for TRACK_BIN_SKIPPED. Damage shows
+   up as an invalid record or, at the latest, as a missing keyframe where
+   one is due; decoding then resumes at the next keyframe whose checksum
+   matches. */
+track_bin_status_t track_bin_decode(track_bin_decoder_t* dec, const uint8_t* buf, size_t len,
+                                    size_t* used);
+
+#endif
@@ -0,0 +1,79 @@
+#include "track_simplify.h"
+#include "geo_utils.h"
+#include <string.h>
+
+void track_simplify_init(track_simplify_t* ts, float tolerance_m,
+                         track_simplify_emit_fn emit, void* user) {
+    if (!ts) return;
+    memset(ts, 0, sizeof(*ts));
+    ts->tolerance_m = tolerance_m;
+    ts->emit = emit;
+    ts->user = user;
+}
+
+static void set_anchor(track_simplify_t* ts, const gps_fix_packed_t* fix) {
+    ts->anchor = *fix;
+    ts->has_anchor = true;
+    ts->m_per_e6_lon = geo_m_per_e6_lon_f(fix->lat_e6);
+    ts->emit(fix, ts->user);
+}
+
+static void project(const track_simplify_t* ts, const gps_fix_packed_t* fix, float* x, float* y) {
+    geo_e6_delta_m(ts->anchor.lat_e6, ts->anchor.lon_e6, ts->m_per_e6_lon,
+                   fix->lat_e6, fix->lon_e6, x, y);
+}
+
+/* Squared distance from (px, py) to the segment from the origin to (ex, ey) */
+static float seg_dist2(float px, float py, float ex, float ey) {
+    float len2 = ex * ex + ey * ey;
+    float t = len2 > 0.0f ? (px * ex + py * ey) / len2 : 0.0f;
+    if (t < 0.0f) t = 0.0f;
+    if (t > 1.0f) t = 1.0f;
+    float dx = px - t * ex, dy = py - t * ey;
+    return dx * dx + dy * dy;
+}
+
+static bool window_fits(const track_simplify_t* ts, float ex, float ey) {
+    float tol2 = ts->tolerance_m * ts->tolerance_m;
+    for (uint8_t i = 0; i < ts->count; i++) {
+        if (seg_dist2(ts->x[i], ts->y[i], ex, ey) > tol2) return false;
+    }
+    return true;
+}
+
+void track_simplify_push(track_simplify_t* ts, const gps_fix_packed_t* fix) {
+    if (!ts || !fix || !ts->emit) return;
+    if (!ts->has_anchor || ts->tolerance_m <= 0.0f) {
+        set_anchor(ts, fix);
+        return;
+    }
+
+    float x, y;
+    project(ts, fix, &x, &y);
+    if (ts->count > 0 && (ts->count == TRACK_SIMPLIFY_WINDOW || !window_fits(ts, x, y))) {
+        track_simplify_flush(ts);
+        project(ts, fix, &x, &y);
+    }
+    ts->window[ts->count] = *fix;
+    ts->x[ts->count] = x;
+    ts->y[ts->count] = y;
+    ts->count++;
+}
+
+void track_simplify_flush(track_simplify_t* ts) {
+    if (!ts || ts->count == 0) return;
+    gps_fix_packed_t end = ts->window[ts->count - 1];
+    ts->count = 0;
+    ts->held_timed = false;
+    set_anchor(ts, &end);
+}
+
+void track_simplify_poll(track_simplify_t* ts, uint32_t now_ms, uint32_t max_hold_ms) {
+    if (!ts || ts->count == 0) return;
+    if (!ts->held_timed) {
+        ts->held_timed = true;
+        ts->held_since_ms = now_ms;
+    } else if (now_ms - ts->held_since_ms >= max_hold_ms) {
+        track_simplify_flush(ts);
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef TRACK_SIMPLIFY_H
+#define TRACK_SIMPLIFY_H
+
+#include "gps_fix_packed.h"
+
+/* Streaming track simplification between the filter and storage: an
+   opening-window algorithm. Fixes are held back while every one of them
+   lies within the cross-track tolerance of the segment from the last
+   emitted fix (the anchor) to the newest. When a fix breaks that, the one
+   before it is emitted and becomes the anchor. Every dropped fix is
+   therefore within the tolerance of the segment between the emitted fixes
+   around it. At most TRACK_SIMPLIFY_WINDOW fixes are held back, which
+   bounds memory, and track_simplify_poll() bounds how long by the clock. */
+
+#define TRACK_SIMPLIFY_TOLERANCE_M  5.0f
+#define TRACK_SIMPLIFY_WINDOW       32
+
+typedef void (*track_simplify_emit_fn)(const gps_fix_packed_t* fix, void* user);
+
+typedef struct {
+    float tolerance_m;          /* <= 0: pass every fix straight through */
+    track_simplify_emit_fn emit;
+    void* user;
+    bool has_anchor;
+    gps_fix_packed_t anchor;
+    float m_per_e6_lon;         /* at the anchor */
+    uint8_t count;
+    bool held_timed;            /* held_since_ms is set for the held fixes */
+    uint32_t held_since_ms;     /* first poll that saw them */
+    gps_fix_packed_t window[TRACK_SIMPLIFY_WINDOW];
+    float x[TRACK_SIMPLIFY_WINDOW];     /* metres east of the anchor */
+    float y[TRACK_SIMPLIFY_WINDOW];     /* metres north of the anchor */
+} track_simplify_t;
+
+void track_simplify_init(track_simplify_t* ts, float tolerance_m,
+                         track_simplify_emit_fn emit, void* user);
+void track_simplify_push(track_simplify_t* ts, const gps_fix_packed_t* fix);
+/* Emit the newest held-back fix (stop point, shutdown). Fixes before it are
+   covered by the segment to it. */
+void track_simplify_flush(track_simplify_t* ts);
+/* Flushes once fixes have been held max_hold_ms, timed from the first poll
+   that saw them. Call from the main loop: when the input stops (parked,
+   the logging policy skipping fixes) nothing else releases them. */
+void track_simplify_poll(track_simplify_t* ts, uint32_t now_ms, uint32_t max_hold_ms);
+
+#endif
@@ -0,0 +1,326 @@
+#include "ubx_parser.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Largest payload we keep; longer messages are checksummed and skipped */
+#define UBX_MAX_PAYLOAD UBX_NAV_PVT_LEN
+
+/* Longer than any NEO-8M message: a length above this is a false sync */
+#define UBX_MAX_FRAME_PAYLOAD 1024
+
+/* NAV-PVT fixType / flags */
+#define PVT_FIX_NONE      0
+#define PVT_FIX_DR_ONLY   1
+#define PVT_FIX_2D        2
+#define PVT_FIX_3D        3
+#define PVT_FIX_GNSS_DR   4
+#define PVT_VALID_DATE    0x01
+#define PVT_VALID_TIME    0x02
+#define PVT_GNSS_FIX_OK   0x01
+#define PVT_DIFF_SOLN     0x02
+
+enum {
+    UBX_SYNC1 = 0,      /* waiting for 0xB5 */
+    UBX_SYNC2,
+    UBX_CLASS,
+    UBX_ID,
+    UBX_LEN_LO,
+    UBX_LEN_HI,
+    UBX_PAYLOAD,
+    UBX_CK_A,
+    UBX_CK_B
+};
+
+struct ubx_parser {
+    gps_fix_t completed_fix;
+    bool has_completed_fix;
+    civil_day_cache_t day_cache;
+
+    nmea_fix_callback_t fix_cb;
+    void* fix_cb_user;
+
+    uint8_t state;
+    uint8_t msg_class;
+    uint8_t msg_id;
+    uint8_t ck_a, ck_b;
+    uint16_t len;
+    uint16_t pos;
+    uint8_t payload[UBX_MAX_PAYLOAD];
+};
+
+/* ---- Little-endian field access ---- */
+
+static inline uint16_t rd_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t rd_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline int32_t rd_i32(const uint8_t* p) {
+    return (int32_t)rd_u32(p);
+}
+
+/* ---- NAV-PVT ---- */
+
+static bool decode_nav_pvt(const uint8_t* payload, size_t len, gps_fix_t* fix,
+                           civil_day_cache_t* day_cache) {
+    if (!payload || !fix || len < UBX_NAV_PVT_LEN) return false;
+
+    memset(fix, 0, sizeof(*fix));
+
+    uint8_t valid = payload[11];
+    uint8_t fix_type = payload[20];
+    uint8_t flags = payload[21];
+    bool fix_ok = (flags & PVT_GNSS_FIX_OK) &&
+                  fix_type >= PVT_FIX_2D && fix_type <= PVT_FIX_GNSS_DR;
+
+    if (valid & PVT_VALID_TIME) {
+        fix->hour = payload[8];
+        fix->minute = payload[9];
+        fix->second = payload[10];
+        /* nano is the signed offset from hh:mm:ss; negative means rounded up */
+        int32_t nano = rd_i32(payload + 16);
+        fix->centisecond = (nano > 0) ? (uint8_t)(nano / 10000000) : 0;
+        fix->flags |= GPS_HAS_TIME;
+    }
+    if (valid & PVT_VALID_DATE) {
+        fix->year = rd_u16(payload + 4);
+        fix->month = payload[6];
+        fix->day = payload[7];
+        fix->flags |= GPS_HAS_DATE;
+    }
+
+    /* GGA-style quality so downstream stages see the same values */
+    if (!fix_ok) {
+        fix->fix_quality = (fix_type == PVT_FIX_DR_ONLY) ? 6 : 0;
+    } else if (fix_type == PVT_FIX_GNSS_DR) {
+        fix->fix_quality = 6;
+    } else {
+        fix->fix_quality = (flags & PVT_DIFF_SOLN) ? 2 : 1;
+    }
+    fix->satellites = payload[23];
+
+    if (fix_ok) {
+        fix->longitude = (double)rd_i32(payload + 24) / 1e7;
+        fix->latitude = (double)rd_i32(payload + 28) / 1e7;
+        fix->flags |= GPS_HAS_LATLON | GPS_FIX_VALID;
+
+        fix->speed_kmh = (float)rd_i32(payload + 60) * 0.0036f;    /* mm/s */
+        fix->flags |= GPS_HAS_SPEED;
+        fix->course_deg = (float)rd_i32(payload + 64) * 1e-5f;
+        fix->flags |= GPS_HAS_COURSE;
+
+        if (fix_type != PVT_FIX_2D) {
+            fix->altitude_m = (float)rd_i32(payload + 36) / 1000.0f;  /* hMSL, mm */
+            fix->flags |= GPS_HAS_ALTITUDE;
+        }
+    }
+
+    /* NAV-PVT only carries PDOP; PDOP >= HDOP, so DOP gates stay conservative */
+    fix->hdop = (float)rd_u16(payload + 76) / 100.0f;
+    fix->flags |= GPS_HAS_HDOP;
+    fix->unix_ms = gps_fix_unix_ms(fix, day_cache);
+    return true;
+}
+
+bool ubx_decode_nav_pvt(const uint8_t* payload, size_t len, gps_fix_t* fix) {
+    return decode_nav_pvt(payload, len, fix, NULL);
+}
+
+/* ---- Framing ---- */
+
+size_t ubx_frame_encode(uint8_t msg_class, uint8_t msg_id, const uint8_t* payload,
+                        uint16_t len, uint8_t* out, size_t out_size) {
+    size_t total = (size_t)len + UBX_FRAME_OVERHEAD;
+    if (!out || out_size < total || (len > 0 && !payload)) return 0;
+
+    out[0] = UBX_SYNC_1;
+    out[1] = UBX_SYNC_2;
+    out[2] = msg_class;
+    out[3] = msg_id;
+    out[4] = (uint8_t)(len & 0xFF);
+    out[5] = (uint8_t)(len >> 8);
+    if (len > 0) memcpy(out + 6, payload, len);
+
+    /* 8-bit Fletcher over class, id, length and payload */
+    uint8_t ck_a = 0, ck_b = 0;
+    for (size_t i = 2; i < 6 + (size_t)len; i++) {
+        ck_a = (uint8_t)(ck_a + out[i]);
+        ck_b = (uint8_t)(ck_b + ck_a);
+    }
+    out[6 + len] = ck_a;
+    out[7 + len] = ck_b;
+    return total;
+}
+
+/* ---- Public API ---- */
+
+_Static_assert(sizeof(struct ubx_parser) <= sizeof(ubx_parser_storage_t),
+               "UBX_PARSER_STORAGE_SIZE too small");
+
+ubx_parser_t* ubx_parser_init(ubx_parser_storage_t* storage) {
+    if (!storage) return NULL;
+    ubx_parser_t* p = (ubx_parser_t*)storage;
+    memset(p, 0, sizeof(*p));
+    return p;
+}
+
+ubx_parser_t* ubx_parser_create(void) {
+    ubx_parser_storage_t* storage = malloc(sizeof(ubx_parser_storage_t));
+    return ubx_parser_init(storage);
+}
+
+void ubx_parser_destroy(ubx_parser_t* parser) {
+    free(parser);
+}
+
+void ubx_parser_set_fix_callback(ubx_parser_t* parser, nmea_fix_callback_t cb, void* user) {
+    if (!parser) return;
+    parser->fix_cb = cb;
+    parser->fix_cb_user = user;
+}
+
+bool ubx_parser_in_frame(const ubx_parser_t* parser) {
+    return parser && parser->state != UBX_SYNC1;
+}
+
+static inline void ubx_checksum(ubx_parser_t* parser, uint8_t b) {
+    parser->ck_a = (uint8_t)(parser->ck_a + b);
+    parser->ck_b = (uint8_t)(parser->ck_b + parser->ck_a);
+}
+
+/* Checksummed frame complete: decode what we understand */
+static bool frame_done(ubx_parser_t* parser) {
+    if (parser->msg_class != UBX_CLASS_NAV || parser->msg_id != UBX_ID_NAV_PVT ||
+        parser->len < UBX_NAV_PVT_LEN) {
+        return false;
+    }
+    if (!decode_nav_pvt(parser->payload, parser->len, &parser->completed_fix, &parser->day_cache)) {
+        return false;
+    }
+    parser->has_completed_fix = true;
+    if (parser->fix_cb) {
+        parser->fix_cb(&parser->completed_fix, parser->fix_cb_user);
+    }
+    return true;
+}
+
+size_t ubx_parser_scan(ubx_parser_t* parser, const uint8_t* buf, size_t len, int* fixes) {
+    int n = 0;
+    size_t i = 0;
+    if (!parser || !buf) len = 0;
+
+    while (i < len) {
+        uint8_t b = buf[i++];
+
+        switch (parser->state) {
+        case UBX_SYNC1:
+            if (b == UBX_SYNC_1) parser->state = UBX_SYNC2;
+            break;
+
+        case UBX_SYNC2:
+            if (b == UBX_SYNC_2) {
+                parser->state = UBX_CLASS;
+            } else {
+                /* False sync: leave this byte to the caller (it may be '$' or 0xB5) */
+                parser->state = UBX_SYNC1;
+                i--;
+            }
+            break;
+
+        case UBX_CLASS:
+            parser->msg_class = b;
+            parser->ck_a = parser->ck_b = 0;
+            ubx_checksum(parser, b);
+            parser->state = UBX_ID;
+            break;
+
+        case UBX_ID:
+            parser->msg_id = b;
+            ubx_checksum(parser, b);
+            parser->state = UBX_LEN_LO;
+            break;
+
+        case UBX_LEN_LO:
+            parser->len = b;
+            ubx_checksum(parser, b);
+            parser->state = UBX_LEN_HI;
+            break;
+
+        case UBX_LEN_HI:
+            parser->len |= (uint16_t)(b << 8);
+            ubx_checksum(parser, b);
+            parser->pos = 0;
+            if (parser->len > UBX_MAX_FRAME_PAYLOAD) {
+                parser->state = UBX_SYNC1;
+            } else {
+                parser->state = (parser->len > 0) ? UBX_PAYLOAD : UBX_CK_A;
+            }
+            break;
+
+        case UBX_PAYLOAD: {
+            /* Bulk: the rest of the payload available in this chunk */
+            size_t run = (size_t)(parser->len - parser->pos);
+            if (run > len - i + 1) run = len - i + 1;
+            const uint8_t* src = buf + i - 1;
+            uint8_t ck_a = parser->ck_a, ck_b = parser->ck_b;
+            for (size_t k = 0; k < run; k++) {
+                ck_a = (uint8_t)(ck_a + src[k]);
+                ck_b = (uint8_t)(ck_b + ck_a);
+            }
+            parser->ck_a = ck_a;
+            parser->ck_b = ck_b;
+            if (parser->pos < UBX_MAX_PAYLOAD) {
+                size_t keep = UBX_MAX_PAYLOAD - parser->pos;
+                memcpy(parser->payload + parser->pos, src, run < keep ? run : keep);
+            }
+            parser->pos = (uint16_t)(parser->pos + run);
+            i += run - 1;
+            if (parser->pos == parser->len) parser->state = UBX_CK_A;
+            break;
+        }
+
+        case UBX_CK_A:
+            parser->state = (b == parser->ck_a) ? UBX_CK_B : UBX_SYNC1;
+            break;
+
+        case UBX_CK_B:
+            parser->state = UBX_SYNC1;
+            if (b == parser->ck_b && frame_done(parser)) n++;
+            break;
+        }
+
+        if (parser->state == UBX_SYNC1) break;
+    }
+
+    if (fixes) *fixes = n;
+    return i;
+}
+
+int ubx_parser_feed_bytes(ubx_parser_t* parser, const uint8_t* buf, size_t len) {
+    if (!parser || (!buf && len > 0)) return -1;
+
+    int total = 0;
+    size_t i = 0;
+    while (i < len) {
+        if (!ubx_parser_in_frame(parser)) {
+            const uint8_t* sync = memchr(buf + i, UBX_SYNC_1, len - i);
+            if (!sync) break;
+            i = (size_t)(sync - buf);
+        }
+        int n = 0;
+        i += ubx_parser_scan(parser, buf + i, len - i, &n);
+        total += n;
+    }
+    return total;
+}
+
+bool ubx_parser_get_fix(ubx_parser_t* parser, gps_fix_t* out_fix) {
+    if (!parser || !out_fix) return false;
+    if (!parser->has_completed_fix) return false;
+    *out_fix = parser->completed_fix;
+    parser->has_completed_fix = false;
+    return true;
+}
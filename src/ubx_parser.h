@@ -0,0 +1,54 @@
+#ifndef UBX_PARSER_H
+#define UBX_PARSER_H
+
+#include "nmea_parser.h"
+
+#define UBX_SYNC_1 0xB5
+#define UBX_SYNC_2 0x62
+
+#define UBX_CLASS_NAV    0x01
+#define UBX_ID_NAV_PVT   0x07
+#define UBX_NAV_PVT_LEN  92
+
+/* sync(2) + class + id + length(2) + payload + checksum(2) */
+#define UBX_FRAME_OVERHEAD 8
+
+typedef struct ubx_parser ubx_parser_t;
+
+/* Caller-owned parser memory for ubx_parser_init() */
+#define UBX_PARSER_STORAGE_SIZE 224
+
+typedef union {
+    uint8_t bytes[UBX_PARSER_STORAGE_SIZE];
+    uint64_t align_u64;
+    void* align_ptr;
+} ubx_parser_storage_t;
+
+ubx_parser_t* ubx_parser_create(void);
+void          ubx_parser_destroy(ubx_parser_t* parser);
+/* Heap-free alternative to create; never pass the result to destroy */
+ubx_parser_t* ubx_parser_init(ubx_parser_storage_t* storage);
+void          ubx_parser_set_fix_callback(ubx_parser_t* parser, nmea_fix_callback_t cb, void* user);
+
+/* Raw byte stream input, chunks may split frames anywhere. Every valid
+   NAV-PVT frame yields one fix; other messages are checksummed and skipped.
+   Returns the number of fixes, -1 on bad args. */
+int           ubx_parser_feed_bytes(ubx_parser_t* parser, const uint8_t* buf, size_t len);
+
+/* Like feed_bytes, but stops as soon as the parser is back between frames
+   (frame done or sync lost). Returns bytes consumed; *fixes gets the count.
+   Used by gps_stream to hand the bytes around a frame to the NMEA parser. */
+size_t        ubx_parser_scan(ubx_parser_t* parser, const uint8_t* buf, size_t len, int* fixes);
+bool          ubx_parser_in_frame(const ubx_parser_t* parser);
+
+bool          ubx_parser_get_fix(ubx_parser_t* parser, gps_fix_t* out_fix);
+
+/* Decode a NAV-PVT payload (UBX_NAV_PVT_LEN bytes) into a fix */
+bool          ubx_decode_nav_pvt(const uint8_t* payload, size_t len, gps_fix_t* fix);
+
+/* Frame a message (sync, header, Fletcher checksum) into out.
+   Returns the frame length, 0 if out is too small. */
+size_t        ubx_frame_encode(uint8_t msg_class, uint8_t msg_id, const uint8_t* payload,
+                               uint16_t len, uint8_t* out, size_t out_size);
+
+#endif
@@ -0,0 +1,172 @@
+#include "unity.h"
+#include "csv_row.h"
+#include <string.h>
+#include <math.h>
+
+#define RANDOM_ROWS 2000000
+
+static uint64_t rng;
+
+void setUp(void) {
+    rng = 88172645463325252ull;
+}
+
+void tearDown(void) { }
+
+/* Helper: xorshift64 */
+static uint64_t next(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+static double uniform(double lo, double hi) {
+    return lo + (hi - lo) * ((double)(next() >> 11) / 9007199254740992.0);
+}
+
+/* Helper: a double the formatter has to get right. Plausible values,
+   values on and half a step off the 1e-6 grid, random bit patterns below
+   2^36, and the odd one for the snprintf path. */
+static double random_double(double range) {
+    uint64_t bits;
+    double v;
+    switch (next() % 8) {
+    case 0: case 1: case 2:
+        return uniform(-range, range);
+    case 3:
+        return (double)((int64_t)(next() % 400000001) - 200000000) / 1e6;
+    case 4:
+        return ((double)((int64_t)(next() % 400000001) - 200000000) + 0.5) / 1e6;
+    case 5:
+        bits = next();
+        bits = (bits & 0x800FFFFFFFFFFFFFull) | ((uint64_t)(900 + next() % 160) << 52);
+        memcpy(&v, &bits, sizeof(v));
+        return v;
+    case 6:
+        return (double)((int64_t)(next() % 2001) - 1000) / 64.0;
+    default: {
+        static const double odd[] = {0.0, -0.0, 1e30, -3e9, 2147483647.9999999, INFINITY, -INFINITY, NAN, 5e-324};
+        return odd[next() % (sizeof(odd) / sizeof(odd[0]))];
+    }
+    }
+}
+
+static float random_float(float range) {
+    uint32_t bits;
+    float v;
+    switch (next() % 6) {
+    case 0: case 1:
+        return (float)uniform(-range, range);
+    case 2:
+        return (float)((int64_t)(next() % 200001) - 100000) / 100.0f + 0.005f;
+    case 3:
+        bits = (uint32_t)next();
+        bits = (bits & 0x807FFFFFu) | ((uint32_t)(90 + next() % 72) << 23);
+        memcpy(&v, &bits, sizeof(v));
+        return v;
+    case 4:
+        return (float)((int32_t)(next() % 2001) - 1000) / 8.0f;
+    default: {
+        static const float odd[] = {0.0f, -0.0f, 1e20f, -3e9f, 3e38f, INFINITY, NAN, 1e-45f};
+        return odd[next() % (sizeof(odd) / sizeof(odd[0]))];
+    }
+    }
+}
+
+static void assert_same_row(const gps_fix_t* fix) {
+    char got[CSV_ROW_MAX], want[CSV_ROW_MAX];
+    size_t n = csv_row_format(got, fix);
+    size_t m = csv_row_format_printf(want, fix);
+    TEST_ASSERT_EQUAL_STRING(want, got);
+    TEST_ASSERT_EQUAL_size_t(m, n);
+}
+
+/* T1: the spec's example row, and missing fields left empty */
+void test_format_known_row(void) {
+    gps_fix_t fix;
+    memset(&fix, 0, sizeof(fix));
+    fix.flags = GPS_FIX_VALID | GPS_HAS_ALL;
+    fix.year = 2025; fix.month = 6; fix.day = 15;
+    fix.hour = 14; fix.minute = 23; fix.second = 7;
+    fix.latitude = 47.2852333333;
+    fix.longitude = 8.5652654321;
+    fix.speed_kmh = 52.3f;
+    fix.altitude_m = 499.6f;
+    fix.course_deg = 77.5f;
+    fix.satellites = 8;
+    fix.hdop = 1.01f;
+    fix.fix_quality = 1;
+    char line[CSV_ROW_MAX];
+    const char* row = "2025-06-15T14:23:07Z,47.285233,8.565265,52.30,499.6,77.5,8,1.01,1\n";
+    TEST_ASSERT_EQUAL_size_t(strlen(row), csv_row_format(line, &fix));
+    TEST_ASSERT_EQUAL_STRING(row, line);
+
+    fix.flags &= ~(uint32_t)(GPS_HAS_ALTITUDE | GPS_HAS_DATE);
+    csv_row_format(line, &fix);
+    TEST_ASSERT_EQUAL_STRING(",47.285233,8.565265,52.30,,77.5,8,1.01,1\n", line);
+}
+
+/* T2: exact binary ties round half to even, the sign survives rounding to
+   zero, large and non-finite values match snprintf */
+void test_format_ties_and_edges(void) {
+    gps_fix_t fix;
+    memset(&fix, 0, sizeof(fix));
+    fix.flags = GPS_HAS_LATLON | GPS_HAS_SPEED | GPS_HAS_ALTITUDE | GPS_HAS_COURSE | GPS_HAS_HDOP;
+    char line[CSV_ROW_MAX];
+
+    fix.latitude = -0.0000004;
+    fix.longitude = 0.0000005;          /* just below the tie in binary */
+    fix.speed_kmh = 0.125f;
+    fix.altitude_m = 0.25f;
+    fix.course_deg = 0.75f;
+    fix.hdop = 0.375f;
+    csv_row_format(line, &fix);
+    TEST_ASSERT_EQUAL_STRING(",-0.000000,0.000000,0.12,0.2,0.8,0,0.38,0\n", line);
+    assert_same_row(&fix);
+
+    fix.latitude = -0.0;
+    fix.longitude = 2147483647.75;
+    fix.speed_kmh = -0.004f;
+    fix.altitude_m = 1e25f;
+    fix.course_deg = INFINITY;
+    fix.hdop = NAN;
+    assert_same_row(&fix);
+    csv_row_format(line, &fix);
+    const char* head = ",-0.000000,2147483647.750000,-0.00,";
+    TEST_ASSERT_EQUAL_STRING_LEN(head, line, strlen(head));
+}
+
+/* T3: RANDOM_ROWS random fixes, every field and flag combination, come out
+   byte for byte as from snprintf */
+void test_format_matches_snprintf(void) {
+    gps_fix_t fix;
+    for (long i = 0; i < RANDOM_ROWS; i++) {
+        memset(&fix, 0, sizeof(fix));
+        fix.flags = (uint32_t)next() & (GPS_FIX_VALID | GPS_HAS_ALL);
+        if (i % 4) fix.flags |= GPS_HAS_ALL;
+        fix.year = (uint16_t)(i % 64 ? 1980 + next() % 150 : next());
+        fix.month = (uint8_t)(1 + next() % 12);
+        fix.day = (uint8_t)(1 + next() % 31);
+        fix.hour = (uint8_t)(next() % 24);
+        fix.minute = (uint8_t)(next() % 60);
+        fix.second = (uint8_t)(next() % 61);
+        fix.latitude = random_double(90.0);
+        fix.longitude = random_double(180.0);
+        fix.speed_kmh = random_float(400.0f);
+        fix.altitude_m = random_float(9000.0f);
+        fix.course_deg = random_float(360.0f);
+        fix.satellites = (uint8_t)next();
+        fix.hdop = random_float(50.0f);
+        fix.fix_quality = (uint8_t)next();
+        assert_same_row(&fix);
+    }
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_format_known_row);
+    RUN_TEST(test_format_ties_and_edges);
+    RUN_TEST(test_format_matches_snprintf);
+    return UNITY_END();
+}
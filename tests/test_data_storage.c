@@ -2,6 +2,7 @@
 #include "data_storage.h"
 #include "hal/hal.h"
 #include "hal/hal_mock.h"
+#include "csv_row.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -59,6 +60,20 @@ static char* read_file(const char* name) {
     return buf;
 }
 
+static uint8_t* read_bytes(const char* name, size_t* len) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", tmpdir, name);
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    *len = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* buf = malloc(*len + 1);
+    *len = fread(buf, 1, *len, f);
+    fclose(f);
+    return buf;
+}
+
 static bool file_exists(const char* name) {
     char path[512];
     snprintf(path, sizeof(path), "%s/%s", tmpdir, name);
@@ -82,6 +97,7 @@ static gps_fix_t make_test_fix(void) {
     fix.satellites = 8;
     fix.hdop = 1.01f;
     fix.fix_quality = 1;
+    fix.unix_ms = gps_fix_unix_ms(&fix, NULL);
     return fix;
 }
 
@@ -184,6 +200,9 @@ void test_sync_after_interval(void) {
     /* Write second fix — should trigger sync */
     storage_error_t err = data_storage_write_fix(&storage, &fix);
     TEST_ASSERT_EQUAL_INT(STORAGE_OK, err);
+    hal_mock_fs_stats_t st;
+    hal_mock_fs_get_stats(&st);
+    TEST_ASSERT_EQUAL_UINT32(1, st.syncs);
     data_storage_shutdown(&storage);
 }
 
@@ -197,6 +216,9 @@ void test_no_sync_before_interval(void) {
     hal_mock_time_advance_ms(3000);
     storage_error_t err = data_storage_write_fix(&storage, &fix);
     TEST_ASSERT_EQUAL_INT(STORAGE_OK, err);
+    hal_mock_fs_stats_t st;
+    hal_mock_fs_get_stats(&st);
+    TEST_ASSERT_EQUAL_UINT32(0, st.syncs);
     data_storage_shutdown(&storage);
 }
 
@@ -277,6 +299,432 @@ void test_coordinate_precision(void) {
     free(content);
 }
 
+/* T16: a packed fix is logged as the same row */
+void test_write_packed_fix(void) {
+    data_storage_init(&storage);
+    gps_fix_t fix = make_test_fix();
+    gps_fix_packed_t packed;
+    gps_fix_pack(&fix, &packed);
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_write_fix(&storage, &fix));
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_write_packed(&storage, &packed));
+    TEST_ASSERT_EQUAL_INT(STORAGE_ERR_WRITE, data_storage_write_packed(&storage, NULL));
+    data_storage_shutdown(&storage);
+
+    char* content = read_file("track.csv");
+    TEST_ASSERT_NOT_NULL(content);
+    char* row1 = strchr(content, '\n') + 1;
+    char* row2 = strchr(row1, '\n') + 1;
+    TEST_ASSERT_EQUAL_size_t((size_t)(row2 - row1), strlen(row2));
+    TEST_ASSERT_EQUAL_INT(0, strncmp(row1, row2, (size_t)(row2 - row1)));
+    TEST_ASSERT_TRUE(strstr(row2, "2025-06-15T14:23:07Z,47.285233,8.565265,52.30,499.6,77.5,8,1.01,1\n") == row2);
+    free(content);
+}
+
+/* T17: comment lines go after the rows, and a clean file with a trailer is
+   appended to, not rotated */
+void test_write_comment_trailer(void) {
+    static char long_text[STORAGE_MAX_COMMENT_LEN + 1];
+    const char* text = "filter_results accept=1 invalid=0";
+    data_storage_init(&storage);
+    gps_fix_t fix = make_test_fix();
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_write_fix(&storage, &fix));
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_write_comment(&storage, text, strlen(text)));
+    memset(long_text, 'x', sizeof(long_text));
+    TEST_ASSERT_EQUAL_INT(STORAGE_ERR_WRITE,
+                          data_storage_write_comment(&storage, long_text, sizeof(long_text)));
+    data_storage_shutdown(&storage);
+    TEST_ASSERT_EQUAL_INT(STORAGE_ERR_WRITE, data_storage_write_comment(&storage, text, strlen(text)));
+
+    char* content = read_file("track.csv");
+    TEST_ASSERT_NOT_NULL(content);
+    char* row = strchr(content, '\n') + 1;
+    char* comment = strchr(row, '\n') + 1;
+    TEST_ASSERT_EQUAL_STRING("# filter_results accept=1 invalid=0\n", comment);
+    free(content);
+
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init(&storage));
+    TEST_ASSERT_EQUAL_STRING("track.csv", data_storage_get_filename(&storage));
+    data_storage_shutdown(&storage);
+}
+
+/* T18: 600 rows 100 ms apart, appended to a file that ends mid-sector.
+   Unbuffered (test_data_storage_unbuffered) each row is its own write.
+   Buffered, writes end on sector boundaries except the flush at each 5 s
+   deadline and at shutdown; the card gets the same bytes. */
+void test_write_coalescing(void) {
+    const int rows = 600;
+    write_file("track.csv", CSV_HEADER);
+    hal_mock_time_set_ms(0);
+    hal_mock_fs_watch("track.csv");
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init(&storage));
+    gps_fix_t fix = make_test_fix();
+    for (int i = 0; i < rows; i++) {
+        TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_write_fix(&storage, &fix));
+        hal_mock_time_advance_ms(100);
+    }
+    data_storage_shutdown(&storage);
+
+    hal_mock_fs_stats_t st;
+    hal_mock_fs_get_stats(&st);
+    const char* row = "2025-06-15T14:23:07Z,47.285233,8.565265,52.30,499.6,77.5,8,1.01,1\n";
+    char* content = read_file("track.csv");
+    TEST_ASSERT_NOT_NULL(content);
+    TEST_ASSERT_EQUAL_size_t(strlen(CSV_HEADER) + (size_t)rows * strlen(row), strlen(content));
+    TEST_ASSERT_EQUAL_UINT32(rows * strlen(row), st.bytes);
+    TEST_ASSERT_EQUAL_STRING(row, content + strlen(content) - strlen(row));
+    free(content);
+
+    uint32_t deadlines = (uint32_t)(rows - 1) * 100 / (STORAGE_SYNC_INTERVAL_S * 1000);
+    TEST_ASSERT_EQUAL_UINT32(deadlines + 1, st.syncs);
+#if STORAGE_BUFFER_SECTORS == 0
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)rows, st.writes);
+    TEST_ASSERT_EQUAL_UINT32(strlen(row), st.max_len);
+#else
+    TEST_ASSERT_TRUE(st.writes * 10 <= (uint32_t)rows);
+    TEST_ASSERT_TRUE(st.max_len <= STORAGE_BUFFER_SECTORS * STORAGE_SECTOR_SIZE);
+    TEST_ASSERT_TRUE(st.aligned_ends + st.syncs >= st.writes);
+    TEST_ASSERT_TRUE(st.sector_writes + 2 * st.syncs >= st.writes);
+#endif
+}
+
+/* Helper: a track*.bin file back to CSV text, as tools/track2csv does */
+static char* bin_to_csv(const char* name) {
+    size_t len, used, pos = TRACK_BIN_HEADER_SIZE, out_len = strlen(CSV_HEADER);
+    uint8_t* bin = read_bytes(name, &len);
+    TEST_ASSERT_NOT_NULL(bin);
+    char* out = malloc(len * 16 + out_len + 1);
+    memcpy(out, CSV_HEADER, out_len);
+    track_bin_decoder_t dec;
+    TEST_ASSERT_TRUE(track_bin_decoder_init(&dec, bin, len));
+    track_bin_status_t st;
+    while ((st = track_bin_decode(&dec, bin + pos, len - pos, &used)) != TRACK_BIN_NEED_MORE) {
+        TEST_ASSERT_NOT_EQUAL(TRACK_BIN_SKIPPED, st);
+        if (st == TRACK_BIN_FIX) {
+            gps_fix_t fix;
+            gps_fix_unpack(&dec.fix, &fix);
+            out_len += csv_row_format(out + out_len, &fix);
+        } else if (st == TRACK_BIN_COMMENT) {
+            out_len += (size_t)sprintf(out + out_len, "# %.*s\n", (int)dec.text_len, dec.text);
+        }
+        pos += used;
+    }
+    TEST_ASSERT_EQUAL_size_t(len, pos);
+    out[out_len] = '\0';
+    free(bin);
+    return out;
+}
+
+/* Helper: two sessions of 300 and 100 fixes 1 s apart, packed and plain,
+   with a comment before the first shutdown */
+static void log_two_sessions(storage_format_t format) {
+    gps_fix_t fix = make_test_fix();
+    for (int session = 0; session < 2; session++) {
+        TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init_format(&storage, format));
+        for (int i = 0; i < (session ? 100 : 300); i++) {
+            fix.unix_ms += 1000;
+            fix.latitude += 0.000071 + 0.000003 * (i % 5);
+            fix.longitude -= 0.000104;
+            fix.speed_kmh = 30.0f + (float)(i % 40);
+            fix.altitude_m += (i % 9 == 0) ? 0.5f : 0.0f;
+            fix.satellites = (uint8_t)(7 + i / 64);
+            gps_fix_packed_t packed;
+            gps_fix_pack(&fix, &packed);
+            if (session == 0) {
+                TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_write_packed(&storage, &packed));
+            } else {
+                gps_fix_t plain;
+                gps_fix_unpack(&packed, &plain);
+                plain.unix_ms = fix.unix_ms;
+                TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_write_fix(&storage, &plain));
+            }
+            hal_mock_time_advance_ms(1000);
+        }
+        if (session == 0) {
+            TEST_ASSERT_EQUAL_INT(STORAGE_OK,
+                                  data_storage_write_comment(&storage, "filter_results accept=300", 25));
+        }
+        TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_shutdown(&storage));
+    }
+}
+
+/* T19: the binary format logs to track.bin at under 12 bytes a fix and
+   decodes to exactly the CSV file; it rotates like CSV */
+void test_binary_format_matches_csv(void) {
+    log_two_sessions(STORAGE_FORMAT_CSV);
+    char* csv = read_file("track.csv");
+    log_two_sessions(STORAGE_FORMAT_BINARY);
+    TEST_ASSERT_EQUAL_STRING("track.bin", data_storage_get_filename(&storage));
+    char* decoded = bin_to_csv("track.bin");
+    TEST_ASSERT_EQUAL_STRING(csv, decoded);
+    size_t len;
+    free(read_bytes("track.bin", &len));
+    TEST_ASSERT_TRUE(len < 12 * 400);
+    free(csv);
+    free(decoded);
+
+    write_file("_dirty", "");
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init_format(&storage, STORAGE_FORMAT_BINARY));
+    TEST_ASSERT_EQUAL_STRING("track_1.bin", data_storage_get_filename(&storage));
+    data_storage_shutdown(&storage);
+    write_file("track_1.bin", "GTRK\x01\x40\x80\x01");
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init_format(&storage, STORAGE_FORMAT_BINARY));
+    TEST_ASSERT_EQUAL_STRING("track_2.bin", data_storage_get_filename(&storage));
+    data_storage_shutdown(&storage);
+}
+
+/* T20: track.csv through track_998.csv and _dirty: init rotates to
+   track_999.csv after one directory listing, without a lookup per name and
+   in a handful of filesystem calls (reading _dirty, writing it with the
+   length and reserving the extent included). Names make_filename() does not produce
+   are no track files. */
+void test_scan_counts_fs_calls(void) {
+    write_file("track.csv", CSV_HEADER);
+    for (int i = 1; i <= 998; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "track_%d.csv", i);
+        write_file(name, CSV_HEADER);
+    }
+    write_file("_dirty", "");
+    write_file("track_1000.csv", CSV_HEADER);
+    write_file("track_0999.csv", CSV_HEADER);
+    write_file("track_999.bin", "");
+    write_file("track_999.csv.bak", "");
+
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init(&storage));
+    TEST_ASSERT_EQUAL_STRING("track_999.csv", data_storage_get_filename(&storage));
+    hal_mock_fs_stats_t st;
+    hal_mock_fs_get_stats(&st);
+    TEST_ASSERT_EQUAL_UINT32(1, st.list_dirs);
+    TEST_ASSERT_EQUAL_UINT32(0, st.exists);
+    TEST_ASSERT_TRUE(st.calls <= 16);
+    data_storage_shutdown(&storage);
+}
+
+static long disk_size(const char* name) {
+    char path[512];
+    struct stat st;
+    snprintf(path, sizeof(path), "%s/%s", tmpdir, name);
+    return stat(path, &st) == 0 ? (long)st.st_size : -1;
+}
+
+/* T21: the session reserves STORAGE_PREALLOC_SIZE bytes past the data,
+   holding old rows in the mock, and shutdown cuts them off. A session that ends in a power loss leaves them;
+   the next init truncates that file to the length the last sync recorded
+   in _dirty and rotates. */
+void test_prealloc_truncated(void) {
+    gps_fix_t fix = make_test_fix();
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init(&storage));
+    for (int i = 0; i < 10; i++) data_storage_write_fix(&storage, &fix);
+    TEST_ASSERT_TRUE(disk_size("track.csv") >= (long)STORAGE_PREALLOC_SIZE);
+    data_storage_shutdown(&storage);
+    char* clean = read_file("track.csv");
+    TEST_ASSERT_EQUAL_INT(disk_size("track.csv"), (long)strlen(clean));
+
+    /* Append eleven rows, sync them all, then lose power: the handle goes
+       without a truncate or shutdown */
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init(&storage));
+    TEST_ASSERT_EQUAL_STRING("track.csv", data_storage_get_filename(&storage));
+    for (int i = 0; i < 10; i++) data_storage_write_fix(&storage, &fix);
+    hal_mock_time_advance_ms(STORAGE_SYNC_INTERVAL_S * 1000u);
+    data_storage_write_fix(&storage, &fix);
+    TEST_ASSERT_TRUE(disk_size("track.csv") >= (long)(strlen(clean) + STORAGE_PREALLOC_SIZE));
+    hal_fs_close(storage.file);
+
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init(&storage));
+    TEST_ASSERT_EQUAL_STRING("track_1.csv", data_storage_get_filename(&storage));
+    data_storage_shutdown(&storage);
+    char* recovered = read_file("track.csv");
+    size_t row = (strlen(clean) - strlen(CSV_HEADER)) / 10;
+    TEST_ASSERT_EQUAL_INT(disk_size("track.csv"), (long)strlen(recovered));
+    TEST_ASSERT_EQUAL_size_t(strlen(clean) + 11 * row, strlen(recovered));
+    TEST_ASSERT_EQUAL_MEMORY(clean, recovered, strlen(clean));
+    TEST_ASSERT_EQUAL_MEMORY(clean + strlen(CSV_HEADER), recovered + strlen(clean) + 10 * row, row);
+    TEST_ASSERT_EQUAL_INT(disk_size("track_1.csv"), (long)strlen(CSV_HEADER));
+    free(clean);
+    free(recovered);
+}
+
+/* T22: rows buffered before a stop reach the card at the sync deadline
+   through data_storage_poll() alone; a deadline with nothing new makes no
+   filesystem call; a comment is a row for the deadline */
+void test_poll_syncs_without_writes(void) {
+    hal_mock_time_set_ms(0);
+    hal_mock_fs_watch("track.csv");
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init(&storage));
+    gps_fix_t fix = make_test_fix();
+    data_storage_write_fix(&storage, &fix);
+    hal_mock_time_advance_ms(STORAGE_SYNC_INTERVAL_S * 1000u - 1);
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_poll(&storage));
+    hal_mock_fs_stats_t st;
+    hal_mock_fs_get_stats(&st);
+    TEST_ASSERT_EQUAL_UINT32(0, st.syncs);
+#if STORAGE_BUFFER_SECTORS > 0
+    TEST_ASSERT_EQUAL_UINT32(0, st.writes);
+#endif
+
+    hal_mock_time_advance_ms(1);
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_poll(&storage));
+    hal_mock_fs_get_stats(&st);
+    TEST_ASSERT_EQUAL_UINT32(1, st.syncs);
+    char* content = read_file("track.csv");
+    char row[CSV_ROW_MAX];
+    size_t len = csv_row_format(row, &fix);
+    TEST_ASSERT_EQUAL_MEMORY(row, content + strlen(CSV_HEADER), len);
+    free(content);
+
+    /* Parked: nothing new, so a deadline touches neither file */
+    uint32_t calls = st.calls;
+    hal_mock_time_advance_ms(STORAGE_SYNC_INTERVAL_S * 1000u);
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_poll(&storage));
+    hal_mock_fs_get_stats(&st);
+    TEST_ASSERT_EQUAL_UINT32(1, st.syncs);
+    TEST_ASSERT_EQUAL_UINT32(calls, st.calls);
+
+    hal_mock_time_advance_ms(STORAGE_SYNC_INTERVAL_S * 1000u);
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_write_comment(&storage, "stop", 4));
+    hal_mock_fs_get_stats(&st);
+    TEST_ASSERT_EQUAL_UINT32(2, st.syncs);
+    data_storage_shutdown(&storage);
+    TEST_ASSERT_EQUAL_INT(STORAGE_ERR_WRITE, data_storage_poll(&storage));
+}
+
+/* T23: a power loss after binary records that end in zero bytes (deltas of
+   an unchanged fix): init truncates track.bin to exactly the synced
+   records, which recovery by content could not tell from the extent */
+void test_recovery_keeps_zero_bytes(void) {
+    gps_fix_t fix = make_test_fix();
+    gps_fix_packed_t packed;
+    gps_fix_pack(&fix, &packed);
+    uint8_t expected[TRACK_BIN_HEADER_SIZE + 6 * TRACK_BIN_RECORD_MAX];
+    size_t expected_len = track_bin_write_header(expected);
+    track_bin_encoder_t enc;
+    track_bin_encoder_init(&enc);
+    for (int i = 0; i < 6; i++) {
+        expected_len += track_bin_encode_fix(&enc, &packed, expected + expected_len);
+    }
+    TEST_ASSERT_EQUAL_HEX8(0x00, expected[expected_len - 1]);
+
+    hal_mock_time_set_ms(0);
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init_format(&storage, STORAGE_FORMAT_BINARY));
+    for (int i = 0; i < 5; i++) data_storage_write_packed(&storage, &packed);
+    hal_mock_time_advance_ms(STORAGE_SYNC_INTERVAL_S * 1000u);
+    data_storage_write_packed(&storage, &packed);
+    hal_fs_close(storage.file);
+
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init_format(&storage, STORAGE_FORMAT_BINARY));
+    TEST_ASSERT_EQUAL_STRING("track_1.bin", data_storage_get_filename(&storage));
+    data_storage_shutdown(&storage);
+    size_t len;
+    uint8_t* data = read_bytes("track.bin", &len);
+    TEST_ASSERT_EQUAL_size_t(expected_len, len);
+    TEST_ASSERT_EQUAL_MEMORY(expected, data, expected_len);
+    free(data);
+}
+
+/* T24: the extent is renewed as the data nears its end, so a session
+   longer than one extent keeps writing into reserved space; shutdown still
+   leaves exactly the data */
+void test_prealloc_renewed(void) {
+    gps_fix_t fix = make_test_fix();
+    char row[CSV_ROW_MAX];
+    size_t row_len = csv_row_format(row, &fix);
+    int rows = (int)(STORAGE_PREALLOC_SIZE / row_len) + 1;
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init(&storage));
+    for (int i = 0; i < rows; i++) {
+        TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_write_fix(&storage, &fix));
+        long data = (long)(strlen(CSV_HEADER) + (size_t)(i + 1) * row_len);
+        TEST_ASSERT_TRUE(disk_size("track.csv") >= data + (long)(STORAGE_PREALLOC_SIZE / 4) - 1024);
+    }
+    hal_mock_fs_stats_t st;
+    hal_mock_fs_get_stats(&st);
+    TEST_ASSERT_EQUAL_UINT32(2, st.expands);
+    data_storage_shutdown(&storage);
+    TEST_ASSERT_EQUAL_INT((long)(strlen(CSV_HEADER) + (size_t)rows * row_len), disk_size("track.csv"));
+}
+
+/* T25: a binary file cut off after a keyframe whose CRC byte equals the
+   end tag, without _dirty, is not taken for a clean end: init rotates */
+void test_bin_end_record_checked(void) {
+    gps_fix_t fix = make_test_fix();
+    gps_fix_packed_t packed;
+    gps_fix_pack(&fix, &packed);
+    uint8_t bin[TRACK_BIN_HEADER_SIZE + TRACK_BIN_RECORD_MAX];
+    size_t len = 0;
+    for (int i = 0; i < 4096; i++) {
+        track_bin_encoder_t enc;
+        track_bin_encoder_init(&enc);
+        len = track_bin_write_header(bin);
+        len += track_bin_encode_fix(&enc, &packed, bin + len);
+        if (bin[len - 1] == TRACK_BIN_TAG_END) break;
+        packed.lat_e6++;
+    }
+    TEST_ASSERT_EQUAL_HEX8(TRACK_BIN_TAG_END, bin[len - 1]);
+    char path[512];
+    snprintf(path, sizeof(path), "%s/track.bin", tmpdir);
+    FILE* f = fopen(path, "wb");
+    TEST_ASSERT_NOT_NULL(f);
+    fwrite(bin, 1, len, f);
+    fclose(f);
+
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init_format(&storage, STORAGE_FORMAT_BINARY));
+    TEST_ASSERT_EQUAL_STRING("track_1.bin", data_storage_get_filename(&storage));
+    data_storage_shutdown(&storage);
+
+    /* A clean session ends with the whole record and is appended to */
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init_format(&storage, STORAGE_FORMAT_BINARY));
+    TEST_ASSERT_EQUAL_STRING("track_1.bin", data_storage_get_filename(&storage));
+    data_storage_shutdown(&storage);
+}
+
+/* T26: init that fails with the track file open closes it again: more
+   failed inits than HAL_FS_MAX_OPEN, then one on a working card succeeds */
+void test_init_failure_releases_file(void) {
+    hal_mock_fs_set_write_error(true);
+    for (int i = 0; i <= HAL_FS_MAX_OPEN; i++) {
+        TEST_ASSERT_EQUAL_INT(STORAGE_ERR_OPEN, data_storage_init(&storage));
+        TEST_ASSERT_FALSE(storage.is_open);
+    }
+    hal_mock_fs_set_write_error(false);
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init(&storage));
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_shutdown(&storage));
+}
+
+/* T27: when shutdown cannot write out the buffer it does not truncate at
+   the write position and keeps _dirty; the next init cuts the file back
+   to the synced rows and rotates */
+void test_shutdown_write_failure_keeps_dirty(void) {
+    gps_fix_t fix = make_test_fix();
+    char row[CSV_ROW_MAX];
+    size_t row_len = csv_row_format(row, &fix);
+    hal_mock_time_set_ms(0);
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init(&storage));
+    for (int i = 0; i < 3; i++) data_storage_write_fix(&storage, &fix);
+    hal_mock_time_advance_ms(STORAGE_SYNC_INTERVAL_S * 1000u);
+    data_storage_write_fix(&storage, &fix);
+    data_storage_write_fix(&storage, &fix);
+
+    hal_mock_fs_set_write_error(true);
+#if STORAGE_BUFFER_SECTORS > 0
+    TEST_ASSERT_EQUAL_INT(STORAGE_ERR_WRITE, data_storage_shutdown(&storage));
+    TEST_ASSERT_TRUE(file_exists("_dirty"));
+    TEST_ASSERT_TRUE(disk_size("track.csv") >= (long)STORAGE_PREALLOC_SIZE);
+    hal_mock_fs_set_write_error(false);
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init(&storage));
+    TEST_ASSERT_EQUAL_STRING("track_1.csv", data_storage_get_filename(&storage));
+    TEST_ASSERT_EQUAL_INT((long)(strlen(CSV_HEADER) + 4 * row_len), disk_size("track.csv"));
+    data_storage_shutdown(&storage);
+#else
+    /* Rows were written through: nothing is left to fail */
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_shutdown(&storage));
+    TEST_ASSERT_FALSE(file_exists("_dirty"));
+    hal_mock_fs_set_write_error(false);
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init(&storage));
+    TEST_ASSERT_EQUAL_STRING("track.csv", data_storage_get_filename(&storage));
+    data_storage_shutdown(&storage);
+    TEST_ASSERT_EQUAL_INT((long)(strlen(CSV_HEADER) + 5 * row_len), disk_size("track.csv"));
+#endif
+}
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_fresh_start_creates_file);
@@ -294,5 +742,17 @@ int main(void) {
     RUN_TEST(test_csv_header_content);
     RUN_TEST(test_timestamp_format);
     RUN_TEST(test_coordinate_precision);
+    RUN_TEST(test_write_packed_fix);
+    RUN_TEST(test_write_comment_trailer);
+    RUN_TEST(test_write_coalescing);
+    RUN_TEST(test_binary_format_matches_csv);
+    RUN_TEST(test_scan_counts_fs_calls);
+    RUN_TEST(test_prealloc_truncated);
+    RUN_TEST(test_poll_syncs_without_writes);
+    RUN_TEST(test_recovery_keeps_zero_bytes);
+    RUN_TEST(test_prealloc_renewed);
+    RUN_TEST(test_bin_end_record_checked);
+    RUN_TEST(test_init_failure_releases_file);
+    RUN_TEST(test_shutdown_write_failure_keeps_dirty);
     return UNITY_END();
 }
@@ -1,6 +1,7 @@
 #include "unity.h"
 #include "geo_utils.h"
 #include <math.h>
+#include <stdint.h>
 
 void setUp(void) { }
 
@@ -23,10 +24,175 @@ void test_haversine_antipodal(void) {
     TEST_ASSERT_FLOAT_WITHIN(1000.0, 20015087.0, d);
 }
 
+/* Helper: xorshift64 uniform in [0, 1) */
+static uint64_t rng = 88172645463325252ull;
+static double uniform(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return (double)(rng >> 11) / 9007199254740992.0;
+}
+
+static int32_t to_e6(double deg) {
+    return (int32_t)lrint(deg * 1e6);
+}
+
+/* T4: float32 kernels within the documented bounds below 1 km */
+void test_haversine_float_short_range(void) {
+    double worst_mf = 0.0, worst_e6 = 0.0, worst_e6_mid = 0.0;
+    for (int i = 0; i < 1000000; i++) {
+        double lat = uniform() * 179.8 - 89.9, lon = uniform() * 360.0 - 180.0;
+        double bearing = uniform() * 6.283185307179586, dist = uniform() * 1000.0;
+        double lat2 = lat + dist * cos(bearing) / 111195.0;
+        double lon2 = lon + dist * sin(bearing) / (111195.0 * cos(lat * 0.017453292519943295));
+        int32_t a = to_e6(lat), b = to_e6(lon), c = to_e6(lat2), d = to_e6(lon2);
+
+        double ref = haversine_distance_m(a / 1e6, b / 1e6, c / 1e6, d / 1e6);
+        double mf = haversine_distance_mf((float)(a / 1e6), (float)(b / 1e6),
+                                          (float)(c / 1e6), (float)(d / 1e6));
+        double e6 = haversine_distance_e6_mf(a, b, c, d);
+        if (fabs(mf - ref) > worst_mf) worst_mf = fabs(mf - ref);
+        if (fabs(e6 - ref) > worst_e6) worst_e6 = fabs(e6 - ref);
+        if (fabs(lat) <= 85.0 && fabs(e6 - ref) > worst_e6_mid) worst_e6_mid = fabs(e6 - ref);
+    }
+    TEST_ASSERT_TRUE(worst_mf <= 1.7);
+    TEST_ASSERT_TRUE(worst_e6 <= 0.06);
+    TEST_ASSERT_TRUE(worst_e6_mid <= 0.002);
+}
+
+/* T5: float32 kernels within 6 m up to 15,000 km */
+void test_haversine_float_long_range(void) {
+    double worst = 0.0;
+    for (int i = 0; i < 1000000; i++) {
+        int32_t a = to_e6(uniform() * 180.0 - 90.0), b = to_e6(uniform() * 360.0 - 180.0);
+        int32_t c = to_e6(uniform() * 180.0 - 90.0), d = to_e6(uniform() * 360.0 - 180.0);
+        double ref = haversine_distance_m(a / 1e6, b / 1e6, c / 1e6, d / 1e6);
+        if (ref > 15000000.0) continue;
+        double e6 = haversine_distance_e6_mf(a, b, c, d);
+        double mf = haversine_distance_mf((float)(a / 1e6), (float)(b / 1e6),
+                                          (float)(c / 1e6), (float)(d / 1e6));
+        if (fabs(e6 - ref) > worst) worst = fabs(e6 - ref);
+        if (fabs(mf - ref) > worst) worst = fabs(mf - ref);
+    }
+    TEST_ASSERT_TRUE(worst <= 6.0);
+    TEST_ASSERT_FLOAT_WITHIN(6.0f, 20015087.0f * 0.5f,
+                             haversine_distance_mf(0.0f, 0.0f, 0.0f, 90.0f));
+}
+
+/* T6: along a random track, the fast path stays within 1 mm of haversine
+   and the fallbacks take over past 1 km and 80 deg */
+void test_distance_fast_property(void) {
+    geo_cos_cache_t cache = {0}, cache_f = {0};
+    double lat = 47.285233, lon = 8.565265;
+    double worst = 0.0, worst_f = 0.0, worst_f_fast = 0.0;
+    for (int i = 0; i < 1000000; i++) {
+        double bearing = uniform() * 6.283185307179586, dist = uniform() * 1500.0;
+        if (i % 1000 == 0) {            /* jump somewhere else, poles included */
+            lat = uniform() * 179.8 - 89.9;
+            lon = uniform() * 360.0 - 180.0;
+        }
+        double lat2 = lat + dist * cos(bearing) / 111195.0;
+        double lon2 = lon + dist * sin(bearing) / (111195.0 * cos(lat * 0.017453292519943295));
+        if (lat2 > 89.9 || lat2 < -89.9) lat2 = lat;
+        if (lon2 > 180.0) lon2 -= 360.0;
+        if (lon2 < -180.0) lon2 += 360.0;
+        int32_t a = to_e6(lat), b = to_e6(lon), c = to_e6(lat2), d = to_e6(lon2);
+
+        double ref = haversine_distance_m(a / 1e6, b / 1e6, c / 1e6, d / 1e6);
+        double fast = geo_distance_fast_m(&cache, a, b, c, d);
+        double fast_f = geo_distance_fast_mf(&cache_f, a, b, c, d);
+        if (fabs(fast - ref) > worst) worst = fabs(fast - ref);
+        if (fabs(fast_f - ref) > worst_f) worst_f = fabs(fast_f - ref);
+        if (fabs(lat) <= 80.0 && fabs(lat2) <= 80.0 && fabs(fast_f - ref) > worst_f_fast) {
+            worst_f_fast = fabs(fast_f - ref);
+        }
+        lat = lat2;
+        lon = lon2;
+    }
+    TEST_ASSERT_TRUE(worst <= 0.001);
+    TEST_ASSERT_TRUE(worst_f_fast <= 0.001);
+    TEST_ASSERT_TRUE(worst_f <= 0.1);       /* haversine_distance_e6_mf(), 1.5 km past 80 deg */
+
+    /* Antimeridian, NULL cache, long range */
+    TEST_ASSERT_TRUE(fabs(geo_distance_fast_m(NULL, 0, 179999500, 0, -179999500) - 111.195) < 0.001);
+    TEST_ASSERT_TRUE(fabs(geo_distance_fast_m(&cache, 47376900, 8541700, 46948000, 7447400)
+                          - haversine_distance_m(47.3769, 8.5417, 46.9480, 7.4474)) < 1e-6);
+}
+
+/* T7: every SIMD level matches haversine_distance_m() pair by pair */
+void test_distance_batch_accuracy(void) {
+    enum { N = 100003 };                /* odd, so every level has a tail */
+    static double lat[N], lon[N], out[N];
+    for (int i = 0; i < N; i++) {
+        if (i % 2 == 0 || i % 3 == 0) { /* short steps and global jumps */
+            lat[i] = uniform() * 180.0 - 90.0;
+            lon[i] = uniform() * 360.0 - 180.0;
+        } else {
+            lat[i] = fmin(90.0, fmax(-90.0, lat[i - 1] + (uniform() - 0.5) * 0.01));
+            lon[i] = lon[i - 1] + (uniform() - 0.5) * 0.01;
+        }
+    }
+    lat[10] = lat[11] = 12.5;           /* zero distance */
+    lon[10] = lon[11] = 179.9;
+    lon[12] = -179.9;                   /* antimeridian */
+    lat[12] = 12.5;
+
+    for (int s = GEO_SIMD_SCALAR; s <= (int)geo_simd_available(); s++) {
+        out[N - 1] = -1.0;
+        geo_distance_batch_simd((geo_simd_t)s, lat, lon, N, out);
+        double worst = 0.0;
+        for (int i = 0; i + 1 < N; i++) {
+            double ref = haversine_distance_m(lat[i], lon[i], lat[i + 1], lon[i + 1]);
+            double err = fabs(out[i] - ref) / (ref > 1.0 ? ref : 1.0);
+            if (err > worst) worst = err;
+        }
+        TEST_ASSERT_TRUE(worst <= 1e-11);
+        TEST_ASSERT_TRUE(out[10] == 0.0);
+        TEST_ASSERT_TRUE(out[N - 1] == -1.0);   /* n - 1 outputs only */
+    }
+
+    out[0] = -1.0;
+    geo_distance_batch(lat, lon, 1, out);
+    TEST_ASSERT_TRUE(out[0] == -1.0);
+}
+
+/* T8: tangent-plane offsets wrap at the antimeridian and agree with
+   haversine at short range */
+void test_e6_delta_m(void) {
+    TEST_ASSERT_EQUAL_INT32(1000, geo_dlon_e6(179999500, -179999500));
+    TEST_ASSERT_EQUAL_INT32(-1000, geo_dlon_e6(-179999500, 179999500));
+    TEST_ASSERT_EQUAL_INT32(-360000, geo_dlon_e6(180000000, 179640000));
+    TEST_ASSERT_EQUAL_INT32(-179999000, geo_wrap_lon_e6(180001000LL));
+    TEST_ASSERT_EQUAL_INT32(179999000, geo_wrap_lon_e6(-180001000LL));
+    TEST_ASSERT_EQUAL_INT32(180000000, geo_wrap_lon_e6(180000000LL));
+
+    float m_lon = geo_m_per_e6_lon_f(0);
+    TEST_ASSERT_TRUE(fabsf(m_lon - GEO_M_PER_E6_F) < 1e-9f);
+    float east, north;
+    geo_e6_delta_m(0, 179999500, m_lon, 0, -179999500, &east, &north);
+    TEST_ASSERT_TRUE(fabsf(east - 111.195f) < 0.001f && north == 0.0f);
+
+    int32_t lat0 = 47285233, lon0 = 8565265;
+    m_lon = geo_m_per_e6_lon_f(lat0);
+    for (int i = 0; i < 1000; i++) {
+        int32_t lat = lat0 + (int32_t)(uniform() * 9000.0 - 4500.0);
+        int32_t lon = lon0 + (int32_t)(uniform() * 13000.0 - 6500.0);
+        geo_e6_delta_m(lat0, lon0, m_lon, lat, lon, &east, &north);
+        double ref = haversine_distance_m(lat0 / 1e6, lon0 / 1e6, lat / 1e6, lon / 1e6);
+        TEST_ASSERT_TRUE(fabs(sqrt((double)east * east + (double)north * north) - ref) < 0.5);
+        TEST_ASSERT_TRUE((east >= 0.0f) == (lon >= lon0) && (north >= 0.0f) == (lat >= lat0));
+    }
+}
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_haversine_known_distance);
     RUN_TEST(test_haversine_zero_distance);
     RUN_TEST(test_haversine_antipodal);
+    RUN_TEST(test_haversine_float_short_range);
+    RUN_TEST(test_haversine_float_long_range);
+    RUN_TEST(test_distance_fast_property);
+    RUN_TEST(test_distance_batch_accuracy);
+    RUN_TEST(test_e6_delta_m);
     return UNITY_END();
 }
@@ -2,6 +2,8 @@
 #include "gps_filter.h"
 #include "geo_utils.h"
 #include <string.h>
+#include <math.h>
+#include <stdio.h>
 
 static gps_filter_t filter;
 
@@ -15,6 +17,7 @@ static gps_fix_t make_fix(double lat, double lon, float speed, uint8_t h, uint8_
     fix.hour = h;
     fix.minute = m;
     fix.second = s;
+    fix.unix_ms = gps_fix_unix_ms(&fix, NULL);
     return fix;
 }
 
@@ -195,6 +198,460 @@ void test_realistic_driving_sequence(void) {
     TEST_ASSERT_EQUAL_INT(11, accepted);
 }
 
+/* T17: packed fixes get the same decisions, and the filter state is smaller */
+void test_packed_fix_input(void) {
+    static const float speeds[] = { 1.0f, 20.0f, 40.0f, 40.0f, 1.0f, 0.5f, 15.0f, 30.0f };
+    gps_filter_t packed_filter;
+    gps_filter_init(&packed_filter);
+
+    for (int i = 0; i < 8; i++) {
+        gps_fix_t fix = make_fix(47.0 + 0.0002 * i, 8.0, speeds[i], 10, 0, (uint8_t)i);
+        gps_fix_packed_t packed;
+        gps_fix_pack(&fix, &packed);
+        TEST_ASSERT_EQUAL_INT(gps_filter_process(&filter, &fix),
+                              gps_filter_process_packed(&packed_filter, &packed));
+        TEST_ASSERT_EQUAL_INT(gps_filter_get_state(&filter), gps_filter_get_state(&packed_filter));
+    }
+    gps_fix_t outlier = make_fix(48.0, 8.0, 50.0, 10, 0, 8);
+    gps_fix_packed_t packed;
+    gps_fix_pack(&outlier, &packed);
+    TEST_ASSERT_EQUAL_INT(FILTER_REJECT_OUTLIER, gps_filter_process_packed(&packed_filter, &packed));
+#if GPS_FILTER_KALMAN
+    TEST_ASSERT_TRUE(sizeof(gps_filter_t) <= 336 + sizeof(gps_kalman_t) + 8);
+#else
+    TEST_ASSERT_TRUE(sizeof(gps_filter_t) <= 336);
+#endif
+}
+
+/* Helper: moving fix at a full UTC date and time */
+static gps_fix_t make_dated_fix(double lat, uint16_t y, uint8_t mo, uint8_t d,
+                                uint8_t h, uint8_t mi, uint8_t s) {
+    gps_fix_t fix = make_fix(lat, 8.0, 50.0, h, mi, s);
+    fix.flags |= GPS_HAS_DATE;
+    fix.year = y;
+    fix.month = mo;
+    fix.day = d;
+    fix.unix_ms = gps_fix_unix_ms(&fix, NULL);
+    return fix;
+}
+
+/* T18: time deltas are exact across month, year and leap-day boundaries */
+void test_speed_gate_across_date_boundaries(void) {
+    static const uint16_t ymd[][3] = {
+        { 2025, 1, 31 },    /* -> Feb 1 */
+        { 2024, 12, 31 },   /* -> Jan 1 */
+        { 2024, 2, 28 },    /* -> Feb 29 */
+        { 2024, 2, 29 },    /* -> Mar 1 */
+        { 2023, 2, 28 },    /* -> Mar 1 */
+    };
+    static const uint16_t next[][3] = {
+        { 2025, 2, 1 }, { 2025, 1, 1 }, { 2024, 2, 29 }, { 2024, 3, 1 }, { 2023, 3, 1 },
+    };
+    for (int i = 0; i < 5; i++) {
+        /* 2 s across midnight: 50 m is plausible, 10 km is not */
+        gps_filter_init(&filter);
+        gps_fix_t a = make_dated_fix(47.0, ymd[i][0], (uint8_t)ymd[i][1], (uint8_t)ymd[i][2], 23, 59, 59);
+        gps_fix_t b = make_dated_fix(47.00045, next[i][0], (uint8_t)next[i][1], (uint8_t)next[i][2], 0, 0, 1);
+        gps_fix_t c = make_dated_fix(47.1, next[i][0], (uint8_t)next[i][1], (uint8_t)next[i][2], 0, 0, 3);
+        TEST_ASSERT_TRUE(b.unix_ms - a.unix_ms == 2000);
+        TEST_ASSERT_EQUAL_INT(FILTER_ACCEPT, gps_filter_process(&filter, &a));
+        TEST_ASSERT_EQUAL_INT(FILTER_ACCEPT, gps_filter_process(&filter, &b));
+        TEST_ASSERT_EQUAL_INT(FILTER_REJECT_OUTLIER, gps_filter_process(&filter, &c));
+        /* Going back across the boundary is a negative delta */
+        TEST_ASSERT_EQUAL_INT(FILTER_REJECT_NO_TIME_DELTA, gps_filter_process(&filter, &a));
+    }
+}
+
+/* T19: each logging trigger on its own, the speed gate still judges
+   skipped fixes one interval apart, NULL turns the policy off */
+void test_logging_policy_triggers(void) {
+    static const gps_filter_policy_t interval_only = { 0.0f, 0.0f, 5000 };
+    static const gps_filter_policy_t distance_only = { 0.0f, 100.0f, 0 };
+    static const gps_filter_policy_t course_only = { 20.0f, 0.0f, 0 };
+    gps_fix_t fix;
+
+    /* 10 m/s north, 1 fix/s: logged every 5 s */
+    gps_filter_set_policy(&filter, &interval_only);
+    int logged = 0;
+    for (int t = 0; t <= 20; t++) {
+        fix = make_fix(47.0 + 0.00009 * t, 8.0, 36.0f, 10, 0, (uint8_t)t);
+        gps_filter_result_t r = gps_filter_process(&filter, &fix);
+        TEST_ASSERT_EQUAL_INT(t % 5 == 0 ? FILTER_ACCEPT : FILTER_REJECT_POLICY, r);
+        logged += r == FILTER_ACCEPT;
+    }
+    TEST_ASSERT_EQUAL_INT(5, logged);
+    /* 100 m in 1 s after skipped fixes is still an outlier */
+    fix = make_fix(47.0 + 0.00009 * 20 + 0.0009, 8.0, 36.0f, 10, 0, 21);
+    TEST_ASSERT_EQUAL_INT(FILTER_REJECT_OUTLIER, gps_filter_process(&filter, &fix));
+
+    /* 40 m/s: 100 m is passed on every third fix */
+    gps_filter_init(&filter);
+    gps_filter_set_policy(&filter, &distance_only);
+    for (int t = 0; t <= 9; t++) {
+        fix = make_fix(47.0 + 0.00036 * t, 8.0, 144.0f, 10, 0, (uint8_t)t);
+        TEST_ASSERT_EQUAL_INT(t % 3 == 0 ? FILTER_ACCEPT : FILTER_REJECT_POLICY,
+                              gps_filter_process(&filter, &fix));
+    }
+
+    /* Course wanders 10 deg either side of north, then one 25 deg step
+       across 0/360 */
+    gps_filter_init(&filter);
+    gps_filter_set_policy(&filter, &course_only);
+    static const float course[] = { 5.0f, 355.0f, 15.0f, 350.0f, 10.0f, 340.0f, 340.0f };
+    for (int t = 0; t < 7; t++) {
+        fix = make_fix(47.0 + 0.0001 * t, 8.0, 36.0f, 10, 0, (uint8_t)t);
+        fix.flags |= GPS_HAS_COURSE;
+        fix.course_deg = course[t];
+        TEST_ASSERT_EQUAL_INT(t == 0 || t == 5 ? FILTER_ACCEPT : FILTER_REJECT_POLICY,
+                              gps_filter_process(&filter, &fix));
+    }
+    /* Below GPS_FILTER_LOG_COURSE_MIN_KMH the course is not trusted */
+    fix = make_fix(47.0 + 0.0001 * 6.5, 8.0, 8.0f, 10, 0, 7);
+    fix.flags |= GPS_HAS_COURSE;
+    fix.course_deg = 90.0f;
+    TEST_ASSERT_EQUAL_INT(FILTER_REJECT_POLICY, gps_filter_process(&filter, &fix));
+
+    /* State changes are always logged; NULL logs every fix */
+    fix = make_fix(47.0007, 8.0, 1.0f, 10, 0, 8);
+    TEST_ASSERT_EQUAL_INT(FILTER_ACCEPT, gps_filter_process(&filter, &fix));
+    fix = make_fix(47.0007, 8.0, 20.0f, 10, 0, 9);
+    TEST_ASSERT_EQUAL_INT(FILTER_ACCEPT, gps_filter_process(&filter, &fix));
+    gps_filter_set_policy(&filter, NULL);
+    fix = make_fix(47.00071, 8.0, 20.0f, 10, 0, 10);
+    TEST_ASSERT_EQUAL_INT(FILTER_ACCEPT, gps_filter_process(&filter, &fix));
+}
+
+/* Synthetic drives for T20/T21: straights joined by turns on a fixed
+   radius, one fix per second with 2 m / 2 deg noise */
+#define TRACE_MAX   4000
+#define M_PER_DEG   111194.93
+
+typedef struct { double straight_m; double turn_deg; } leg_t;
+
+static double trace_x[TRACE_MAX], trace_y[TRACE_MAX], trace_course[TRACE_MAX];
+static uint64_t rng;
+
+static double gauss(void) {
+    double u[2];
+    for (int k = 0; k < 2; k++) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        u[k] = ((double)(rng >> 11) + 0.5) / 9007199254740992.0;
+    }
+    return sqrt(-2.0 * log(u[0])) * cos(6.283185307179586 * u[1]);
+}
+
+/* Helper: truth positions (m east/north) and course, one per second */
+static int drive_legs(const leg_t* legs, int n_legs, double speed, double radius_m) {
+    const double dt = 0.01, deg = 0.017453292519943295;
+    double x = 0.0, y = 0.0, course = 0.0, t = 0.0;
+    int n = 0;
+    for (int i = 0; i < n_legs; i++) {
+        double straight = legs[i].straight_m;
+        double turn = fabs(legs[i].turn_deg) * deg * radius_m;   /* arc length */
+        double sign = legs[i].turn_deg < 0 ? -1.0 : 1.0;
+        while ((straight > 0.0 || turn > 0.0) && n < TRACE_MAX) {
+            if (t >= n) {
+                trace_x[n] = x;
+                trace_y[n] = y;
+                trace_course[n] = fmod(course / deg + 360.0, 360.0);
+                n++;
+            }
+            double step = speed * dt;
+            if (straight > 0.0) {
+                straight -= step;
+            } else {
+                course += sign * step / radius_m;
+                turn -= step;
+            }
+            x += step * sin(course);
+            y += step * cos(course);
+            t += dt;
+        }
+    }
+    return n;
+}
+
+/* Helper: feed the trace through a filter with the default policy; logs
+   the accepted indices and returns how many */
+static int log_trace(int n, float speed_kmh, int* logged) {
+    static const gps_filter_policy_t policy = GPS_FILTER_POLICY_DEFAULT;
+    gps_filter_init(&filter);
+    gps_filter_set_policy(&filter, &policy);
+    rng = 88172645463325252ull;
+    int n_logged = 0;
+    for (int i = 0; i < n; i++) {
+        gps_fix_t fix = make_fix(47.0 + (trace_y[i] + 2.0 * gauss()) / M_PER_DEG,
+                                 8.0 + (trace_x[i] + 2.0 * gauss()) / (M_PER_DEG * cos(47.0 * 0.017453292519943295)),
+                                 speed_kmh, 0, 0, 0);
+        fix.flags |= GPS_HAS_COURSE;
+        fix.course_deg = (float)fmod(trace_course[i] + 2.0 * gauss() + 360.0, 360.0);
+        fix.unix_ms = 1700000000000ull + (uint64_t)i * 1000;
+        if (gps_filter_process(&filter, &fix) == FILTER_ACCEPT) logged[n_logged++] = i;
+    }
+    return n_logged;
+}
+
+/* Helper: largest distance from a truth point to the logged (truth)
+   polyline segment spanning it */
+static double trace_error(const int* logged, int n_logged) {
+    double worst = 0.0;
+    for (int k = 0; k + 1 < n_logged; k++) {
+        int a = logged[k], b = logged[k + 1];
+        double ex = trace_x[b] - trace_x[a], ey = trace_y[b] - trace_y[a];
+        double len2 = ex * ex + ey * ey;
+        for (int i = a + 1; i < b; i++) {
+            double px = trace_x[i] - trace_x[a], py = trace_y[i] - trace_y[a];
+            double u = len2 > 0.0 ? (px * ex + py * ey) / len2 : 0.0;
+            u = u < 0.0 ? 0.0 : (u > 1.0 ? 1.0 : u);
+            double d = hypot(px - u * ex, py - u * ey);
+            if (d > worst) worst = d;
+        }
+    }
+    return worst;
+}
+
+/* T20: city blocks at 36 km/h with 90 deg corners on a 12 m radius: the
+   corners keep their shape */
+void test_logging_policy_city_trace(void) {
+    static const leg_t legs[] = {
+        { 180, 90 }, { 120, -90 }, { 250, -90 }, { 90, 90 }, { 300, 90 }, { 160, -45 },
+        { 140, -45 }, { 220, 90 }, { 80, 90 }, { 200, -90 }, { 260, 0 },
+    };
+    static int logged[TRACE_MAX];
+    int n = drive_legs(legs, (int)(sizeof(legs) / sizeof(legs[0])), 10.0, 12.0);
+    int n_logged = log_trace(n, 36.0f, logged);
+    double err = trace_error(logged, n_logged);
+    TEST_ASSERT_TRUE(n >= 3 * n_logged);
+    TEST_ASSERT_TRUE(err < 8.0);
+
+    /* One fix every n / n_logged s, without the policy, cuts corners */
+    int stride = n / n_logged, n_uniform = 0;
+    for (int i = 0; i < n; i += stride) logged[n_uniform++] = i;
+    TEST_ASSERT_TRUE(trace_error(logged, n_uniform) > 2.0 * err);
+}
+
+/* T21: 27 min of motorway at 108 km/h, long curves on a 1 km radius:
+   5-10x fewer writes; the error is about the 5 m sagitta of a 200 m chord
+   on that radius */
+void test_logging_policy_highway_trace(void) {
+    static const leg_t legs[] = {
+        { 9000, 25 }, { 6000, -40 }, { 12000, 15 }, { 4000, -30 }, { 16000, 0 },
+    };
+    static int logged[TRACE_MAX];
+    int n = drive_legs(legs, (int)(sizeof(legs) / sizeof(legs[0])), 30.0, 1000.0);
+    TEST_ASSERT_TRUE(n >= 1500);
+    int n_logged = log_trace(n, 108.0f, logged);
+    double err = trace_error(logged, n_logged);
+    TEST_ASSERT_TRUE(n >= 5 * n_logged && n <= 10 * n_logged);
+    TEST_ASSERT_TRUE(err < 6.5);
+}
+
+/* Helper: fix at east/north metres from (47, 8), t seconds into the trace */
+static gps_fix_t trace_fix(double east, double north, double speed_kmh, int t) {
+    gps_fix_t fix = make_fix(47.0 + north / M_PER_DEG,
+                             8.0 + east / (M_PER_DEG * cos(47.0 * 0.017453292519943295)),
+                             (float)(speed_kmh < 0.0 ? 0.0 : speed_kmh), 0, 0, 0);
+    fix.unix_ms = 1700000000000ull + (uint64_t)t * 1000;
+    return fix;
+}
+
+/* Parked drift: each axis an AR(1) walk, 3 m sigma, 30 s correlation */
+static double drift_e, drift_n;
+
+static void drift_step(void) {
+    const double a = 0.9672161, s = 3.0 * 0.2540;     /* exp(-1/30), 3 sqrt(1 - a^2) */
+    drift_e = a * drift_e + s * gauss();
+    drift_n = a * drift_n + s * gauss();
+}
+
+/* Helper: state changes the speed-only rule (before the window) makes */
+static int legacy_transitions(const float* speed, int n, bool moving) {
+    int changes = 0;
+    for (int i = 0; i < n; i++) {
+        bool slow = speed[i] < GPS_FILTER_STATIONARY_THRESHOLD_KMH;
+        if (slow == moving) {
+            moving = !moving;
+            changes++;
+        }
+    }
+    return changes;
+}
+
+/* T22: drive in, park for an hour with drift reported at 0-6 km/h, crawl
+   away at 6 km/h. One stop and one resume, against hundreds of flaps from
+   speed alone; the crawl is picked up within 10 s. */
+void test_parked_drift_transitions(void) {
+    static float speed[3600];
+    rng = 88172645463325252ull;
+    drift_e = drift_n = 0.0;
+    int t = 0, changes = 0;
+    gps_filter_state_t prev = FILTER_STATE_COLD_START;
+
+    for (; t < 30; t++) {
+        gps_fix_t fix = trace_fix(-8.33 * (30 - t), 0.0, 30.0, t);
+        gps_filter_process(&filter, &fix);
+    }
+    prev = gps_filter_get_state(&filter);
+    TEST_ASSERT_EQUAL_INT(FILTER_STATE_MOVING, prev);
+
+    for (int i = 0; i < 3600; i++, t++) {
+        drift_step();
+        speed[i] = (float)(3.0 + 1.5 * gauss());
+        gps_fix_t fix = trace_fix(drift_e, drift_n, speed[i], t);
+        gps_filter_process(&filter, &fix);
+        changes += gps_filter_get_state(&filter) != prev;
+        prev = gps_filter_get_state(&filter);
+    }
+    int legacy = legacy_transitions(speed, 3600, true);
+    TEST_ASSERT_EQUAL_INT(1, changes);
+    TEST_ASSERT_TRUE(legacy >= 500);
+    TEST_ASSERT_EQUAL_INT(FILTER_STATE_STOPPED, prev);
+
+    /* Crawl away east at 6 km/h */
+    int resumed_after = -1;
+    for (int i = 1; i <= 30; i++, t++) {
+        drift_step();
+        gps_fix_t fix = trace_fix(drift_e + 1.67 * i, drift_n, 6.0, t);
+        if (gps_filter_process(&filter, &fix) == FILTER_ACCEPT && resumed_after < 0) resumed_after = i;
+    }
+    TEST_ASSERT_TRUE(resumed_after > 0 && resumed_after <= 10);
+    TEST_ASSERT_EQUAL_INT(FILTER_STATE_MOVING, gps_filter_get_state(&filter));
+}
+
+/* T23: drift that never reports under 3 km/h. From power-on nothing is
+   logged. After driving in, the window settles within its dwell time and
+   the car stays stopped; speed alone would log every fix. */
+void test_parked_drift_never_slow(void) {
+    rng = 0x9E3779B97F4A7C15ull;
+    drift_e = drift_n = 0.0;
+    int accepted = 0;
+    for (int t = 0; t < 600; t++) {
+        drift_step();
+        gps_fix_t fix = trace_fix(drift_e, drift_n, 4.0 + 0.5 * gauss(), t);
+        accepted += gps_filter_process(&filter, &fix) == FILTER_ACCEPT;
+    }
+    TEST_ASSERT_EQUAL_INT(0, accepted);
+    TEST_ASSERT_EQUAL_INT(FILTER_STATE_COLD_START, gps_filter_get_state(&filter));
+
+    int t = 600, stopped_at = -1;
+    for (; t < 660; t++) {
+        gps_fix_t fix = trace_fix(-8.33 * (660 - t), 0.0, 30.0, t);
+        gps_filter_process(&filter, &fix);
+    }
+    TEST_ASSERT_EQUAL_INT(FILTER_STATE_MOVING, gps_filter_get_state(&filter));
+    accepted = 0;
+    for (int i = 0; i < 1800; i++, t++) {
+        drift_step();
+        gps_fix_t fix = trace_fix(drift_e, drift_n, 4.0 + 0.5 * gauss(), t);
+        accepted += gps_filter_process(&filter, &fix) == FILTER_ACCEPT;
+        if (stopped_at < 0 && gps_filter_get_state(&filter) == FILTER_STATE_STOPPED) stopped_at = i;
+    }
+    TEST_ASSERT_TRUE(stopped_at >= 0 && stopped_at <= GPS_FILTER_WINDOW + 5);
+    TEST_ASSERT_EQUAL_INT(FILTER_STATE_STOPPED, gps_filter_get_state(&filter));
+    TEST_ASSERT_TRUE(accepted <= stopped_at + 1);
+}
+
+/* Helper: gps_filter_dump() lines, newline-joined */
+static char dump_text[4096];
+static size_t dump_len;
+static int dump_lines;
+
+static void collect_line(const char* line, size_t len, void* user) {
+    (void)user;
+    TEST_ASSERT_TRUE(dump_len + len + 1 < sizeof(dump_text));
+    TEST_ASSERT_EQUAL_size_t(strlen(line), len);
+    memcpy(dump_text + dump_len, line, len);
+    dump_len += len;
+    dump_text[dump_len++] = '\n';
+    dump_text[dump_len] = '\0';
+    dump_lines++;
+}
+
+/* T24: every result is counted; the trace keeps the newest masked
+   rejections, oldest first, measured against the gate's previous fix */
+void test_result_counters_and_trace(void) {
+    static gps_filter_trace_t trace;
+    gps_filter_set_trace(&filter, &trace, GPS_FILTER_TRACE_MASK(FILTER_REJECT_OUTLIER) |
+                                          GPS_FILTER_TRACE_MASK(FILTER_REJECT_NO_TIME_DELTA));
+    gps_fix_t fix;
+    memset(&fix, 0, sizeof(fix));
+    TEST_ASSERT_EQUAL_INT(FILTER_REJECT_INVALID, gps_filter_process(&filter, &fix));
+    fix = make_fix(47.0, 8.0, 1.0f, 10, 0, 0);
+    TEST_ASSERT_EQUAL_INT(FILTER_REJECT_STATIONARY, gps_filter_process(&filter, &fix));
+    fix = make_fix(47.0, 8.0, 50.0f, 10, 0, 1);
+    TEST_ASSERT_EQUAL_INT(FILTER_ACCEPT, gps_filter_process(&filter, &fix));
+    fix = make_fix(47.0001, 8.0, 50.0f, 10, 0, 2);
+    TEST_ASSERT_EQUAL_INT(FILTER_ACCEPT, gps_filter_process(&filter, &fix));
+    const int outliers = GPS_FILTER_TRACE_DEPTH + 3;
+    for (int k = 0; k < outliers; k++) {
+        fix = make_fix(48.0, 8.0, 50.0f, 10, 0, (uint8_t)(3 + k));
+        TEST_ASSERT_EQUAL_INT(FILTER_REJECT_OUTLIER, gps_filter_process(&filter, &fix));
+    }
+    fix = make_fix(47.0001, 8.0, 50.0f, 10, 0, 2);
+    TEST_ASSERT_EQUAL_INT(FILTER_REJECT_NO_TIME_DELTA, gps_filter_process(&filter, &fix));
+
+    TEST_ASSERT_EQUAL_UINT32(2, filter.results[FILTER_ACCEPT]);
+    TEST_ASSERT_EQUAL_UINT32(1, filter.results[FILTER_REJECT_INVALID]);
+    TEST_ASSERT_EQUAL_UINT32(1, filter.results[FILTER_REJECT_STATIONARY]);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)outliers, filter.results[FILTER_REJECT_OUTLIER]);
+    TEST_ASSERT_EQUAL_UINT32(1, filter.results[FILTER_REJECT_NO_TIME_DELTA]);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)outliers + 1, trace.total);
+
+    /* Oldest kept: outlier k = 4, 5 s after the fix at :02 */
+    const gps_filter_reject_t* oldest = &trace.entries[trace.total % GPS_FILTER_TRACE_DEPTH];
+    TEST_ASSERT_EQUAL_INT(FILTER_REJECT_OUTLIER, oldest->result);
+    TEST_ASSERT_EQUAL_INT32(5000, oldest->dt_ms);
+    TEST_ASSERT_EQUAL_INT32(48000000, oldest->lat_e6);
+    TEST_ASSERT_EQUAL_UINT16(5000, oldest->speed_ckmh);
+    double expect_kmh = haversine_distance_m(47.0001, 8.0, 48.0, 8.0) * 3.6 / 5.0;
+    TEST_ASSERT_TRUE(fabs(oldest->implied_kmh - expect_kmh) < expect_kmh * 1e-3);
+
+    dump_len = 0;
+    dump_lines = 0;
+    gps_filter_dump(&filter, collect_line, NULL);
+    TEST_ASSERT_EQUAL_INT(2 + GPS_FILTER_TRACE_DEPTH, dump_lines);
+    char expect[160];
+    snprintf(expect, sizeof(expect), "filter_results accept=2 invalid=1 stationary=1 "
+             "outlier=%d no_time_delta=1 policy=0\n", outliers);
+    TEST_ASSERT_EQUAL_INT(0, strncmp(dump_text, expect, strlen(expect)));
+    TEST_ASSERT_NOT_NULL(strstr(dump_text, "\n36007000,outlier,48.000000,8.000000,50.00,"));
+    TEST_ASSERT_NOT_NULL(strstr(dump_text, "\n36002000,no_time_delta,47.000100,8.000000,50.00,0.0,0\n"));
+    TEST_ASSERT_NULL(strstr(dump_text, "\n36006000,"));
+
+    /* A policy skip is measured against the fix before it, not itself */
+    static const gps_filter_policy_t every_5s = { 0.0f, 0.0f, 5000 };
+    gps_filter_init(&filter);
+    gps_filter_set_policy(&filter, &every_5s);
+    gps_filter_set_trace(&filter, &trace, GPS_FILTER_TRACE_MASK(FILTER_REJECT_POLICY));
+    TEST_ASSERT_EQUAL_UINT32(0, trace.total);
+    fix = make_fix(47.0, 8.0, 36.0f, 10, 0, 0);
+    gps_filter_process(&filter, &fix);
+    fix = make_fix(47.00009, 8.0, 36.0f, 10, 0, 1);
+    TEST_ASSERT_EQUAL_INT(FILTER_REJECT_POLICY, gps_filter_process(&filter, &fix));
+    TEST_ASSERT_EQUAL_UINT32(1, trace.total);
+    TEST_ASSERT_EQUAL_INT32(1000, trace.entries[0].dt_ms);
+    TEST_ASSERT_TRUE(fabsf(trace.entries[0].implied_kmh - 36.0f) < 0.5f);
+
+    /* Without a trace only the counters line is written */
+    gps_filter_set_trace(&filter, NULL, 0);
+    dump_len = 0;
+    dump_lines = 0;
+    gps_filter_dump(&filter, collect_line, NULL);
+    TEST_ASSERT_EQUAL_INT(1, dump_lines);
+    TEST_ASSERT_EQUAL_STRING("policy", gps_filter_result_name(FILTER_REJECT_POLICY));
+
+    /* Every counter at its widest still fits the line */
+    for (int r = 0; r < GPS_FILTER_RESULT_COUNT; r++) filter.results[r] = UINT32_MAX;
+    dump_len = 0;
+    gps_filter_dump(&filter, collect_line, NULL);
+    TEST_ASSERT_EQUAL_STRING("filter_results accept=4294967295 invalid=4294967295 "
+                             "stationary=4294967295 outlier=4294967295 "
+                             "no_time_delta=4294967295 policy=4294967295\n", dump_text);
+    TEST_ASSERT_TRUE(dump_len - 1 < GPS_FILTER_DUMP_LINE_MAX);
+}
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_reject_invalid_fix);
@@ -210,5 +667,13 @@ int main(void) {
     RUN_TEST(test_reject_zero_time_delta);
     RUN_TEST(test_missing_speed_stationary);
     RUN_TEST(test_realistic_driving_sequence);
+    RUN_TEST(test_packed_fix_input);
+    RUN_TEST(test_speed_gate_across_date_boundaries);
+    RUN_TEST(test_logging_policy_triggers);
+    RUN_TEST(test_logging_policy_city_trace);
+    RUN_TEST(test_logging_policy_highway_trace);
+    RUN_TEST(test_parked_drift_transitions);
+    RUN_TEST(test_parked_drift_never_slow);
+    RUN_TEST(test_result_counters_and_trace);
     return UNITY_END();
 }
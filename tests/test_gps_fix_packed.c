@@ -0,0 +1,134 @@
+#include "unity.h"
+#include "gps_fix_packed.h"
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+void setUp(void) { }
+
+void tearDown(void) { }
+
+/* Helper: fix fields at data_storage's CSV precision */
+static void format_logged(const gps_fix_t* f, char* out, size_t size) {
+    snprintf(out, size, "%04u-%02u-%02uT%02u:%02u:%02uZ,%.6f,%.6f,%.2f,%.1f,%.1f,%u,%.2f,%u",
+             f->year, f->month, f->day, f->hour, f->minute, f->second,
+             f->latitude, f->longitude, (double)f->speed_kmh, (double)f->altitude_m,
+             (double)f->course_deg, f->satellites, (double)f->hdop, f->fix_quality);
+}
+
+static gps_fix_t make_reference_fix(void) {
+    gps_fix_t fix;
+    memset(&fix, 0, sizeof(fix));
+    fix.flags = GPS_FIX_VALID | GPS_HAS_ALL;
+    fix.year = 2002; fix.month = 12; fix.day = 9;
+    fix.hour = 9; fix.minute = 27; fix.second = 25; fix.centisecond = 50;
+    fix.latitude = 47.2852332;
+    fix.longitude = -8.5652650;
+    fix.altitude_m = 499.6f;
+    fix.speed_kmh = 10.0f;
+    fix.course_deg = 77.52f;
+    fix.hdop = 1.01f;
+    fix.satellites = 8;
+    fix.fix_quality = 2;
+    fix.unix_ms = gps_fix_unix_ms(&fix, NULL);
+    return fix;
+}
+
+/* T1: 24 bytes or less, every field survives at its stored precision */
+void test_packed_size_and_fields(void) {
+    TEST_ASSERT_TRUE(sizeof(gps_fix_packed_t) <= 24);
+    TEST_ASSERT_TRUE(sizeof(gps_fix_packed_t) * 2 <= sizeof(gps_fix_t));
+
+    gps_fix_t fix = make_reference_fix(), out;
+    gps_fix_packed_t p;
+    gps_fix_pack(&fix, &p);
+    TEST_ASSERT_EQUAL_INT32(47285233, p.lat_e6);
+    TEST_ASSERT_EQUAL_INT32(-8565265, p.lon_e6);
+    TEST_ASSERT_EQUAL_INT32(4996, p.altitude_dm);
+    TEST_ASSERT_EQUAL_UINT32(((9u * 60 + 27) * 60 + 25) * 100 + 50, p.time_cs);
+    TEST_ASSERT_EQUAL_UINT16(775, p.course_ddeg);
+    TEST_ASSERT_EQUAL_UINT16(101, p.hdop_c);
+
+    gps_fix_unpack(&p, &out);
+    TEST_ASSERT_EQUAL_HEX32(fix.flags, out.flags);
+    TEST_ASSERT_EQUAL_UINT16(2002, out.year);
+    TEST_ASSERT_EQUAL_UINT8(12, out.month);
+    TEST_ASSERT_EQUAL_UINT8(9, out.day);
+    TEST_ASSERT_EQUAL_UINT8(9, out.hour);
+    TEST_ASSERT_EQUAL_UINT8(27, out.minute);
+    TEST_ASSERT_EQUAL_UINT8(25, out.second);
+    TEST_ASSERT_EQUAL_UINT8(50, out.centisecond);
+    TEST_ASSERT_TRUE(out.latitude == 47.285233);
+    TEST_ASSERT_TRUE(out.longitude == -8.565265);
+    TEST_ASSERT_TRUE(fabsf(out.hdop - 1.01f) < 1e-6f);
+    TEST_ASSERT_EQUAL_UINT8(8, out.satellites);
+    TEST_ASSERT_EQUAL_UINT8(2, out.fix_quality);
+}
+
+/* T2: pack/unpack never changes a logged CSV row */
+void test_packed_logged_precision_sweep(void) {
+    uint32_t seed = 12345;
+    char a[160], b[160];
+    for (int i = 0; i < 20000; i++) {
+        gps_fix_t fix = make_reference_fix(), out;
+        seed = seed * 1664525u + 1013904223u;
+        fix.latitude = ((double)seed / 4294967296.0) * 180.0 - 90.0;
+        seed = seed * 1664525u + 1013904223u;
+        fix.longitude = ((double)seed / 4294967296.0) * 360.0 - 180.0;
+        seed = seed * 1664525u + 1013904223u;
+        fix.altitude_m = (float)(seed % 9000000) / 1000.0f - 500.0f;  /* UBX: mm */
+        fix.speed_kmh = (float)(seed % 180000) * 0.0036f;     /* UBX: mm/s */
+        fix.course_deg = (float)(seed % 36000) / 100.0f;
+        fix.hdop = (float)(seed % 9999) / 100.0f;
+        fix.satellites = (uint8_t)(seed % 40);
+        fix.second = (uint8_t)(seed % 60);
+        fix.centisecond = (uint8_t)(seed % 100);
+        fix.year = (uint16_t)(1971 + seed % 178);
+        fix.month = (uint8_t)(1 + seed % 12);
+        fix.day = (uint8_t)(1 + seed % 28);
+        fix.unix_ms = gps_fix_unix_ms(&fix, NULL);
+
+        gps_fix_packed_t p;
+        gps_fix_pack(&fix, &p);
+        gps_fix_unpack(&p, &out);
+        format_logged(&fix, a, sizeof(a));
+        format_logged(&out, b, sizeof(b));
+        TEST_ASSERT_EQUAL_STRING(a, b);
+        TEST_ASSERT_TRUE(out.unix_ms == fix.unix_ms);
+    }
+}
+
+/* T3: out-of-range values saturate, unflagged fields stay zero */
+void test_packed_saturation(void) {
+    gps_fix_t fix = make_reference_fix(), out;
+    gps_fix_packed_t p;
+    fix.hdop = 700.0f;
+    fix.speed_kmh = 1000.0f;
+    fix.altitude_m = -1000000.0f;
+    fix.year = 2150;
+    fix.unix_ms = gps_fix_unix_ms(&fix, NULL);
+    gps_fix_pack(&fix, &p);
+    gps_fix_unpack(&p, &out);
+    TEST_ASSERT_TRUE(fabsf(out.hdop - 655.35f) < 1e-3f);
+    TEST_ASSERT_TRUE(fabsf(out.speed_kmh - 655.35f) < 1e-3f);
+    TEST_ASSERT_TRUE(out.altitude_m < -838000.0f);
+    TEST_ASSERT_FALSE(out.flags & GPS_HAS_DATE);
+    TEST_ASSERT_EQUAL_UINT16(0, out.year);
+
+    fix = make_reference_fix();
+    fix.flags = GPS_HAS_TIME;
+    gps_fix_pack(&fix, &p);
+    TEST_ASSERT_EQUAL_INT32(0, p.lat_e6);
+    TEST_ASSERT_EQUAL_INT32(0, p.altitude_dm);
+    TEST_ASSERT_EQUAL_UINT16(0, p.speed_ckmh);
+    TEST_ASSERT_EQUAL_UINT16(0, p.date);
+    TEST_ASSERT_EQUAL_UINT32(GPS_HAS_TIME, p.flags);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_packed_size_and_fields);
+    RUN_TEST(test_packed_logged_precision_sweep);
+    RUN_TEST(test_packed_saturation);
+    return UNITY_END();
+}
@@ -0,0 +1,237 @@
+#include "unity.h"
+#include "gps_kalman.h"
+#include "gps_filter.h"
+#include <string.h>
+#include <math.h>
+
+/* Built with GPS_FILTER_KALMAN=1 (tests/CMakeLists.txt) */
+
+#define LAT0        47.285233
+#define LON0        8.565265
+#define M_PER_DEG   111194.93
+#define T0_MS       1700000000000ull
+
+static gps_kalman_t kf;
+static uint64_t rng;
+
+void setUp(void) {
+    gps_kalman_init(&kf);
+    rng = 88172645463325252ull;
+}
+
+void tearDown(void) { }
+
+/* Helper: standard normal via Box-Muller on xorshift64 */
+static double uniform(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return ((double)(rng >> 11) + 0.5) / 9007199254740992.0;
+}
+
+static double gauss(void) {
+    return sqrt(-2.0 * log(uniform())) * cos(6.283185307179586 * uniform());
+}
+
+/* Helper: local east/north metres around (LAT0, LON0) to micro-degrees */
+static int32_t lat_e6_of(double north) {
+    return (int32_t)lrint((LAT0 + north / M_PER_DEG) * 1e6);
+}
+
+static int32_t lon_e6_of(double east) {
+    return (int32_t)lrint((LON0 + east / (M_PER_DEG * cos(LAT0 * 0.017453292519943295))) * 1e6);
+}
+
+static double error_m(int32_t lat_e6, int32_t lon_e6, double east, double north) {
+    return haversine_distance_m(lat_e6 / 1e6, lon_e6 / 1e6,
+                                lat_e6_of(north) / 1e6, lon_e6_of(east) / 1e6);
+}
+
+/* Truth at t seconds: 200 s east at 10 m/s, a 90 deg left turn on a 200 m
+   radius (0.5 m/s^2), then north */
+static void truth(double t, double* east, double* north) {
+    const double v = 10.0, r = 200.0, t_turn = 3.141592653589793 * r / 2.0 / v;
+    if (t < 200.0) {
+        *east = v * t;
+        *north = 0.0;
+    } else if (t < 200.0 + t_turn) {
+        double a = (t - 200.0) * v / r;
+        *east = 2000.0 + r * sin(a);
+        *north = r * (1.0 - cos(a));
+    } else {
+        *east = 2000.0 + r;
+        *north = r + v * (t - 200.0 - t_turn);
+    }
+}
+
+/* T1: first fix seeds, a repeated timestamp changes nothing */
+void test_kalman_seed_and_stale(void) {
+    int32_t lat, lon;
+    TEST_ASSERT_EQUAL_INT(GPS_KALMAN_SEEDED, gps_kalman_step(&kf, 47285233, 8565265, 1.0f, T0_MS));
+    TEST_ASSERT_EQUAL_INT(GPS_KALMAN_STALE, gps_kalman_step(&kf, 47285300, 8565265, 1.0f, T0_MS));
+    gps_kalman_position(&kf, &lat, &lon);
+    TEST_ASSERT_EQUAL_INT32(47285233, lat);
+    TEST_ASSERT_EQUAL_INT32(8565265, lon);
+    TEST_ASSERT_EQUAL_INT(GPS_KALMAN_UPDATED, gps_kalman_step(&kf, 47285243, 8565265, 0.0f, T0_MS + 1000));
+    TEST_ASSERT_TRUE(sizeof(gps_kalman_t) <= 64);
+}
+
+/* T2: 3 m noise on a drive with a turn: the estimate is inside the noise,
+   speed is close, the gate rarely fires on good fixes */
+void test_kalman_reduces_jitter(void) {
+    double raw2 = 0.0, est2 = 0.0;
+    int n = 0, rejected = 0;
+    for (int t = 0; t < 600; t++) {
+        double e, nn;
+        truth(t, &e, &nn);
+        int32_t lat = lat_e6_of(nn + 3.0 * gauss()), lon = lon_e6_of(e + 3.0 * gauss());
+        if (gps_kalman_step(&kf, lat, lon, 1.0f, T0_MS + (uint64_t)t * 1000) == GPS_KALMAN_REJECTED) {
+            rejected++;
+        }
+        if (t < 30) continue;
+        int32_t elat, elon;
+        gps_kalman_position(&kf, &elat, &elon);
+        double re = error_m(lat, lon, e, nn), ee = error_m(elat, elon, e, nn);
+        raw2 += re * re;
+        est2 += ee * ee;
+        n++;
+    }
+    TEST_ASSERT_TRUE(sqrt(est2 / n) < 0.75 * sqrt(raw2 / n));
+    TEST_ASSERT_TRUE(fabsf(gps_kalman_speed_mps(&kf) - 10.0f) < 2.0f);
+    TEST_ASSERT_TRUE(rejected <= 3);
+}
+
+/* T3: 150 m spikes are rejected; state is only predicted through them */
+void test_kalman_rejects_outliers(void) {
+    int caught = 0, spikes = 0, false_rejects = 0;
+    for (int t = 0; t < 600; t++) {
+        double e, nn;
+        truth(t, &e, &nn);
+        bool spike = t > 10 && t % 37 == 0;
+        double off = spike ? 150.0 : 0.0;
+        gps_kalman_result_t r = gps_kalman_step(&kf, lat_e6_of(nn + 3.0 * gauss() + off),
+                                                lon_e6_of(e + 3.0 * gauss() - off), 1.5f,
+                                                T0_MS + (uint64_t)t * 1000);
+        if (spike) {
+            spikes++;
+            caught += r == GPS_KALMAN_REJECTED;
+        } else {
+            false_rejects += r == GPS_KALMAN_REJECTED;
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(spikes, caught);
+    TEST_ASSERT_TRUE(false_rejects <= 3);
+}
+
+/* T4: a bad fix after a 2-minute gap is taken (the gate is wide after the
+   gap), but good fixes re-seed the filter (RESEEDED, once) within
+   GPS_KALMAN_MAX_REJECTS */
+void test_kalman_recovers_from_bad_fix_after_gap(void) {
+    int t;
+    for (t = 0; t < 150; t++) {
+        double e, nn;
+        truth(t, &e, &nn);
+        gps_kalman_step(&kf, lat_e6_of(nn + 3.0 * gauss()), lon_e6_of(e + 3.0 * gauss()),
+                        1.0f, T0_MS + (uint64_t)t * 1000);
+    }
+    t += 120;
+    double e, nn;
+    truth(t, &e, &nn);
+    gps_kalman_step(&kf, lat_e6_of(nn + 1500.0), lon_e6_of(e + 1500.0), 1.0f, T0_MS + (uint64_t)t * 1000);
+
+    int32_t lat, lon;
+    int reseeds = 0;
+    for (int k = 1; k <= 30; k++) {
+        truth(t + k, &e, &nn);
+        reseeds += gps_kalman_step(&kf, lat_e6_of(nn + 3.0 * gauss()), lon_e6_of(e + 3.0 * gauss()),
+                                   1.0f, T0_MS + (uint64_t)(t + k) * 1000) == GPS_KALMAN_RESEEDED;
+        gps_kalman_position(&kf, &lat, &lon);
+        if (k > GPS_KALMAN_MAX_REJECTS + 2) TEST_ASSERT_TRUE(error_m(lat, lon, e, nn) < 15.0);
+    }
+    TEST_ASSERT_EQUAL_INT(1, reseeds);
+}
+
+/* T5: 30 km at 30 m/s: the tangent plane re-origins and stays accurate */
+void test_kalman_reorigin_long_drive(void) {
+    int32_t lat, lon;
+    double worst = 0.0;
+    for (int t = 0; t < 1000; t++) {
+        double nn = 30.0 * t, e = 10.0 * t;
+        gps_kalman_step(&kf, lat_e6_of(nn + 3.0 * gauss()), lon_e6_of(e + 3.0 * gauss()),
+                        1.0f, T0_MS + (uint64_t)t * 1000);
+        gps_kalman_position(&kf, &lat, &lon);
+        if (t >= 30 && error_m(lat, lon, e, nn) > worst) worst = error_m(lat, lon, e, nn);
+    }
+    TEST_ASSERT_TRUE(kf.origin_lat_e6 > lat_e6_of(25000.0));
+    TEST_ASSERT_TRUE(worst < 10.0);
+    TEST_ASSERT_TRUE(fabsf(gps_kalman_speed_mps(&kf) - 31.62f) < 1.0f);
+}
+
+/* Truth for the filter test: parked until t = 0, 2 m/s^2 to 10 m/s, cruise east */
+static double drive_east(double t) {
+    if (t <= 0.0) return 0.0;
+    if (t < 5.0) return t * t;
+    return 25.0 + 10.0 * (t - 5.0);
+}
+
+/* Helper: filter input at t seconds with noise and HDOP */
+static gps_fix_t make_fix(double east, double north, float speed_kmh, float hdop, int t) {
+    gps_fix_t fix;
+    memset(&fix, 0, sizeof(fix));
+    fix.flags = GPS_FIX_VALID | GPS_HAS_LATLON | GPS_HAS_SPEED | GPS_HAS_TIME | GPS_HAS_DATE | GPS_HAS_HDOP;
+    fix.latitude = lat_e6_of(north) / 1e6;
+    fix.longitude = lon_e6_of(east) / 1e6;
+    fix.speed_kmh = speed_kmh;
+    fix.hdop = hdop;
+    fix.unix_ms = T0_MS + (uint64_t)t * 1000;
+    return fix;
+}
+
+/* T6: in the filter, spikes the speed gate would pass (under 250 km/h) are
+   rejected, stationary logic is unchanged and smoothing beats the raw fix */
+void test_filter_kalman_mode(void) {
+    gps_filter_t filter;
+    gps_filter_init(&filter);
+    int accepted = 0, outliers = 0, spikes = 0;
+    double raw2 = 0.0, est2 = 0.0;
+    for (int t = 0; t < 400; t++) {
+        double e = drive_east(t - 20), nn = 0.0;
+        bool stopped = t < 21;
+        bool spike = t > 40 && t % 23 == 0;
+        double off = spike ? 60.0 : 0.0;       /* 216 km/h implied */
+        gps_fix_t fix = make_fix(e + 3.0 * gauss() + off, nn + 3.0 * gauss(),
+                                 stopped ? 1.0f : 36.0f, 1.0f, t);
+        gps_filter_result_t r = gps_filter_process(&filter, &fix);
+        spikes += spike;
+        outliers += r == FILTER_REJECT_OUTLIER;
+        if (r != FILTER_ACCEPT) continue;
+        accepted++;
+        if (t < 60) continue;
+        gps_fix_t smoothed = fix;
+        gps_filter_smooth(&filter, &smoothed);
+        double re = error_m((int32_t)lrint(fix.latitude * 1e6),
+                            (int32_t)lrint(fix.longitude * 1e6), e, nn);
+        double ee = error_m((int32_t)lrint(smoothed.latitude * 1e6),
+                            (int32_t)lrint(smoothed.longitude * 1e6), e, nn);
+        raw2 += re * re;
+        est2 += ee * ee;
+    }
+    TEST_ASSERT_TRUE(outliers >= spikes && outliers <= spikes + 3);
+    TEST_ASSERT_EQUAL_INT(379 - outliers, accepted);
+    TEST_ASSERT_TRUE(sqrt(est2) < 0.75 * sqrt(raw2));
+    TEST_ASSERT_EQUAL_INT(FILTER_STATE_MOVING, gps_filter_get_state(&filter));
+
+    gps_fix_t dup = make_fix(0.0, 0.0, 36.0f, 1.0f, 399);
+    TEST_ASSERT_EQUAL_INT(FILTER_REJECT_NO_TIME_DELTA, gps_filter_process(&filter, &dup));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_kalman_seed_and_stale);
+    RUN_TEST(test_kalman_reduces_jitter);
+    RUN_TEST(test_kalman_rejects_outliers);
+    RUN_TEST(test_kalman_recovers_from_bad_fix_after_gap);
+    RUN_TEST(test_kalman_reorigin_long_drive);
+    RUN_TEST(test_filter_kalman_mode);
+    return UNITY_END();
+}
@@ -0,0 +1,144 @@
+#include "unity.h"
+#include "gps_stream.h"
+#include <string.h>
+#include <stdio.h>
+
+static gps_stream_t* stream;
+
+typedef struct {
+    gps_fix_t fixes[8];
+    int count;
+} fix_sink_t;
+
+static fix_sink_t sink;
+
+void setUp(void) {
+    stream = gps_stream_create();
+    memset(&sink, 0, sizeof(sink));
+}
+
+void tearDown(void) {
+    gps_stream_destroy(stream);
+    stream = NULL;
+}
+
+static void collect_fix(const gps_fix_t* fix, void* user) {
+    fix_sink_t* s = (fix_sink_t*)user;
+    if (s->count < 8) s->fixes[s->count] = *fix;
+    s->count++;
+}
+
+/* Helper: appends "$body*HH\r\n" */
+static size_t put_sentence(uint8_t* out, size_t size, const char* body) {
+    uint8_t cs = 0;
+    for (const char* p = body; *p; p++) cs ^= (uint8_t)*p;
+    int n = snprintf((char*)out, size, "$%s*%02X\r\n", body, cs);
+    return (size_t)n;
+}
+
+/* Helper: NAV-PVT frame at 10:00:<second>, 3D fix */
+static size_t put_pvt(uint8_t* out, size_t size, uint8_t second) {
+    uint8_t p[UBX_NAV_PVT_LEN];
+    memset(p, 0, sizeof(p));
+    p[4] = 2002 & 0xFF;
+    p[5] = 2002 >> 8;
+    p[6] = 12;
+    p[7] = 9;
+    p[8] = 10;
+    p[10] = second;
+    p[11] = 0x07;
+    p[20] = 3;
+    p[21] = 0x01;
+    p[23] = 9;
+    p[28] = 0x6C; p[29] = 0x27; p[30] = 0x2F; p[31] = 0x1C;   /* lat 47.2852332 */
+    return ubx_frame_encode(UBX_CLASS_NAV, UBX_ID_NAV_PVT, p, sizeof(p), out, size);
+}
+
+static size_t put_nmea_epoch(uint8_t* out, size_t size, int second) {
+    char gga[128], rmc[128];
+    snprintf(gga, sizeof(gga), "GPGGA,1000%02d.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,", second);
+    snprintf(rmc, sizeof(rmc), "GPRMC,1000%02d.00,A,4717.11399,N,00833.91590,E,5.400,77.52,091202,,,A", second);
+    size_t n = put_sentence(out, size, gga);
+    n += put_sentence(out + n, size - n, rmc);
+    return n;
+}
+
+/* T1: plain NMEA stream is detected and parsed */
+void test_nmea_only(void) {
+    uint8_t buf[1024];
+    size_t n = 0;
+    for (int s = 0; s < 3; s++) n += put_nmea_epoch(buf + n, sizeof(buf) - n, s);
+
+    gps_stream_set_fix_callback(stream, collect_fix, &sink);
+    TEST_ASSERT_EQUAL_INT(GPS_PROTOCOL_NONE, gps_stream_protocol(stream));
+    TEST_ASSERT_EQUAL_INT(2, gps_stream_feed(stream, buf, n));
+    TEST_ASSERT_EQUAL_INT(GPS_PROTOCOL_NMEA, gps_stream_protocol(stream));
+    TEST_ASSERT_EQUAL_INT(2, sink.count);
+    TEST_ASSERT_EQUAL_UINT8(1, sink.fixes[1].second);
+}
+
+/* T2: plain UBX stream is detected and parsed */
+void test_ubx_only(void) {
+    uint8_t buf[1024];
+    size_t n = 0;
+    for (int s = 0; s < 3; s++) n += put_pvt(buf + n, sizeof(buf) - n, (uint8_t)s);
+
+    gps_stream_set_fix_callback(stream, collect_fix, &sink);
+    TEST_ASSERT_EQUAL_INT(3, gps_stream_feed(stream, buf, n));
+    TEST_ASSERT_EQUAL_INT(GPS_PROTOCOL_UBX, gps_stream_protocol(stream));
+    TEST_ASSERT_EQUAL_INT(3, sink.count);
+    TEST_ASSERT_TRUE(sink.fixes[0].flags & GPS_FIX_VALID);
+    TEST_ASSERT_FLOAT_WITHIN(0.000001, 47.285233, sink.fixes[0].latitude);
+}
+
+/* T3: mixed output switches to UBX and does not log epochs twice;
+   NMEA sentences around the frames are still parsed byte-exactly */
+void test_mixed_locks_to_ubx(void) {
+    uint8_t buf[2048];
+    size_t n = 0;
+    n += put_nmea_epoch(buf + n, sizeof(buf) - n, 0);
+    n += put_nmea_epoch(buf + n, sizeof(buf) - n, 1);      /* NMEA fix for :00 */
+    n += put_pvt(buf + n, sizeof(buf) - n, 1);             /* UBX fix for :01 */
+    n += put_nmea_epoch(buf + n, sizeof(buf) - n, 2);      /* NMEA :01 suppressed */
+    n += put_pvt(buf + n, sizeof(buf) - n, 2);
+
+    gps_stream_set_fix_callback(stream, collect_fix, &sink);
+    /* Byte-at-a-time exercises every frame/sentence boundary */
+    int total = 0;
+    for (size_t i = 0; i < n; i++) total += gps_stream_feed(stream, buf + i, 1);
+
+    TEST_ASSERT_EQUAL_INT(3, total);
+    TEST_ASSERT_EQUAL_INT(3, sink.count);
+    TEST_ASSERT_EQUAL_UINT8(0, sink.fixes[0].second);
+    TEST_ASSERT_EQUAL_UINT8(1, sink.fixes[1].second);
+    TEST_ASSERT_EQUAL_UINT8(9, sink.fixes[1].satellites);
+    TEST_ASSERT_EQUAL_UINT8(2, sink.fixes[2].second);
+    TEST_ASSERT_EQUAL_INT(GPS_PROTOCOL_UBX, gps_stream_protocol(stream));
+}
+
+/* T4: stray sync bytes do not break the NMEA path */
+void test_false_sync_in_nmea(void) {
+    uint8_t buf[1024];
+    size_t n = 0;
+    n += put_nmea_epoch(buf + n, sizeof(buf) - n, 0);
+    buf[n++] = UBX_SYNC_1;
+    buf[n++] = UBX_SYNC_1;
+    n += put_nmea_epoch(buf + n, sizeof(buf) - n, 1);
+    buf[n++] = UBX_SYNC_1;
+    n += put_nmea_epoch(buf + n, sizeof(buf) - n, 2);
+
+    gps_stream_set_fix_callback(stream, collect_fix, &sink);
+    TEST_ASSERT_EQUAL_INT(2, gps_stream_feed(stream, buf, n));
+    TEST_ASSERT_EQUAL_INT(GPS_PROTOCOL_NMEA, gps_stream_protocol(stream));
+    TEST_ASSERT_NOT_NULL(gps_stream_nmea(stream));
+    TEST_ASSERT_EQUAL_INT(-1, gps_stream_feed(NULL, buf, n));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_nmea_only);
+    RUN_TEST(test_ubx_only);
+    RUN_TEST(test_mixed_locks_to_ubx);
+    RUN_TEST(test_false_sync_in_nmea);
+    return UNITY_END();
+}
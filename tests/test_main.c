@@ -4,6 +4,11 @@
 extern void test_haversine_known_distance(void);
 extern void test_haversine_zero_distance(void);
 extern void test_haversine_antipodal(void);
+extern void test_haversine_float_short_range(void);
+extern void test_haversine_float_long_range(void);
+extern void test_distance_fast_property(void);
+extern void test_distance_batch_accuracy(void);
+extern void test_e6_delta_m(void);
 
 /* test_nmea_parser.c */
 extern void test_valid_gga_rmc_pair(void);
@@ -24,6 +29,39 @@ extern void test_mixed_talker_ids(void);
 extern void test_rmc_date_parsing(void);
 extern void test_sequential_fixes(void);
 extern void test_empty_position_fields(void);
+extern void test_crlf_lowercase_checksum(void);
+extern void test_oversized_sentence(void);
+extern void test_feed_bytes_chunk_boundaries(void);
+extern void test_feed_bytes_resync(void);
+extern void test_feed_bytes_null(void);
+extern void test_parse_buffer_resume(void);
+extern void test_parse_buffer_partial_line(void);
+extern void test_fixed_point_matches_strtod(void);
+extern void test_numeric_field_edge_cases(void);
+extern void test_builtin_vtg_gll_zda(void);
+extern void test_registered_handler(void);
+extern void test_feed_bytes_dispatch(void);
+extern void test_epoch_policy_latency(void);
+extern void test_epoch_policy_no_duplicate(void);
+extern void test_epoch_policy_timeout(void);
+extern void test_stats_drop_reasons(void);
+extern void test_stats_epochs_and_cycles(void);
+extern void test_epoch_policy_single_type(void);
+
+/* test_ubx_parser.c */
+extern void test_nav_pvt_decodes_fix(void);
+extern void test_bad_frame_checksum(void);
+extern void test_chunk_boundaries(void);
+extern void test_no_fix(void);
+extern void test_2d_fix_south_west(void);
+extern void test_skip_and_resync(void);
+extern void test_null_args(void);
+
+/* test_gps_stream.c */
+extern void test_nmea_only(void);
+extern void test_ubx_only(void);
+extern void test_mixed_locks_to_ubx(void);
+extern void test_false_sync_in_nmea(void);
 
 /* test_gps_filter.c */
 extern void test_reject_invalid_fix(void);
@@ -39,6 +77,21 @@ extern void test_speed_gate_skipped_first(void);
 extern void test_reject_zero_time_delta(void);
 extern void test_missing_speed_stationary(void);
 extern void test_realistic_driving_sequence(void);
+extern void test_packed_fix_input(void);
+extern void test_speed_gate_across_date_boundaries(void);
+extern void test_logging_policy_triggers(void);
+extern void test_logging_policy_city_trace(void);
+extern void test_logging_policy_highway_trace(void);
+extern void test_parked_drift_transitions(void);
+extern void test_parked_drift_never_slow(void);
+extern void test_result_counters_and_trace(void);
+
+/* test_track_simplify.c */
+extern void test_simplify_first_fix_and_flush(void);
+extern void test_simplify_window_bounds_latency(void);
+extern void test_simplify_motorway_drive(void);
+extern void test_simplify_city_drive(void);
+extern void test_simplify_poll_bounds_hold_time(void);
 
 /* test_data_storage.c */
 extern void test_fresh_start_creates_file(void);
@@ -56,6 +109,39 @@ extern void test_max_files_error(void);
 extern void test_csv_header_content(void);
 extern void test_timestamp_format(void);
 extern void test_coordinate_precision(void);
+extern void test_write_packed_fix(void);
+extern void test_write_comment_trailer(void);
+extern void test_write_coalescing(void);
+extern void test_binary_format_matches_csv(void);
+extern void test_scan_counts_fs_calls(void);
+extern void test_prealloc_truncated(void);
+extern void test_poll_syncs_without_writes(void);
+extern void test_recovery_keeps_zero_bytes(void);
+extern void test_prealloc_renewed(void);
+extern void test_bin_end_record_checked(void);
+extern void test_init_failure_releases_file(void);
+extern void test_shutdown_write_failure_keeps_dirty(void);
+
+/* test_csv_row.c */
+extern void test_format_known_row(void);
+extern void test_format_ties_and_edges(void);
+extern void test_format_matches_snprintf(void);
+
+/* test_track_bin.c */
+extern void test_bin_header_and_keyframe(void);
+extern void test_bin_round_trip_drive(void);
+extern void test_bin_comment_end_and_truncation(void);
+extern void test_bin_resync_after_damage(void);
+
+/* test_gps_fix_packed.c */
+extern void test_packed_size_and_fields(void);
+extern void test_packed_logged_precision_sweep(void);
+extern void test_packed_saturation(void);
+
+/* test_time_utils.c */
+extern void test_days_from_civil_known_dates(void);
+extern void test_civil_days_round_trip(void);
+extern void test_fix_unix_ms(void);
 
 /* test_power_mgmt.c */
 extern void test_initial_no_shutdown(void);
@@ -74,6 +160,11 @@ int main(void) {
     RUN_TEST(test_haversine_known_distance);
     RUN_TEST(test_haversine_zero_distance);
     RUN_TEST(test_haversine_antipodal);
+    RUN_TEST(test_haversine_float_short_range);
+    RUN_TEST(test_haversine_float_long_range);
+    RUN_TEST(test_distance_fast_property);
+    RUN_TEST(test_distance_batch_accuracy);
+    RUN_TEST(test_e6_delta_m);
 
     /* NMEA Parser */
     RUN_TEST(test_valid_gga_rmc_pair);
@@ -94,6 +185,39 @@ int main(void) {
     RUN_TEST(test_rmc_date_parsing);
     RUN_TEST(test_sequential_fixes);
     RUN_TEST(test_empty_position_fields);
+    RUN_TEST(test_crlf_lowercase_checksum);
+    RUN_TEST(test_oversized_sentence);
+    RUN_TEST(test_feed_bytes_chunk_boundaries);
+    RUN_TEST(test_feed_bytes_resync);
+    RUN_TEST(test_feed_bytes_null);
+    RUN_TEST(test_parse_buffer_resume);
+    RUN_TEST(test_parse_buffer_partial_line);
+    RUN_TEST(test_fixed_point_matches_strtod);
+    RUN_TEST(test_numeric_field_edge_cases);
+    RUN_TEST(test_builtin_vtg_gll_zda);
+    RUN_TEST(test_registered_handler);
+    RUN_TEST(test_feed_bytes_dispatch);
+    RUN_TEST(test_epoch_policy_latency);
+    RUN_TEST(test_epoch_policy_no_duplicate);
+    RUN_TEST(test_epoch_policy_timeout);
+    RUN_TEST(test_stats_drop_reasons);
+    RUN_TEST(test_stats_epochs_and_cycles);
+    RUN_TEST(test_epoch_policy_single_type);
+
+    /* UBX Parser */
+    RUN_TEST(test_nav_pvt_decodes_fix);
+    RUN_TEST(test_bad_frame_checksum);
+    RUN_TEST(test_chunk_boundaries);
+    RUN_TEST(test_no_fix);
+    RUN_TEST(test_2d_fix_south_west);
+    RUN_TEST(test_skip_and_resync);
+    RUN_TEST(test_null_args);
+
+    /* GPS Stream */
+    RUN_TEST(test_nmea_only);
+    RUN_TEST(test_ubx_only);
+    RUN_TEST(test_mixed_locks_to_ubx);
+    RUN_TEST(test_false_sync_in_nmea);
 
     /* GPS Filter */
     RUN_TEST(test_reject_invalid_fix);
@@ -109,6 +233,21 @@ int main(void) {
     RUN_TEST(test_reject_zero_time_delta);
     RUN_TEST(test_missing_speed_stationary);
     RUN_TEST(test_realistic_driving_sequence);
+    RUN_TEST(test_packed_fix_input);
+    RUN_TEST(test_speed_gate_across_date_boundaries);
+    RUN_TEST(test_logging_policy_triggers);
+    RUN_TEST(test_logging_policy_city_trace);
+    RUN_TEST(test_logging_policy_highway_trace);
+    RUN_TEST(test_parked_drift_transitions);
+    RUN_TEST(test_parked_drift_never_slow);
+    RUN_TEST(test_result_counters_and_trace);
+
+    /* Track Simplification */
+    RUN_TEST(test_simplify_first_fix_and_flush);
+    RUN_TEST(test_simplify_window_bounds_latency);
+    RUN_TEST(test_simplify_motorway_drive);
+    RUN_TEST(test_simplify_city_drive);
+    RUN_TEST(test_simplify_poll_bounds_hold_time);
 
     /* Data Storage */
     RUN_TEST(test_fresh_start_creates_file);
@@ -126,6 +265,39 @@ int main(void) {
     RUN_TEST(test_csv_header_content);
     RUN_TEST(test_timestamp_format);
     RUN_TEST(test_coordinate_precision);
+    RUN_TEST(test_write_packed_fix);
+    RUN_TEST(test_write_comment_trailer);
+    RUN_TEST(test_write_coalescing);
+    RUN_TEST(test_binary_format_matches_csv);
+    RUN_TEST(test_scan_counts_fs_calls);
+    RUN_TEST(test_prealloc_truncated);
+    RUN_TEST(test_poll_syncs_without_writes);
+    RUN_TEST(test_recovery_keeps_zero_bytes);
+    RUN_TEST(test_prealloc_renewed);
+    RUN_TEST(test_bin_end_record_checked);
+    RUN_TEST(test_init_failure_releases_file);
+    RUN_TEST(test_shutdown_write_failure_keeps_dirty);
+
+    /* CSV Row */
+    RUN_TEST(test_format_known_row);
+    RUN_TEST(test_format_ties_and_edges);
+    RUN_TEST(test_format_matches_snprintf);
+
+    /* Binary Track Records */
+    RUN_TEST(test_bin_header_and_keyframe);
+    RUN_TEST(test_bin_round_trip_drive);
+    RUN_TEST(test_bin_comment_end_and_truncation);
+    RUN_TEST(test_bin_resync_after_damage);
+
+    /* Packed Fix */
+    RUN_TEST(test_packed_size_and_fields);
+    RUN_TEST(test_packed_logged_precision_sweep);
+    RUN_TEST(test_packed_saturation);
+
+    /* Time Utils */
+    RUN_TEST(test_days_from_civil_known_dates);
+    RUN_TEST(test_civil_days_round_trip);
+    RUN_TEST(test_fix_unix_ms);
 
     /* Power Management */
     RUN_TEST(test_initial_no_shutdown);
@@ -2,6 +2,9 @@
 #include "nmea_parser.h"
 #include <string.h>
 #include <math.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
 
 static nmea_parser_t* parser;
 
@@ -227,6 +230,7 @@ void test_rmc_date_parsing(void) {
     TEST_ASSERT_EQUAL_UINT8(9, fix.day);
     TEST_ASSERT_EQUAL_UINT8(12, fix.month);
     TEST_ASSERT_EQUAL_UINT16(2002, fix.year);
+    TEST_ASSERT_TRUE(fix.unix_ms == 1039449600000ull);      /* 2002-12-09T16:00:00Z */
 }
 
 /* T17: sequential fixes */
@@ -279,6 +283,618 @@ void test_empty_position_fields(void) {
     TEST_ASSERT_FALSE(fix.flags & GPS_HAS_LATLON);
 }
 
+/* T19: CRLF terminator and lowercase checksum digits are accepted */
+void test_crlf_lowercase_checksum(void) {
+    char gga[128], trigger[128], line[132];
+    build_sentence(gga, sizeof(gga), "GPGGA,190000.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,");
+    build_sentence(trigger, sizeof(trigger), "GPGGA,190001.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,");
+
+    size_t n = strlen(gga);
+    gga[n - 2] = (char)tolower((unsigned char)gga[n - 2]);
+    gga[n - 1] = (char)tolower((unsigned char)gga[n - 1]);
+    snprintf(line, sizeof(line), "%s\r\n", gga);
+
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_NONE, nmea_parser_feed(parser, line));
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_FIX_READY, nmea_parser_feed(parser, trigger));
+
+    gps_fix_t fix;
+    TEST_ASSERT_TRUE(nmea_parser_get_fix(parser, &fix));
+    TEST_ASSERT_FLOAT_WITHIN(0.000001, 47.285233, fix.latitude);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 499.6, fix.altitude_m);
+}
+
+/* T20: sentence longer than NMEA_MAX_SENTENCE_LEN is rejected */
+void test_oversized_sentence(void) {
+    char body[128], line[160];
+    snprintf(body, sizeof(body), "GPGGA,200000.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,%s",
+             "000000000000000000000000000000");
+    build_sentence(line, sizeof(line), body);
+    TEST_ASSERT_TRUE(strlen(line) > NMEA_MAX_SENTENCE_LEN);
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_ERROR, nmea_parser_feed(parser, line));
+}
+
+/* Helper: collects fixes delivered through the fix callback */
+typedef struct {
+    gps_fix_t fixes[8];
+    int count;
+} fix_sink_t;
+
+static void collect_fix(const gps_fix_t* fix, void* user) {
+    fix_sink_t* sink = (fix_sink_t*)user;
+    if (sink->count < 8) sink->fixes[sink->count] = *fix;
+    sink->count++;
+}
+
+static size_t build_stream(char* out, size_t out_size) {
+    char gga1[128], rmc1[128], gga2[128], rmc2[128], gga3[128];
+    build_sentence(gga1, sizeof(gga1), "GPGGA,210000.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,");
+    build_sentence(rmc1, sizeof(rmc1), "GPRMC,210000.00,A,4717.11399,N,00833.91590,E,5.400,77.52,091202,,,A");
+    build_sentence(gga2, sizeof(gga2), "GPGGA,210001.00,4718.00000,N,00834.00000,E,1,08,1.01,500.0,M,48.0,M,,");
+    build_sentence(rmc2, sizeof(rmc2), "GPRMC,210001.00,A,4718.00000,N,00834.00000,E,10.0,80.00,091202,,,A");
+    build_sentence(gga3, sizeof(gga3), "GPGGA,210002.00,4719.00000,N,00835.00000,E,1,08,1.01,501.0,M,48.0,M,,");
+    int n = snprintf(out, out_size, "%s\r\n%s\r\n%s\r\n%s\r\n%s\r\n", gga1, rmc1, gga2, rmc2, gga3);
+    return (size_t)n;
+}
+
+/* T21: byte stream split at every possible chunk size yields the same fixes */
+void test_feed_bytes_chunk_boundaries(void) {
+    char stream[1024];
+    size_t len = build_stream(stream, sizeof(stream));
+
+    for (size_t chunk = 1; chunk <= len; chunk++) {
+        nmea_parser_t* p = nmea_parser_create();
+        fix_sink_t sink = {0};
+        nmea_parser_set_fix_callback(p, collect_fix, &sink);
+
+        int total = 0;
+        for (size_t off = 0; off < len; off += chunk) {
+            size_t n = (len - off < chunk) ? len - off : chunk;
+            total += nmea_parser_feed_bytes(p, (const uint8_t*)stream + off, n);
+        }
+        nmea_parser_destroy(p);
+
+        TEST_ASSERT_EQUAL_INT(2, total);
+        TEST_ASSERT_EQUAL_INT(2, sink.count);
+        TEST_ASSERT_TRUE(sink.fixes[0].flags & GPS_FIX_VALID);
+        TEST_ASSERT_FLOAT_WITHIN(0.000001, 47.285233, sink.fixes[0].latitude);
+        TEST_ASSERT_FLOAT_WITHIN(0.01, 10.00, sink.fixes[0].speed_kmh);
+        TEST_ASSERT_FLOAT_WITHIN(0.000001, 47.300000, sink.fixes[1].latitude);
+        TEST_ASSERT_EQUAL_UINT16(2002, sink.fixes[1].year);
+    }
+}
+
+/* T22: byte stream resynchronises on '$' after noise, bad checksums and overlong lines */
+void test_feed_bytes_resync(void) {
+    char good1[128], good2[128], corrupt[128], stream[1024];
+    build_sentence(good1, sizeof(good1), "GPGGA,220000.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,");
+    build_sentence(good2, sizeof(good2), "GPGGA,220001.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,");
+    build_sentence(corrupt, sizeof(corrupt), "GPGGA,220000.50,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,");
+    corrupt[10] = '9'; /* checksum no longer matches */
+
+    int n = snprintf(stream, sizeof(stream),
+                     "\xb5\x62garbage\r\n%s\r\n$GPGGA,truncated\r\n%s\r\n"
+                     "$GPTXT,0123456789012345678901234567890123456789012345678901234567890123456789012345\r\n"
+                     "%s\r\n",
+                     good1, corrupt, good2);
+
+    fix_sink_t sink = {0};
+    nmea_parser_set_fix_callback(parser, collect_fix, &sink);
+    TEST_ASSERT_EQUAL_INT(1, nmea_parser_feed_bytes(parser, (const uint8_t*)stream, (size_t)n));
+    TEST_ASSERT_EQUAL_INT(1, sink.count);
+    TEST_ASSERT_EQUAL_UINT8(0, sink.fixes[0].second);
+
+    /* The last completed fix is also available through the polling API */
+    gps_fix_t fix;
+    TEST_ASSERT_TRUE(nmea_parser_get_fix(parser, &fix));
+    TEST_ASSERT_EQUAL_UINT8(22, fix.hour);
+}
+
+/* T23: feed_bytes argument checks */
+void test_feed_bytes_null(void) {
+    uint8_t b = '$';
+    TEST_ASSERT_EQUAL_INT(-1, nmea_parser_feed_bytes(NULL, &b, 1));
+    TEST_ASSERT_EQUAL_INT(-1, nmea_parser_feed_bytes(parser, NULL, 1));
+    TEST_ASSERT_EQUAL_INT(0, nmea_parser_feed_bytes(parser, NULL, 0));
+}
+
+/* T24: bulk buffer parsing matches the stream parser and resumes at cap */
+void test_parse_buffer_resume(void) {
+    char stream[1024];
+    size_t len = build_stream(stream, sizeof(stream));
+
+    gps_fix_t out[4];
+    size_t consumed = 0;
+
+    /* Room for one fix: stops right after the sentence that completed it */
+    TEST_ASSERT_EQUAL_size_t(1, nmea_parser_parse_buffer(parser, stream, len, out, 1, &consumed));
+    TEST_ASSERT_TRUE(consumed > 0 && consumed < len);
+    TEST_ASSERT_EQUAL_UINT8(0, out[0].second);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 10.00, out[0].speed_kmh);
+
+    size_t rest = 0;
+    TEST_ASSERT_EQUAL_size_t(1, nmea_parser_parse_buffer(parser, stream + consumed, len - consumed,
+                                                         out, 4, &rest));
+    TEST_ASSERT_EQUAL_size_t(len - consumed, rest);
+    TEST_ASSERT_EQUAL_UINT8(1, out[0].second);
+    TEST_ASSERT_FLOAT_WITHIN(0.000001, 47.300000, out[0].latitude);
+}
+
+/* T25: trailing partial line is left unconsumed */
+void test_parse_buffer_partial_line(void) {
+    char stream[1024];
+    size_t len = build_stream(stream, sizeof(stream));
+    size_t cut = len - 10; /* inside the last sentence */
+
+    gps_fix_t out[4];
+    size_t consumed = 0;
+    TEST_ASSERT_EQUAL_size_t(1, nmea_parser_parse_buffer(parser, stream, cut, out, 4, &consumed));
+    TEST_ASSERT_TRUE(consumed < cut);
+    TEST_ASSERT_EQUAL_CHAR('$', stream[consumed]);
+
+    /* Resuming with the full remainder completes the second epoch */
+    size_t rest = 0;
+    TEST_ASSERT_EQUAL_size_t(1, nmea_parser_parse_buffer(parser, stream + consumed, len - consumed,
+                                                         out, 4, &rest));
+    TEST_ASSERT_EQUAL_size_t(len - consumed, rest);
+    TEST_ASSERT_EQUAL_size_t(0, nmea_parser_parse_buffer(NULL, stream, len, out, 4, &rest));
+    TEST_ASSERT_EQUAL_size_t(0, rest);
+}
+
+/* Helpers for the fixed-point accuracy corpus */
+static uint32_t corpus_rand(uint32_t* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+static double legacy_coordinate(const char* coord, char hemi) {
+    double raw = strtod(coord, NULL);
+    int degrees = (int)(raw / 100.0);
+    double value = degrees + (raw - degrees * 100.0) / 60.0;
+    return (hemi == 'S' || hemi == 'W') ? -value : value;
+}
+
+static float ulps_apart(float a, float b) {
+    float ulp = nextafterf(fabsf(b), INFINITY) - fabsf(b);
+    return fabsf(a - b) / ulp;
+}
+
+typedef struct {
+    char lat[16], lon[16], alt[16], knots[16], course[16], hdop[16];
+    char ns, ew;
+    unsigned sats;
+    bool lat_tie, lon_tie;
+} corpus_epoch_t;
+
+static void corpus_make(corpus_epoch_t* e, uint32_t* rng) {
+    unsigned lat_deg = corpus_rand(rng) % 90, lon_deg = corpus_rand(rng) % 180;
+    unsigned lat_min_e5 = corpus_rand(rng) % 6000000u, lon_min_e5 = corpus_rand(rng) % 6000000u;
+    snprintf(e->lat, sizeof(e->lat), "%02u%02u.%05u", lat_deg, lat_min_e5 / 100000u, lat_min_e5 % 100000u);
+    snprintf(e->lon, sizeof(e->lon), "%03u%02u.%05u", lon_deg, lon_min_e5 / 100000u, lon_min_e5 % 100000u);
+    e->lat_tie = (lat_min_e5 % 6u) == 3u;
+    e->lon_tie = (lon_min_e5 % 6u) == 3u;
+    e->ns = (corpus_rand(rng) & 1) ? 'N' : 'S';
+    e->ew = (corpus_rand(rng) & 1) ? 'E' : 'W';
+
+    int alt_dm = (int)(corpus_rand(rng) % 90000u) - 5000;
+    snprintf(e->alt, sizeof(e->alt), "%s%d.%d", alt_dm < 0 ? "-" : "", abs(alt_dm) / 10, abs(alt_dm) % 10);
+    unsigned knots_e3 = corpus_rand(rng) % 300000u;
+    snprintf(e->knots, sizeof(e->knots), "%u.%03u", knots_e3 / 1000u, knots_e3 % 1000u);
+    unsigned course_e2 = corpus_rand(rng) % 36000u;
+    snprintf(e->course, sizeof(e->course), "%u.%02u", course_e2 / 100u, course_e2 % 100u);
+    unsigned hdop_e2 = 50u + corpus_rand(rng) % 9950u;
+    snprintf(e->hdop, sizeof(e->hdop), "%u.%02u", hdop_e2 / 100u, hdop_e2 % 100u);
+    e->sats = corpus_rand(rng) % 25u;
+}
+
+static void corpus_check(const corpus_epoch_t* e, const gps_fix_t* fix) {
+    char got[32], want[32];
+
+    /* CSV prints %.6f: identical except where the exact value is a half micro-degree */
+    snprintf(got, sizeof(got), "%.6f", fix->latitude);
+    snprintf(want, sizeof(want), "%.6f", legacy_coordinate(e->lat, e->ns));
+    if (!e->lat_tie) TEST_ASSERT_EQUAL_STRING(want, got);
+    TEST_ASSERT_TRUE(fabs(fix->latitude - legacy_coordinate(e->lat, e->ns)) <= 0.5e-6 + 1e-12);
+    snprintf(got, sizeof(got), "%.6f", fix->longitude);
+    snprintf(want, sizeof(want), "%.6f", legacy_coordinate(e->lon, e->ew));
+    if (!e->lon_tie) TEST_ASSERT_EQUAL_STRING(want, got);
+    TEST_ASSERT_TRUE(fabs(fix->longitude - legacy_coordinate(e->lon, e->ew)) <= 0.5e-6 + 1e-12);
+
+    TEST_ASSERT_TRUE(ulps_apart(fix->altitude_m, (float)strtod(e->alt, NULL)) <= 1.0f);
+    TEST_ASSERT_TRUE(ulps_apart(fix->hdop, (float)strtod(e->hdop, NULL)) <= 1.0f);
+    TEST_ASSERT_TRUE(ulps_apart(fix->course_deg, (float)strtod(e->course, NULL)) <= 1.0f);
+    TEST_ASSERT_TRUE(ulps_apart(fix->speed_kmh, (float)(strtod(e->knots, NULL) * KNOTS_TO_KMH)) <= 2.0f);
+    TEST_ASSERT_EQUAL_UINT8(e->sats, fix->satellites);
+}
+
+/* T26: fixed-point field parsing matches the former strtod results over a random corpus */
+void test_fixed_point_matches_strtod(void) {
+    uint32_t rng = 12345;
+    corpus_epoch_t prev, cur;
+    char body[128], line[160];
+
+    for (int i = 0; i < 20000; i++) {
+        corpus_make(&cur, &rng);
+        unsigned t = (unsigned)i % 86400u;
+        char hms[16];
+        snprintf(hms, sizeof(hms), "%02u%02u%02u.00", t / 3600u, (t / 60u) % 60u, t % 60u);
+
+        snprintf(body, sizeof(body), "GPGGA,%s,%s,%c,%s,%c,1,%02u,%s,%s,M,48.0,M,,",
+                 hms, cur.lat, cur.ns, cur.lon, cur.ew, cur.sats, cur.hdop, cur.alt);
+        build_sentence(line, sizeof(line), body);
+        nmea_result_t r = nmea_parser_feed(parser, line);
+        if (i > 0) {
+            TEST_ASSERT_EQUAL_INT(NMEA_RESULT_FIX_READY, r);
+            gps_fix_t fix;
+            TEST_ASSERT_TRUE(nmea_parser_get_fix(parser, &fix));
+            corpus_check(&prev, &fix);
+        }
+
+        snprintf(body, sizeof(body), "GPRMC,%s,A,%s,%c,%s,%c,%s,%s,091202,,,A",
+                 hms, cur.lat, cur.ns, cur.lon, cur.ew, cur.knots, cur.course);
+        build_sentence(line, sizeof(line), body);
+        nmea_parser_feed(parser, line);
+        prev = cur;
+    }
+}
+
+/* T27: malformed numeric fields are dropped, excess digits are rounded */
+void test_numeric_field_edge_cases(void) {
+    char gga[160], rmc[160], next[160];
+    build_sentence(gga, sizeof(gga), "GPGGA,230000.00,4717.113995,N,00833.9159,E,1,x8,1.0.1,-12.345,M,48.0,M,,");
+    build_sentence(rmc, sizeof(rmc), "GPRMC,230000.00,A,4717.113995,N,00833.9159,E,abc,359.999,091202,,,A");
+    build_sentence(next, sizeof(next), "GPGGA,230001.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,");
+
+    nmea_parser_feed(parser, gga);
+    nmea_parser_feed(parser, rmc);
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_FIX_READY, nmea_parser_feed(parser, next));
+
+    gps_fix_t fix;
+    TEST_ASSERT_TRUE(nmea_parser_get_fix(parser, &fix));
+    /* 17.113995' rounds to 17.11400' -> 47.285233(3) */
+    TEST_ASSERT_TRUE(fabs(fix.latitude - 47.285233) <= 1e-9);
+    TEST_ASSERT_TRUE(fabs(fix.longitude - 8.565265) <= 1e-9);
+    TEST_ASSERT_EQUAL_UINT8(0, fix.satellites);
+    TEST_ASSERT_FALSE(fix.flags & GPS_HAS_HDOP);
+    TEST_ASSERT_TRUE(fix.flags & GPS_HAS_ALTITUDE);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, -12.35f, fix.altitude_m);
+    TEST_ASSERT_FALSE(fix.flags & GPS_HAS_SPEED);
+    TEST_ASSERT_TRUE(fix.flags & GPS_HAS_COURSE);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 360.00f, fix.course_deg);
+}
+
+/* T28: VTG/GLL/ZDA built-ins fill the fix when enabled */
+void test_builtin_vtg_gll_zda(void) {
+    char gll[128], vtg[128], zda[128], gga[128], next[128];
+    build_sentence(gll, sizeof(gll), "GPGLL,4717.11399,N,00833.91590,E,150000.00,A,A");
+    build_sentence(vtg, sizeof(vtg), "GPVTG,77.52,T,,M,5.400,N,10.001,K,A");
+    build_sentence(zda, sizeof(zda), "GPZDA,150000.00,09,12,2002,00,00");
+    build_sentence(gga, sizeof(gga), "GPGGA,150000.00,,,,,1,08,1.01,499.6,M,48.0,M,,");
+    build_sentence(next, sizeof(next), "GPZDA,150001.00,09,12,2002,00,00");
+
+    /* Disabled by default: no effect on the epoch */
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_NONE, nmea_parser_feed(parser, gll));
+
+    nmea_parser_enable_sentences(parser, NMEA_SENTENCE_GGA | NMEA_SENTENCE_VTG |
+                                         NMEA_SENTENCE_GLL | NMEA_SENTENCE_ZDA);
+    nmea_parser_feed(parser, gll);
+    nmea_parser_feed(parser, vtg);
+    nmea_parser_feed(parser, zda);
+    nmea_parser_feed(parser, gga);
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_FIX_READY, nmea_parser_feed(parser, next));
+
+    gps_fix_t fix;
+    TEST_ASSERT_TRUE(nmea_parser_get_fix(parser, &fix));
+    TEST_ASSERT_TRUE(fix.flags & GPS_HAS_LATLON);
+    TEST_ASSERT_FLOAT_WITHIN(0.000001, 47.285233, fix.latitude);
+    TEST_ASSERT_TRUE(fix.flags & GPS_HAS_SPEED);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 10.001, fix.speed_kmh);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 77.52, fix.course_deg);
+    TEST_ASSERT_TRUE(fix.flags & GPS_HAS_DATE);
+    TEST_ASSERT_EQUAL_UINT16(2002, fix.year);
+    TEST_ASSERT_EQUAL_UINT8(12, fix.month);
+    TEST_ASSERT_EQUAL_UINT8(1, fix.fix_quality);
+}
+
+/* Helper: records GSV sentences seen by a registered handler */
+typedef struct {
+    int calls;
+    int last_field_count;
+    char sats_in_view[4];
+} gsv_sink_t;
+
+static void on_gsv(const nmea_sentence_t* sentence, void* user) {
+    gsv_sink_t* sink = (gsv_sink_t*)user;
+    TEST_ASSERT_EQUAL_HEX32(NMEA_ID_GSV, nmea_sentence_id(sentence));
+    size_t len = 0;
+    const char* f = nmea_sentence_field(sentence, 3, &len);
+    if (f && len < sizeof(sink->sats_in_view)) {
+        memcpy(sink->sats_in_view, f, len);
+        sink->sats_in_view[len] = '\0';
+    }
+    sink->last_field_count = nmea_sentence_field_count(sentence);
+    TEST_ASSERT_NULL(nmea_sentence_field(sentence, sink->last_field_count, &len));
+    TEST_ASSERT_EQUAL_size_t(0, len);
+    sink->calls++;
+}
+
+/* T29: registered handler receives field views; unwanted types skip checksum */
+void test_registered_handler(void) {
+    char gsv[128];
+    build_sentence(gsv, sizeof(gsv), "GPGSV,3,1,12,01,40,083,46,02,17,308,44,12,07,344,39,14,22,228,45");
+
+    /* Unwanted: rejected on the ID, so even a corrupt checksum is just ignored */
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_NONE, nmea_parser_feed(parser, "$GPGSV,3,1,12*00"));
+
+    gsv_sink_t sink = {0};
+    TEST_ASSERT_TRUE(nmea_parser_register_handler(parser, NMEA_ID_GSV, on_gsv, &sink));
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_ERROR, nmea_parser_feed(parser, "$GPGSV,3,1,12*00"));
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_NONE, nmea_parser_feed(parser, gsv));
+    TEST_ASSERT_EQUAL_INT(1, sink.calls);
+    TEST_ASSERT_EQUAL_INT(20, sink.last_field_count);
+    TEST_ASSERT_EQUAL_STRING("12", sink.sats_in_view);
+
+    /* Handler table is bounded */
+    for (int i = 1; i < NMEA_MAX_HANDLERS; i++) {
+        TEST_ASSERT_TRUE(nmea_parser_register_handler(parser, NMEA_SENTENCE_ID('T', 'X', 'T'), on_gsv, &sink));
+    }
+    TEST_ASSERT_FALSE(nmea_parser_register_handler(parser, NMEA_ID_GSA, on_gsv, &sink));
+    TEST_ASSERT_FALSE(nmea_parser_register_handler(parser, NMEA_ID_GSA, NULL, &sink));
+}
+
+/* T30: byte stream skips unwanted types and still dispatches handled ones */
+void test_feed_bytes_dispatch(void) {
+    char gsv[128], gsa[128], stream[1024];
+    build_sentence(gsv, sizeof(gsv), "GPGSV,3,1,12,01,40,083,46,02,17,308,44,12,07,344,39,14,22,228,45");
+    build_sentence(gsa, sizeof(gsa), "GPGSA,A,3,01,02,12,14,,,,,,,,,2.0,1.01,1.7");
+    size_t n = build_stream(stream, sizeof(stream));
+    n += (size_t)snprintf(stream + n, sizeof(stream) - n, "%s\r\n%s\r\n%s\r\n", gsv, gsa, gsv);
+
+    gsv_sink_t sink = {0};
+    fix_sink_t fixes = {0};
+    nmea_parser_register_handler(parser, NMEA_ID_GSV, on_gsv, &sink);
+    nmea_parser_set_fix_callback(parser, collect_fix, &fixes);
+    TEST_ASSERT_EQUAL_INT(2, nmea_parser_feed_bytes(parser, (const uint8_t*)stream, n));
+    TEST_ASSERT_EQUAL_INT(2, sink.calls);
+    TEST_ASSERT_EQUAL_INT(2, fixes.count);
+}
+
+/* Helper: feeds n epochs of NEO-8M order (RMC, VTG, GGA, GLL) at 1 Hz, with
+   sentence k of epoch e arriving at e*1000 + k*20 ms. Returns the mean delay
+   from the epoch's last GGA/RMC sentence to the FIX_READY that delivered it. */
+static double epoch_latency_ms(nmea_parser_t* p, int n) {
+    double total = 0;
+    int delivered = 0;
+    uint32_t last_required_ms[16];
+    for (int e = 0; e < n && e < 16; e++) {
+        char body[128], line[160];
+        for (int k = 0; k < 4; k++) {
+            uint32_t now = (uint32_t)(e * 1000 + k * 20);
+            nmea_parser_tick(p, now);
+            if (k == 0) {
+                snprintf(body, sizeof(body), "GPRMC,1600%02d.00,A,4717.11399,N,00833.91590,E,5.400,77.52,091202,,,A", e);
+            } else if (k == 1) {
+                snprintf(body, sizeof(body), "GPVTG,77.52,T,,M,5.400,N,10.001,K,A");
+            } else if (k == 2) {
+                snprintf(body, sizeof(body), "GPGGA,1600%02d.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,", e);
+                last_required_ms[e] = now;
+            } else {
+                snprintf(body, sizeof(body), "GPGLL,4717.11399,N,00833.91590,E,1600%02d.00,A,A", e);
+            }
+            build_sentence(line, sizeof(line), body);
+            if (nmea_parser_feed(p, line) == NMEA_RESULT_FIX_READY) {
+                gps_fix_t fix;
+                TEST_ASSERT_TRUE(nmea_parser_get_fix(p, &fix));
+                TEST_ASSERT_TRUE(fix.flags & GPS_FIX_VALID);
+                TEST_ASSERT_TRUE(fix.flags & GPS_HAS_SPEED);
+                total += (double)(now - last_required_ms[fix.second]);
+                delivered++;
+            }
+        }
+    }
+    TEST_ASSERT_TRUE(delivered > 0);
+    return total / delivered;
+}
+
+/* T31: latency from the epoch's last required sentence to FIX_READY */
+void test_epoch_policy_latency(void) {
+    /* Default: published by the next epoch's first sentence, ~1 epoch late */
+    double legacy = epoch_latency_ms(parser, 5);
+    TEST_ASSERT_TRUE(legacy >= 900.0);
+
+    /* GGA+RMC policy: published by the sentence completing the set */
+    nmea_parser_t* p = nmea_parser_create();
+    nmea_parser_set_epoch_policy(p, NMEA_SENTENCE_GGA | NMEA_SENTENCE_RMC, 0);
+    double early = epoch_latency_ms(p, 5);
+    nmea_parser_destroy(p);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, (float)early);
+}
+
+/* T32: epoch emitted once; later same-time sentences do not re-emit */
+void test_epoch_policy_no_duplicate(void) {
+    char rmc[128], gga[128], rmc_dup[128], next[128];
+    build_sentence(rmc, sizeof(rmc), "GPRMC,170000.00,A,4717.11399,N,00833.91590,E,5.400,77.52,091202,,,A");
+    build_sentence(gga, sizeof(gga), "GPGGA,170000.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,");
+    build_sentence(rmc_dup, sizeof(rmc_dup), "GPRMC,170000.00,A,4717.11399,N,00833.91590,E,5.400,77.52,091202,,,A");
+    build_sentence(next, sizeof(next), "GPRMC,170001.00,A,4718.00000,N,00834.00000,E,5.400,77.52,091202,,,A");
+
+    fix_sink_t sink = {0};
+    nmea_parser_set_fix_callback(parser, collect_fix, &sink);
+    nmea_parser_set_epoch_policy(parser, NMEA_SENTENCE_GGA | NMEA_SENTENCE_RMC, 0);
+
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_NONE, nmea_parser_feed(parser, rmc));
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_FIX_READY, nmea_parser_feed(parser, gga));
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_NONE, nmea_parser_feed(parser, rmc_dup));
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_NONE, nmea_parser_feed(parser, next));
+    TEST_ASSERT_EQUAL_INT(1, sink.count);
+    TEST_ASSERT_EQUAL_UINT8(0, sink.fixes[0].second);
+}
+
+/* T33: timeout flush for receivers that skip a required sentence */
+void test_epoch_policy_timeout(void) {
+    char gga[128], gga2[128];
+    build_sentence(gga, sizeof(gga), "GPGGA,180000.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,");
+    build_sentence(gga2, sizeof(gga2), "GPGGA,180001.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,");
+
+    fix_sink_t sink = {0};
+    nmea_parser_set_fix_callback(parser, collect_fix, &sink);
+    nmea_parser_set_epoch_policy(parser, NMEA_SENTENCE_GGA | NMEA_SENTENCE_RMC, 500);
+
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_NONE, nmea_parser_tick(parser, 10000));
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_NONE, nmea_parser_feed(parser, gga));  /* no RMC follows */
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_NONE, nmea_parser_tick(parser, 10499));
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_FIX_READY, nmea_parser_tick(parser, 10500));
+    TEST_ASSERT_EQUAL_INT(1, sink.count);
+    TEST_ASSERT_TRUE(sink.fixes[0].flags & GPS_HAS_LATLON);
+    TEST_ASSERT_FALSE(sink.fixes[0].flags & GPS_HAS_SPEED);
+
+    gps_fix_t fix;
+    TEST_ASSERT_TRUE(nmea_parser_get_fix(parser, &fix));
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_NONE, nmea_parser_tick(parser, 10600));
+
+    /* The flushed epoch is not emitted again when the next one starts */
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_NONE, nmea_parser_feed(parser, gga2));
+    TEST_ASSERT_EQUAL_INT(1, sink.count);
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_ERROR, nmea_parser_tick(NULL, 0));
+}
+
+/* T34: every drop reason has its own counter, on both input paths */
+void test_stats_drop_reasons(void) {
+    char lines[9][160];
+    strcpy(lines[0], "");
+    strcpy(lines[1], "hello world");
+    build_sentence(lines[2], sizeof(lines[2]),
+                   "GPGGA,092725.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,,,,,,,,,,,,,,,,,,");
+    strcpy(lines[3], "$GPGGA,092725.00,4717.11399,N");
+    build_sentence(lines[4], sizeof(lines[4]), "GPRMC,092725.00,A,4717.11399,N,00833.91590,E,0.004,77.52,091202,,,A");
+    lines[4][strlen(lines[4]) - 1] ^= 0x01;
+    build_sentence(lines[5], sizeof(lines[5]), "GPGSV,3,1,11,10,63,137,17");
+    build_sentence(lines[6], sizeof(lines[6]), "GPGGA,092725.00,4717.11399");
+    build_sentence(lines[7], sizeof(lines[7]), "GPGGA,,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,");
+    build_sentence(lines[8], sizeof(lines[8]), "GPGGA,092725.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,");
+
+    char stream[1024];
+    size_t n = 0;
+    for (int i = 0; i < 9; i++) {
+        nmea_parser_feed(parser, lines[i]);
+        n += (size_t)snprintf(stream + n, sizeof(stream) - n, "%s\r\n", lines[i]);
+    }
+
+    nmea_parser_stats_t st;
+    TEST_ASSERT_TRUE(nmea_parser_get_stats(parser, &st));
+    TEST_ASSERT_EQUAL_UINT32(2, st.not_nmea);
+    TEST_ASSERT_EQUAL_UINT32(1, st.too_long);
+    TEST_ASSERT_EQUAL_UINT32(1, st.no_checksum);
+    TEST_ASSERT_EQUAL_UINT32(1, st.bad_checksum);
+    TEST_ASSERT_EQUAL_UINT32(1, st.unwanted);
+    TEST_ASSERT_EQUAL_UINT32(1, st.too_short);
+    TEST_ASSERT_EQUAL_UINT32(1, st.bad_time);
+    TEST_ASSERT_EQUAL_UINT32(3, st.sentences[0]);   /* GGA slot */
+    TEST_ASSERT_EQUAL_UINT32(0, st.sentences[1]);
+    TEST_ASSERT_EQUAL_UINT32(0, st.epochs);
+
+    /* Same stream as raw bytes: identical counts, except text without '$' */
+    nmea_parser_t* p = nmea_parser_create();
+    nmea_parser_feed_bytes(p, (const uint8_t*)stream, n);
+    nmea_parser_stats_t sb;
+    TEST_ASSERT_TRUE(nmea_parser_get_stats(p, &sb));
+    nmea_parser_destroy(p);
+    TEST_ASSERT_EQUAL_UINT32(0, sb.not_nmea);
+    sb.not_nmea = st.not_nmea;
+    TEST_ASSERT_EQUAL_MEMORY(&st, &sb, sizeof(st));
+
+    /* A sentence cut off by the next '$' is a missing checksum */
+    p = nmea_parser_create();
+    const char* cut = "$GPRMC,0927$GPGGA,0927";
+    nmea_parser_feed_bytes(p, (const uint8_t*)cut, strlen(cut));
+    TEST_ASSERT_TRUE(nmea_parser_get_stats(p, &sb));
+    nmea_parser_destroy(p);
+    TEST_ASSERT_EQUAL_UINT32(1, sb.no_checksum);
+    TEST_ASSERT_FALSE(nmea_parser_get_stats(NULL, &sb));
+    TEST_ASSERT_FALSE(nmea_parser_get_stats(parser, NULL));
+}
+
+static uint32_t fake_cycles;
+
+static uint32_t fake_cycle_counter(void) {
+    fake_cycles += 10;
+    return fake_cycles;
+}
+
+/* T35: epoch counters by emit rule, and cycle cost per sentence type */
+void test_stats_epochs_and_cycles(void) {
+    char gga[2][128], rmc[2][128], gga3[128];
+    build_sentence(gga[0], sizeof(gga[0]), "GPGGA,120000.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,");
+    build_sentence(rmc[0], sizeof(rmc[0]), "GPRMC,120000.00,A,4717.11399,N,00833.91590,E,0.004,77.52,091202,,,A");
+    build_sentence(gga[1], sizeof(gga[1]), "GPGGA,120001.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,");
+    build_sentence(rmc[1], sizeof(rmc[1]), "GPRMC,120001.00,A,4717.11399,N,00833.91590,E,0.004,77.52,091202,,,A");
+    build_sentence(gga3, sizeof(gga3), "GPGGA,120002.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,");
+
+    nmea_parser_set_epoch_policy(parser, NMEA_SENTENCE_GGA | NMEA_SENTENCE_RMC, 500);
+    nmea_parser_set_cycle_counter(parser, fake_cycle_counter);
+    nmea_parser_tick(parser, 0);
+    for (int i = 0; i < 2; i++) {
+        nmea_parser_feed(parser, gga[i]);
+        nmea_parser_feed(parser, rmc[i]);
+    }
+    nmea_parser_feed(parser, gga3);
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_FIX_READY, nmea_parser_tick(parser, 500));
+
+    nmea_parser_stats_t st;
+    TEST_ASSERT_TRUE(nmea_parser_get_stats(parser, &st));
+    TEST_ASSERT_EQUAL_UINT32(3, st.epochs);
+    TEST_ASSERT_EQUAL_UINT32(2, st.epochs_early);
+    TEST_ASSERT_EQUAL_UINT32(1, st.epochs_timeout);
+    TEST_ASSERT_EQUAL_UINT32(3, st.sentences[0]);
+    TEST_ASSERT_EQUAL_UINT32(2, st.sentences[1]);
+    TEST_ASSERT_TRUE(st.cycles[0] == 30);   /* one 10-tick bracket per sentence */
+    TEST_ASSERT_TRUE(st.cycles[1] == 20);
+    TEST_ASSERT_TRUE(st.cycles[NMEA_STATS_OTHER] == 0);
+
+    nmea_parser_reset_stats(parser);
+    nmea_parser_set_cycle_counter(parser, NULL);
+    nmea_parser_feed(parser, rmc[0]);
+    TEST_ASSERT_TRUE(nmea_parser_get_stats(parser, &st));
+    TEST_ASSERT_EQUAL_UINT32(0, st.epochs);
+    TEST_ASSERT_EQUAL_UINT32(0, st.sentences[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, st.sentences[1]);
+    TEST_ASSERT_TRUE(st.cycles[1] == 0);
+}
+
+/* T36: with RMC alone required, an RMC whose new time emits a GGA-only
+   epoch does not emit its own in the same call; the next tick does */
+void test_epoch_policy_single_type(void) {
+    char gga[128], rmc[128], rmc2[128];
+    build_sentence(gga, sizeof(gga), "GPGGA,190000.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,");
+    build_sentence(rmc, sizeof(rmc), "GPRMC,190001.00,A,4718.00000,N,00834.00000,E,5.400,77.52,091202,,,A");
+    build_sentence(rmc2, sizeof(rmc2), "GPRMC,190002.00,A,4719.00000,N,00835.00000,E,5.400,77.52,091202,,,A");
+
+    fix_sink_t sink = {0};
+    nmea_parser_set_fix_callback(parser, collect_fix, &sink);
+    nmea_parser_set_epoch_policy(parser, NMEA_SENTENCE_RMC, 0);
+
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_NONE, nmea_parser_feed(parser, gga));
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_FIX_READY, nmea_parser_feed(parser, rmc));
+    TEST_ASSERT_EQUAL_INT(1, sink.count);
+    gps_fix_t fix;
+    TEST_ASSERT_TRUE(nmea_parser_get_fix(parser, &fix));
+    TEST_ASSERT_EQUAL_UINT8(0, fix.second);
+
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_FIX_READY, nmea_parser_tick(parser, 100));
+    TEST_ASSERT_EQUAL_INT(2, sink.count);
+    TEST_ASSERT_EQUAL_UINT8(1, sink.fixes[1].second);
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_NONE, nmea_parser_tick(parser, 200));
+
+    /* Back in step: the next RMC emits its own epoch at once */
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_FIX_READY, nmea_parser_feed(parser, rmc2));
+    TEST_ASSERT_EQUAL_INT(3, sink.count);
+    TEST_ASSERT_EQUAL_UINT8(2, sink.fixes[2].second);
+
+    nmea_parser_stats_t st;
+    TEST_ASSERT_TRUE(nmea_parser_get_stats(parser, &st));
+    TEST_ASSERT_EQUAL_UINT32(3, st.epochs);
+    TEST_ASSERT_EQUAL_UINT32(2, st.epochs_early);
+}
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_valid_gga_rmc_pair);
@@ -299,5 +915,23 @@ int main(void) {
     RUN_TEST(test_rmc_date_parsing);
     RUN_TEST(test_sequential_fixes);
     RUN_TEST(test_empty_position_fields);
+    RUN_TEST(test_crlf_lowercase_checksum);
+    RUN_TEST(test_oversized_sentence);
+    RUN_TEST(test_feed_bytes_chunk_boundaries);
+    RUN_TEST(test_feed_bytes_resync);
+    RUN_TEST(test_feed_bytes_null);
+    RUN_TEST(test_parse_buffer_resume);
+    RUN_TEST(test_parse_buffer_partial_line);
+    RUN_TEST(test_fixed_point_matches_strtod);
+    RUN_TEST(test_numeric_field_edge_cases);
+    RUN_TEST(test_builtin_vtg_gll_zda);
+    RUN_TEST(test_registered_handler);
+    RUN_TEST(test_feed_bytes_dispatch);
+    RUN_TEST(test_epoch_policy_latency);
+    RUN_TEST(test_epoch_policy_no_duplicate);
+    RUN_TEST(test_epoch_policy_timeout);
+    RUN_TEST(test_stats_drop_reasons);
+    RUN_TEST(test_stats_epochs_and_cycles);
+    RUN_TEST(test_epoch_policy_single_type);
     return UNITY_END();
 }
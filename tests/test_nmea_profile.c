@@ -0,0 +1,89 @@
+#include "unity.h"
+#include "nmea_parser.h"
+#include <string.h>
+#include <stdio.h>
+
+/* Built once per decode profile; expectations follow NMEA_BUILD_* */
+
+static nmea_parser_t* parser;
+
+void setUp(void) {
+    parser = nmea_parser_create();
+    nmea_parser_enable_sentences(parser, NMEA_SENTENCE_ALL);
+}
+
+void tearDown(void) {
+    nmea_parser_destroy(parser);
+    parser = NULL;
+}
+
+/* Helper: "$body*HH" */
+static void build_sentence(char* out, size_t out_size, const char* body) {
+    uint8_t cs = 0;
+    for (const char* p = body; *p; p++) cs ^= (uint8_t)*p;
+    snprintf(out, out_size, "$%s*%02X", body, cs);
+}
+
+static nmea_result_t feed_body(const char* body) {
+    char line[128];
+    build_sentence(line, sizeof(line), body);
+    return nmea_parser_feed(parser, line);
+}
+
+/* T1: an epoch carrying every field decodes exactly the profile's fields */
+void test_profile_fields(void) {
+    feed_body("GPRMC,092725.00,A,4717.11399,N,00833.91590,E,5.400,77.52,091202,,,A");
+    feed_body("GPVTG,77.52,T,,M,5.400,N,10.001,K,A");
+    feed_body("GPGGA,092725.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,");
+    feed_body("GPGLL,4717.11399,N,00833.91590,E,092725.00,A,A");
+    feed_body("GPZDA,092725.00,09,12,2002,00,00");
+    TEST_ASSERT_EQUAL_INT(NMEA_RESULT_FIX_READY,
+                          feed_body("GPGGA,092726.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,"));
+
+    gps_fix_t fix;
+    TEST_ASSERT_TRUE(nmea_parser_get_fix(parser, &fix));
+    TEST_ASSERT_EQUAL_HEX32(NMEA_BUILD_FIELDS | GPS_HAS_TIME, fix.flags & GPS_HAS_ALL);
+    TEST_ASSERT_TRUE(fix.flags & GPS_FIX_VALID);
+    TEST_ASSERT_EQUAL_UINT8(25, fix.second);
+    TEST_ASSERT_EQUAL_UINT8(8, fix.satellites);
+    TEST_ASSERT_EQUAL_UINT8(1, fix.fix_quality);
+    if (fix.flags & GPS_HAS_LATLON) {
+        TEST_ASSERT_FLOAT_WITHIN(0.000001, 47.285233, fix.latitude);
+    } else {
+        TEST_ASSERT_TRUE(fix.latitude == 0.0);
+    }
+    if (fix.flags & GPS_HAS_SPEED) {
+        TEST_ASSERT_FLOAT_WITHIN(0.01, 10.0, fix.speed_kmh);
+    }
+}
+
+/* T2: built-in types outside the profile cannot be enabled and are dropped on ID */
+void test_profile_sentences(void) {
+    feed_body("GPGGA,092725.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,");
+    feed_body("GPVTG,77.52,T,,M,5.400,N,10.001,K,A");
+    feed_body("GPGLL,4717.11399,N,00833.91590,E,092725.00,A,A");
+    feed_body("GPZDA,092725.00,09,12,2002,00,00");
+    feed_body("GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1");
+
+    nmea_parser_stats_t st;
+    TEST_ASSERT_TRUE(nmea_parser_get_stats(parser, &st));
+    static const uint32_t optional[] = {
+        NMEA_SENTENCE_GSA, NMEA_SENTENCE_VTG, NMEA_SENTENCE_GLL, NMEA_SENTENCE_ZDA
+    };
+    static const int slot[] = { 2, 4, 5, 6 };
+    uint32_t dropped = 0;
+    for (int i = 0; i < 4; i++) {
+        bool built = (NMEA_BUILD_SENTENCES & optional[i]) != 0;
+        TEST_ASSERT_EQUAL_UINT32(built ? 1 : 0, st.sentences[slot[i]]);
+        if (!built) dropped++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(dropped, st.unwanted);
+    TEST_ASSERT_EQUAL_UINT32(1, st.sentences[0]);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_profile_fields);
+    RUN_TEST(test_profile_sentences);
+    return UNITY_END();
+}
@@ -0,0 +1,184 @@
+#include "unity.h"
+#include "gps_stream.h"
+#include "gps_filter.h"
+#include "data_storage.h"
+#include "hal/hal.h"
+#include "hal/hal_mock.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/*
+ * Linked with -Wl,--wrap for malloc/calloc/realloc: every heap request made
+ * by our code (not libc's own, e.g. inside fopen) goes through the counters
+ * below, so a steady-state loop that allocates fails here.
+ */
+static size_t heap_calls;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* p, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    heap_calls++;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+    heap_calls++;
+    return __real_calloc(n, size);
+}
+
+void* __wrap_realloc(void* p, size_t size) {
+    heap_calls++;
+    return __real_realloc(p, size);
+}
+
+static char tmpdir[256];
+
+void setUp(void) {
+    hal_mock_reset();
+    snprintf(tmpdir, sizeof(tmpdir), "/tmp/gps_heap_XXXXXX");
+    char* result = mkdtemp(tmpdir);
+    (void)result;
+    hal_mock_fs_set_root(tmpdir);
+    heap_calls = 0;
+}
+
+void tearDown(void) {
+    char cmd[512];
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", tmpdir);
+    system(cmd);
+}
+
+/* Helper: appends "$body*HH\r\n" */
+static size_t put_sentence(char* out, size_t size, const char* body) {
+    uint8_t cs = 0;
+    for (const char* p = body; *p; p++) cs ^= (uint8_t)*p;
+    return (size_t)snprintf(out, size, "$%s*%02X\r\n", body, cs);
+}
+
+/* Helper: GGA+RMC for second s of a track moving north at ~36 km/h */
+static size_t put_nmea_epoch(char* out, size_t size, int s) {
+    char body[128];
+    double minutes = 17.11399 + s * 0.0054;   /* ~10 m per second */
+    snprintf(body, sizeof(body), "GPGGA,10%02d%02d.00,47%08.5f,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,",
+             s / 60, s % 60, minutes);
+    size_t n = put_sentence(out, size, body);
+    snprintf(body, sizeof(body), "GPRMC,10%02d%02d.00,A,47%08.5f,N,00833.91590,E,19.438,0.00,091202,,,A",
+             s / 60, s % 60, minutes);
+    return n + put_sentence(out + n, size - n, body);
+}
+
+static size_t put_pvt(uint8_t* out, size_t size, int s) {
+    uint8_t p[UBX_NAV_PVT_LEN];
+    memset(p, 0, sizeof(p));
+    p[4] = 2002 & 0xFF;
+    p[5] = 2002 >> 8;
+    p[6] = 12;
+    p[7] = 9;
+    p[8] = 11;
+    p[9] = (uint8_t)(s / 60);
+    p[10] = (uint8_t)(s % 60);
+    p[11] = 0x07;
+    p[20] = 3;
+    p[21] = 0x01;
+    p[23] = 9;
+    int32_t lon = 85652650;
+    int32_t lat = 472852332 + s * 900;
+    int32_t speed = 10000;                     /* 10 m/s */
+    memcpy(p + 24, &lon, 4);                   /* little-endian host */
+    memcpy(p + 28, &lat, 4);
+    memcpy(p + 60, &speed, 4);
+    return ubx_frame_encode(UBX_CLASS_NAV, UBX_ID_NAV_PVT, p, sizeof(p), out, size);
+}
+
+typedef struct {
+    gps_filter_t filter;
+    data_storage_t storage;
+    int written;
+} loop_state_t;
+
+static void on_fix(const gps_fix_t* fix, void* user) {
+    loop_state_t* t = (loop_state_t*)user;
+    if (!(fix->flags & GPS_FIX_VALID) || !(fix->flags & GPS_HAS_LATLON)) return;
+    if (gps_filter_process(&t->filter, fix) != FILTER_ACCEPT) return;
+    if (data_storage_write_fix(&t->storage, fix) == STORAGE_OK) t->written++;
+}
+
+/* Main-loop equivalent: 64-byte UART reads, tick after each read */
+static void run_loop(gps_stream_t* gps, const uint8_t* buf, size_t len) {
+    for (size_t off = 0; off < len; off += 64) {
+        size_t n = (len - off < 64) ? len - off : 64;
+        hal_mock_time_advance_ms(50);
+        nmea_parser_tick(gps_stream_nmea(gps), hal_time_ms());
+        gps_stream_feed(gps, buf + off, n);
+    }
+}
+
+/* T1: the counter sees heap use, and create() is one block per object */
+void test_counter_sees_create(void) {
+    nmea_parser_t* p = nmea_parser_create();
+    TEST_ASSERT_EQUAL_size_t(1, heap_calls);
+    nmea_parser_destroy(p);
+
+    heap_calls = 0;
+    gps_stream_t* s = gps_stream_create();
+    TEST_ASSERT_NOT_NULL(s);
+    TEST_ASSERT_EQUAL_size_t(1, heap_calls);
+    gps_stream_destroy(s);
+}
+
+/* T2: init() on caller storage never allocates */
+void test_init_is_heap_free(void) {
+    static nmea_parser_storage_t nmea_storage;
+    static ubx_parser_storage_t ubx_storage;
+    static gps_stream_storage_t stream_storage;
+
+    TEST_ASSERT_NOT_NULL(nmea_parser_init(&nmea_storage));
+    TEST_ASSERT_NOT_NULL(ubx_parser_init(&ubx_storage));
+    TEST_ASSERT_NOT_NULL(gps_stream_init(&stream_storage));
+    TEST_ASSERT_NULL(gps_stream_init(NULL));
+    TEST_ASSERT_EQUAL_size_t(0, heap_calls);
+}
+
+/* T3: boot, then 10 minutes of NMEA and UBX input through filter and storage */
+void test_steady_state_loop(void) {
+    static gps_stream_storage_t gps_storage;
+    static loop_state_t t;
+    memset(&t, 0, sizeof(t));
+
+    /* Boot, as in main() */
+    TEST_ASSERT_EQUAL_INT(STORAGE_OK, data_storage_init(&t.storage));
+    gps_stream_t* gps = gps_stream_init(&gps_storage);
+    gps_stream_set_fix_callback(gps, on_fix, &t);
+    nmea_parser_set_epoch_policy(gps_stream_nmea(gps), NMEA_SENTENCE_GGA | NMEA_SENTENCE_RMC, 500);
+    gps_filter_init(&t.filter);
+
+    enum { EPOCHS = 300 };
+    static char nmea[EPOCHS * 160];
+    static uint8_t ubx[EPOCHS * (UBX_NAV_PVT_LEN + UBX_FRAME_OVERHEAD)];
+    size_t nmea_len = 0, ubx_len = 0;
+    for (int s = 0; s < EPOCHS; s++) {
+        nmea_len += put_nmea_epoch(nmea + nmea_len, sizeof(nmea) - nmea_len, s);
+        ubx_len += put_pvt(ubx + ubx_len, sizeof(ubx) - ubx_len, s);
+    }
+
+    heap_calls = 0;
+    run_loop(gps, (const uint8_t*)nmea, nmea_len);
+    run_loop(gps, ubx, ubx_len);
+    data_storage_shutdown(&t.storage);
+
+    TEST_ASSERT_EQUAL_size_t(0, heap_calls);
+    TEST_ASSERT_TRUE(t.written > EPOCHS);
+    TEST_ASSERT_EQUAL_INT(GPS_PROTOCOL_UBX, gps_stream_protocol(gps));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_counter_sees_create);
+    RUN_TEST(test_init_is_heap_free);
+    RUN_TEST(test_steady_state_loop);
+    return UNITY_END();
+}
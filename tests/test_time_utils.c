@@ -0,0 +1,82 @@
+#include "unity.h"
+#include "time_utils.h"
+#include "nmea_parser.h"
+#include <string.h>
+
+void setUp(void) { }
+
+void tearDown(void) { }
+
+/* T1: known day numbers, including leap days and the 2100 non-leap year */
+void test_days_from_civil_known_dates(void) {
+    TEST_ASSERT_EQUAL_INT32(0, days_from_civil(1970, 1, 1));
+    TEST_ASSERT_EQUAL_INT32(-1, days_from_civil(1969, 12, 31));
+    TEST_ASSERT_EQUAL_INT32(10957, days_from_civil(2000, 1, 1));
+    TEST_ASSERT_EQUAL_INT32(11017, days_from_civil(2000, 3, 1));    /* 2000-02-29 exists */
+    TEST_ASSERT_EQUAL_INT32(19782, days_from_civil(2024, 2, 29));
+    TEST_ASSERT_EQUAL_INT32(47540, days_from_civil(2100, 2, 28));
+    TEST_ASSERT_EQUAL_INT32(47541, days_from_civil(2100, 3, 1));    /* 2100-02-29 does not */
+    TEST_ASSERT_EQUAL_INT32(65535, days_from_civil(2149, 6, 6));
+}
+
+/* T2: civil_from_days inverts days_from_civil and walks valid consecutive dates */
+void test_civil_days_round_trip(void) {
+    static const uint8_t month_days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    int32_t py = 1969;
+    uint32_t pm = 12, pd = 31;
+    for (int32_t days = 0; days <= 65535; days++) {
+        int32_t y;
+        uint32_t m, d;
+        civil_from_days(days, &y, &m, &d);
+        TEST_ASSERT_EQUAL_INT32(days, days_from_civil(y, m, d));
+
+        bool leap = (py % 4 == 0 && py % 100 != 0) || py % 400 == 0;
+        uint32_t last = month_days[pm - 1] + (pm == 2 && leap);
+        if (pd < last) {
+            TEST_ASSERT_TRUE(y == py && m == pm && d == pd + 1);
+        } else if (pm < 12) {
+            TEST_ASSERT_TRUE(y == py && m == pm + 1 && d == 1);
+        } else {
+            TEST_ASSERT_TRUE(y == py + 1 && m == 1 && d == 1);
+        }
+        py = y;
+        pm = m;
+        pd = d;
+    }
+}
+
+/* T3: fix timestamps, with and without date, through the day cache */
+void test_fix_unix_ms(void) {
+    gps_fix_t fix;
+    memset(&fix, 0, sizeof(fix));
+    fix.flags = GPS_HAS_TIME | GPS_HAS_DATE;
+    fix.year = 2024; fix.month = 2; fix.day = 29;
+    fix.hour = 12; fix.centisecond = 50;
+
+    civil_day_cache_t cache;
+    memset(&cache, 0, sizeof(cache));
+    TEST_ASSERT_TRUE(gps_fix_unix_ms(&fix, &cache) == 1709208000500ull);
+    TEST_ASSERT_EQUAL_INT32(19782, cache.days);
+    fix.hour = 23; fix.minute = 59; fix.second = 59; fix.centisecond = 99;
+    uint64_t before = gps_fix_unix_ms(&fix, &cache);
+    fix.month = 3; fix.day = 1;
+    fix.hour = 0; fix.minute = 0; fix.second = 0; fix.centisecond = 0;
+    TEST_ASSERT_TRUE(gps_fix_unix_ms(&fix, &cache) - before == 10);
+    TEST_ASSERT_EQUAL_INT32(19783, cache.days);
+    TEST_ASSERT_TRUE(gps_fix_unix_ms(&fix, NULL) == gps_fix_unix_ms(&fix, &cache));
+
+    fix.flags = GPS_HAS_TIME;
+    fix.hour = 1;
+    TEST_ASSERT_TRUE(gps_fix_unix_ms(&fix, &cache) == 3600000ull);
+    fix.flags = GPS_HAS_DATE;
+    TEST_ASSERT_TRUE(gps_fix_unix_ms(&fix, &cache) == 0);
+    TEST_ASSERT_TRUE(gps_fix_unix_ms(NULL, &cache) == 0);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_days_from_civil_known_dates);
+    RUN_TEST(test_civil_days_round_trip);
+    RUN_TEST(test_fix_unix_ms);
+    return UNITY_END();
+}
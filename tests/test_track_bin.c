@@ -0,0 +1,233 @@
+#include "unity.h"
+#include "track_bin.h"
+#include <string.h>
+#include <math.h>
+
+#define MAX_FIXES   4000
+#define T0_MS       1750031400000ull        /* 2025-06-15T23:50:00Z */
+
+static gps_fix_packed_t fixes[MAX_FIXES];
+static gps_fix_packed_t decoded[MAX_FIXES + 64];
+static uint8_t stream[MAX_FIXES * 24];
+static uint64_t rng;
+
+void setUp(void) {
+    rng = 88172645463325252ull;
+}
+
+void tearDown(void) { }
+
+/* Helper: xorshift64 */
+static uint64_t next(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+static double gauss(void) {
+    double u0 = ((double)(next() >> 11) + 0.5) / 9007199254740992.0;
+    double u1 = ((double)(next() >> 11) + 0.5) / 9007199254740992.0;
+    return sqrt(-2.0 * log(u0)) * cos(6.283185307179586 * u1);
+}
+
+/* Helper: n fixes step_s apart round a 5 km circle at 25 m/s with 2 m
+   jitter, across midnight; HDOP and satellites change now and then */
+static void make_drive(int n, int step_s) {
+    for (int i = 0; i < n; i++) {
+        double t = (double)i * step_s;
+        double a = t * 25.0 / 5000.0;
+        gps_fix_t f;
+        memset(&f, 0, sizeof(f));
+        f.flags = GPS_FIX_VALID | GPS_HAS_ALL;
+        f.unix_ms = T0_MS + (uint64_t)i * (uint64_t)step_s * 1000u;
+        f.latitude = 47.285233 + (5000.0 * (1.0 - cos(a)) + 2.0 * gauss()) / 111195.0;
+        f.longitude = 8.565265 + (5000.0 * sin(a) + 2.0 * gauss()) / 75445.0;
+        f.speed_kmh = (float)(90.0 + 0.5 * gauss());
+        f.altitude_m = (float)(480.0 + 30.0 * sin(a / 3.0) + 0.5 * gauss());
+        f.course_deg = (float)fmod(a * 57.29577951308232 + 90.0, 360.0);
+        f.hdop = 0.9f + 0.1f * (float)((i / 47) % 3);
+        f.satellites = (uint8_t)(7 + (i / 31) % 4);
+        f.fix_quality = 1;
+        gps_fix_pack(&f, &fixes[i]);
+    }
+}
+
+static size_t encode_all(int n) {
+    track_bin_encoder_t enc;
+    track_bin_encoder_init(&enc);
+    size_t len = track_bin_write_header(stream);
+    for (int i = 0; i < n; i++) len += track_bin_encode_fix(&enc, &fixes[i], stream + len);
+    return len;
+}
+
+/* Helper: decode stream[0..len) fed in chunks of 1..max_chunk bytes, as a
+   file reader would. Returns the number of fixes. */
+static int decode_chunked(size_t len, size_t max_chunk, track_bin_decoder_t* dec) {
+    static uint8_t carry[TRACK_BIN_RECORD_MAX + 512];
+    size_t have = 0, pos = TRACK_BIN_HEADER_SIZE;
+    int n = 0;
+    TEST_ASSERT_TRUE(track_bin_decoder_init(dec, stream, len));
+    while (pos < len || have > 0) {
+        size_t chunk = 1 + (size_t)(next() % max_chunk);
+        if (chunk > len - pos) chunk = len - pos;
+        memcpy(carry + have, stream + pos, chunk);
+        have += chunk;
+        pos += chunk;
+        size_t off = 0, used;
+        track_bin_status_t st;
+        while ((st = track_bin_decode(dec, carry + off, have - off, &used)) != TRACK_BIN_NEED_MORE) {
+            if (st == TRACK_BIN_FIX && n < MAX_FIXES + 64) decoded[n++] = dec->fix;
+            off += used;
+        }
+        memmove(carry, carry + off, have - off);
+        have -= off;
+        if (pos == len && chunk == 0) break;
+    }
+    return n;
+}
+
+/* T1: header, a keyframe first, then small delta records */
+void test_bin_header_and_keyframe(void) {
+    make_drive(3, 1);
+    size_t len = encode_all(3);
+    TEST_ASSERT_EQUAL_MEMORY("GTRK", stream, 4);
+    TEST_ASSERT_EQUAL_UINT8(TRACK_BIN_VERSION, stream[4]);
+    TEST_ASSERT_EQUAL_UINT8(TRACK_BIN_KEYFRAME_INTERVAL, stream[5]);
+    TEST_ASSERT_EQUAL_UINT8(TRACK_BIN_TAG_KEYFRAME, stream[TRACK_BIN_HEADER_SIZE]);
+
+    track_bin_decoder_t dec;
+    size_t used, pos = TRACK_BIN_HEADER_SIZE;
+    TEST_ASSERT_TRUE(track_bin_decoder_init(&dec, stream, len));
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_INT(TRACK_BIN_FIX, track_bin_decode(&dec, stream + pos, len - pos, &used));
+        TEST_ASSERT_EQUAL_MEMORY(&fixes[i], &dec.fix, sizeof(gps_fix_packed_t));
+        if (i > 0) {
+            TEST_ASSERT_TRUE(stream[pos] < TRACK_BIN_TAG_KEYFRAME);
+            TEST_ASSERT_TRUE(used <= 12);
+        }
+        pos += used;
+    }
+    TEST_ASSERT_EQUAL_size_t(len, pos);
+    TEST_ASSERT_EQUAL_INT(TRACK_BIN_NEED_MORE, track_bin_decode(&dec, stream + pos, 0, &used));
+
+    stream[0] = 'X';
+    TEST_ASSERT_FALSE(track_bin_decoder_init(&dec, stream, len));
+}
+
+/* T2: an hour at 1 Hz across midnight, and the same drive logged every 8 s
+   (about 200 m), decode exactly in any chunking at under 12 bytes a fix */
+void test_bin_round_trip_drive(void) {
+    static const int steps[2] = {1, 8};
+    for (int k = 0; k < 2; k++) {
+        int n = 3600 / steps[k];
+        make_drive(n, steps[k]);
+        size_t len = encode_all(n);
+        TEST_ASSERT_TRUE(len < 12u * (size_t)n);
+
+        size_t chunks[3] = {1, 7, 300};
+        for (int c = 0; c < 3; c++) {
+            track_bin_decoder_t dec;
+            TEST_ASSERT_EQUAL_INT(n, decode_chunked(len, chunks[c], &dec));
+            TEST_ASSERT_EQUAL_MEMORY(fixes, decoded, (size_t)n * sizeof(gps_fix_packed_t));
+            TEST_ASSERT_EQUAL_UINT32(0, dec.skipped);
+        }
+    }
+    TEST_ASSERT_TRUE(fixes[0].date + 1 == fixes[450 - 1].date);
+}
+
+/* T3: comments pass through, an end record makes the next fix a keyframe,
+   a cut-off record waits for more bytes, a bare end tag is damage */
+void test_bin_comment_end_and_truncation(void) {
+    make_drive(4, 1);
+    track_bin_encoder_t enc;
+    track_bin_encoder_init(&enc);
+    size_t len = track_bin_write_header(stream);
+    len += track_bin_encode_fix(&enc, &fixes[0], stream + len);
+    len += track_bin_encode_fix(&enc, &fixes[1], stream + len);
+    len += track_bin_encode_comment("filter_results accept=2", 23, stream + len);
+    len += track_bin_encode_end(&enc, stream + len);
+    size_t key = len;
+    len += track_bin_encode_fix(&enc, &fixes[2], stream + len);
+    TEST_ASSERT_EQUAL_UINT8(TRACK_BIN_TAG_KEYFRAME, stream[key]);
+
+    static const track_bin_status_t expect[5] = {
+        TRACK_BIN_FIX, TRACK_BIN_FIX, TRACK_BIN_COMMENT, TRACK_BIN_END, TRACK_BIN_FIX,
+    };
+    track_bin_decoder_t dec;
+    size_t used, pos = TRACK_BIN_HEADER_SIZE;
+    TEST_ASSERT_TRUE(track_bin_decoder_init(&dec, stream, len));
+    for (int i = 0; i < 5; i++) {
+        size_t avail = len - pos;
+        if (i == 3) {
+            TEST_ASSERT_TRUE(track_bin_is_end(stream + pos, TRACK_BIN_END_SIZE));
+            TEST_ASSERT_EQUAL_INT(TRACK_BIN_NEED_MORE,
+                                  track_bin_decode(&dec, stream + pos, TRACK_BIN_END_SIZE - 1, &used));
+        }
+        if (i == 4) {
+            TEST_ASSERT_EQUAL_INT(TRACK_BIN_NEED_MORE, track_bin_decode(&dec, stream + pos, avail - 1, &used));
+            TEST_ASSERT_EQUAL_size_t(0, used);
+        }
+        TEST_ASSERT_EQUAL_INT(expect[i], track_bin_decode(&dec, stream + pos, avail, &used));
+        if (i == 2) TEST_ASSERT_EQUAL_STRING_LEN("filter_results accept=2", dec.text, dec.text_len);
+        pos += used;
+    }
+    TEST_ASSERT_EQUAL_MEMORY(&fixes[2], &dec.fix, sizeof(gps_fix_packed_t));
+
+    /* The tag alone, then the keyframe: skipped, and the keyframe resyncs */
+    memmove(stream + key - TRACK_BIN_END_SIZE + 1, stream + key, len - key);
+    len -= TRACK_BIN_END_SIZE - 1;
+    pos = key - TRACK_BIN_END_SIZE;
+    TEST_ASSERT_EQUAL_INT(TRACK_BIN_SKIPPED, track_bin_decode(&dec, stream + pos, len - pos, &used));
+    pos += used;
+    TEST_ASSERT_EQUAL_INT(TRACK_BIN_FIX, track_bin_decode(&dec, stream + pos, len - pos, &used));
+    TEST_ASSERT_EQUAL_MEMORY(&fixes[2], &dec.fix, sizeof(gps_fix_packed_t));
+}
+
+/* T4: 200 single damaged bytes. Fixes before the damaged record and from
+   the next keyframe on decode exactly. The decoder notices (skips bytes)
+   in over 60 trials; in the rest the damage only alters fixes before that
+   keyframe. */
+void test_bin_resync_after_damage(void) {
+    const int n = 2000;
+    make_drive(n, 1);
+    size_t len = encode_all(n);
+    static size_t starts[MAX_FIXES];
+    track_bin_encoder_t enc;
+    track_bin_encoder_init(&enc);
+    size_t pos = TRACK_BIN_HEADER_SIZE;
+    for (int i = 0; i < n; i++) {
+        starts[i] = pos;
+        pos += track_bin_encode_fix(&enc, &fixes[i], stream + pos);
+    }
+
+    int resynced = 0;
+    for (int trial = 0; trial < 200; trial++) {
+        int k = 64 + (int)(next() % (uint64_t)(n - 512));
+        size_t at = starts[k] + (size_t)(next() % (starts[k + 1] - starts[k]));
+        uint8_t saved = stream[at];
+        stream[at] = (uint8_t)(saved ^ (1u + next() % 255u));
+
+        track_bin_decoder_t dec;
+        int got = decode_chunked(len, 512, &dec);
+        stream[at] = saved;
+
+        int clean_from = (k / TRACK_BIN_KEYFRAME_INTERVAL + 1) * TRACK_BIN_KEYFRAME_INTERVAL;
+        int tail = n - clean_from;
+        TEST_ASSERT_TRUE(got >= k + tail);
+        TEST_ASSERT_EQUAL_MEMORY(fixes, decoded, (size_t)k * sizeof(gps_fix_packed_t));
+        TEST_ASSERT_EQUAL_MEMORY(&fixes[clean_from], &decoded[got - tail],
+                                 (size_t)tail * sizeof(gps_fix_packed_t));
+        resynced += dec.skipped > 0;
+    }
+    TEST_ASSERT_TRUE(resynced > 60);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_bin_header_and_keyframe);
+    RUN_TEST(test_bin_round_trip_drive);
+    RUN_TEST(test_bin_comment_end_and_truncation);
+    RUN_TEST(test_bin_resync_after_damage);
+    return UNITY_END();
+}
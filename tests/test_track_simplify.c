@@ -0,0 +1,233 @@
+#include "unity.h"
+#include "track_simplify.h"
+#include <string.h>
+#include <math.h>
+
+#define LAT0_E6     47285233
+#define LON0_E6     8565265
+#define M_PER_E6    0.11119493
+#define MAX_FIXES   4000
+
+static track_simplify_t ts;
+static gps_fix_packed_t input[MAX_FIXES];
+static int emitted[MAX_FIXES];         /* indices into input, from time_cs */
+static int n_emitted;
+static uint64_t rng;
+
+static void on_emit(const gps_fix_packed_t* fix, void* user) {
+    (void)user;
+    emitted[n_emitted++] = (int)fix->time_cs;
+}
+
+void setUp(void) {
+    n_emitted = 0;
+    rng = 88172645463325252ull;
+}
+
+void tearDown(void) { }
+
+/* Helper: standard normal via Box-Muller on xorshift64 */
+static double gauss(void) {
+    double u[2];
+    for (int k = 0; k < 2; k++) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        u[k] = ((double)(rng >> 11) + 0.5) / 9007199254740992.0;
+    }
+    return sqrt(-2.0 * log(u[0])) * cos(6.283185307179586 * u[1]);
+}
+
+static double m_per_e6_lon(int32_t lat_e6) {
+    return M_PER_E6 * cos(lat_e6 * 1.7453292519943295e-8);
+}
+
+/* Helper: fix i at local east/north metres; time_cs carries the index */
+static gps_fix_packed_t make_fix(int i, double east, double north) {
+    gps_fix_packed_t f;
+    memset(&f, 0, sizeof(f));
+    f.flags = GPS_FIX_VALID | GPS_HAS_LATLON | GPS_HAS_TIME;
+    f.lat_e6 = LAT0_E6 + (int32_t)lrint(north / M_PER_E6);
+    f.lon_e6 = LON0_E6 + (int32_t)lrint(east / m_per_e6_lon(LAT0_E6));
+    f.time_cs = (uint32_t)i;
+    return f;
+}
+
+/* Helper: drive a waypoint polyline at speed m/s, one fix per second with
+   noise_m of jitter per axis. Returns the number of fixes. */
+static int drive(const double (*wp)[2], int n_wp, double speed, double noise_m) {
+    int n = 0, seg = 0;
+    double along = 0.0;
+    while (seg < n_wp - 1 && n < MAX_FIXES) {
+        double ex = wp[seg + 1][0] - wp[seg][0], ey = wp[seg + 1][1] - wp[seg][1];
+        double len = sqrt(ex * ex + ey * ey);
+        if (along > len) {
+            along -= len;
+            seg++;
+            continue;
+        }
+        input[n] = make_fix(n, wp[seg][0] + ex * along / len + noise_m * gauss(),
+                            wp[seg][1] + ey * along / len + noise_m * gauss());
+        n++;
+        along += speed;
+    }
+    return n;
+}
+
+/* Helper: run the simplifier over input[0..n) and flush */
+static void simplify(int n, float tolerance_m) {
+    n_emitted = 0;
+    track_simplify_init(&ts, tolerance_m, on_emit, NULL);
+    for (int i = 0; i < n; i++) track_simplify_push(&ts, &input[i]);
+    track_simplify_flush(&ts);
+}
+
+/* Helper: largest distance from an input fix to the emitted polyline
+   segment that spans it */
+static double max_reconstruction_error(int n) {
+    double worst = 0.0;
+    TEST_ASSERT_EQUAL_INT(0, emitted[0]);
+    TEST_ASSERT_EQUAL_INT(n - 1, emitted[n_emitted - 1]);
+    for (int k = 0; k + 1 < n_emitted; k++) {
+        const gps_fix_packed_t* a = &input[emitted[k]];
+        const gps_fix_packed_t* b = &input[emitted[k + 1]];
+        double kx = m_per_e6_lon(a->lat_e6);
+        double ex = (b->lon_e6 - a->lon_e6) * kx, ey = (b->lat_e6 - a->lat_e6) * M_PER_E6;
+        double len2 = ex * ex + ey * ey;
+        for (int i = emitted[k] + 1; i < emitted[k + 1]; i++) {
+            double px = (input[i].lon_e6 - a->lon_e6) * kx;
+            double py = (input[i].lat_e6 - a->lat_e6) * M_PER_E6;
+            double t = len2 > 0.0 ? (px * ex + py * ey) / len2 : 0.0;
+            t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+            double d = hypot(px - t * ex, py - t * ey);
+            if (d > worst) worst = d;
+        }
+    }
+    return worst;
+}
+
+/* T1: the first fix goes out at once, flush releases the held one, a
+   tolerance of 0 passes everything through */
+void test_simplify_first_fix_and_flush(void) {
+    input[0] = make_fix(0, 0.0, 0.0);
+    input[1] = make_fix(1, 10.0, 0.0);
+    track_simplify_init(&ts, TRACK_SIMPLIFY_TOLERANCE_M, on_emit, NULL);
+    track_simplify_push(&ts, &input[0]);
+    TEST_ASSERT_EQUAL_INT(1, n_emitted);
+    track_simplify_push(&ts, &input[1]);
+    TEST_ASSERT_EQUAL_INT(1, n_emitted);
+    track_simplify_flush(&ts);
+    TEST_ASSERT_EQUAL_INT(2, n_emitted);
+    TEST_ASSERT_EQUAL_INT(1, emitted[1]);
+    track_simplify_flush(&ts);
+    TEST_ASSERT_EQUAL_INT(2, n_emitted);
+
+    for (int i = 0; i < 10; i++) input[i] = make_fix(i, 10.0 * i, 0.0);
+    simplify(10, 0.0f);
+    TEST_ASSERT_EQUAL_INT(10, n_emitted);
+}
+
+/* T2: a dead-straight road still emits at least every TRACK_SIMPLIFY_WINDOW
+   fixes, which bounds latency and memory */
+void test_simplify_window_bounds_latency(void) {
+    for (int i = 0; i < 200; i++) input[i] = make_fix(i, 25.0 * i, 0.0);
+    simplify(200, TRACK_SIMPLIFY_TOLERANCE_M);
+    for (int k = 0; k + 1 < n_emitted; k++) {
+        TEST_ASSERT_TRUE(emitted[k + 1] - emitted[k] <= TRACK_SIMPLIFY_WINDOW);
+    }
+    TEST_ASSERT_TRUE(n_emitted <= 2 + 199 / TRACK_SIMPLIFY_WINDOW);
+    TEST_ASSERT_TRUE(sizeof(track_simplify_t) <= 1100);
+}
+
+/* T3: 45 min of motorway with long curves, 1 m jitter: at least 10x fewer
+   points, none of the dropped ones further than the tolerance */
+void test_simplify_motorway_drive(void) {
+    static double wp[800][2];
+    for (int i = 0; i < 800; i++) {
+        double x = 100.0 * i;
+        wp[i][0] = x;
+        wp[i][1] = 1500.0 * sin(x / 6000.0);      /* radius >= 2.4 km */
+    }
+    int n = drive(wp, 800, 30.0, 1.0);
+    TEST_ASSERT_TRUE(n >= 1800);
+    simplify(n, TRACK_SIMPLIFY_TOLERANCE_M);
+    TEST_ASSERT_TRUE(n >= 10 * n_emitted);
+    TEST_ASSERT_TRUE(max_reconstruction_error(n) <= TRACK_SIMPLIFY_TOLERANCE_M + 0.01);
+}
+
+/* T4: a city route with right-angle turns every few hundred metres and a
+   roundabout, 1 m jitter: at least 3x fewer points, same error bound,
+   smaller tolerances keep more points */
+void test_simplify_city_drive(void) {
+    static double wp[64][2];
+    static const double legs[][2] = {
+        {250, 0}, {0, 180}, {320, 0}, {0, -120}, {150, 0}, {0, 400},
+        {-200, 0}, {0, 150}, {400, 0}, {0, -300}, {260, 0},
+    };
+    int n_wp = 0;
+    double x = 0.0, y = 0.0;
+    wp[n_wp][0] = x;
+    wp[n_wp++][1] = y;
+    for (size_t i = 0; i < sizeof(legs) / sizeof(legs[0]); i++) {
+        x += legs[i][0];
+        y += legs[i][1];
+        wp[n_wp][0] = x;
+        wp[n_wp++][1] = y;
+    }
+    for (int i = 1; i <= 24; i++) {              /* 3/4 round a 25 m roundabout */
+        double a = -1.5707963 + 4.712389 * i / 24.0;
+        wp[n_wp][0] = x + 25.0 * cos(a);
+        wp[n_wp++][1] = y + 25.0 + 25.0 * sin(a);
+    }
+
+    int n = drive(wp, n_wp, 10.0, 1.0);
+    TEST_ASSERT_TRUE(n >= 250);
+    int kept[3];
+    const float tol[3] = {2.0f, TRACK_SIMPLIFY_TOLERANCE_M, 10.0f};
+    for (int k = 0; k < 3; k++) {
+        simplify(n, tol[k]);
+        kept[k] = n_emitted;
+        TEST_ASSERT_TRUE(max_reconstruction_error(n) <= tol[k] + 0.01);
+    }
+    TEST_ASSERT_TRUE(n >= 3 * kept[1]);
+    TEST_ASSERT_TRUE(kept[0] > kept[1] && kept[1] > kept[2]);
+}
+
+/* T5: held fixes go out once the first poll that saw them is max_hold_ms
+   old, with no further input; the clock restarts for the next ones */
+void test_simplify_poll_bounds_hold_time(void) {
+    for (int i = 0; i < 6; i++) input[i] = make_fix(i, 10.0 * i, 0.0);
+    track_simplify_init(&ts, TRACK_SIMPLIFY_TOLERANCE_M, on_emit, NULL);
+    track_simplify_poll(&ts, 1000, 5000);
+    track_simplify_push(&ts, &input[0]);
+    track_simplify_push(&ts, &input[1]);
+    track_simplify_push(&ts, &input[2]);
+    TEST_ASSERT_EQUAL_INT(1, n_emitted);
+
+    track_simplify_poll(&ts, 2000, 5000);
+    track_simplify_push(&ts, &input[3]);
+    track_simplify_poll(&ts, 6999, 5000);
+    TEST_ASSERT_EQUAL_INT(1, n_emitted);
+    track_simplify_poll(&ts, 7000, 5000);
+    TEST_ASSERT_EQUAL_INT(2, n_emitted);
+    TEST_ASSERT_EQUAL_INT(3, emitted[1]);
+
+    track_simplify_push(&ts, &input[4]);
+    track_simplify_push(&ts, &input[5]);
+    track_simplify_poll(&ts, 8000, 5000);
+    track_simplify_poll(&ts, 12999, 5000);
+    TEST_ASSERT_EQUAL_INT(2, n_emitted);
+    track_simplify_poll(&ts, 13000, 5000);
+    TEST_ASSERT_EQUAL_INT(3, n_emitted);
+    TEST_ASSERT_EQUAL_INT(5, emitted[2]);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_simplify_first_fix_and_flush);
+    RUN_TEST(test_simplify_window_bounds_latency);
+    RUN_TEST(test_simplify_motorway_drive);
+    RUN_TEST(test_simplify_city_drive);
+    RUN_TEST(test_simplify_poll_bounds_hold_time);
+    return UNITY_END();
+}
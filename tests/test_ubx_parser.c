@@ -0,0 +1,212 @@
+#include "unity.h"
+#include "ubx_parser.h"
+#include <string.h>
+#include <math.h>
+#include <stdio.h>
+
+static ubx_parser_t* parser;
+
+void setUp(void) {
+    parser = ubx_parser_create();
+}
+
+void tearDown(void) {
+    ubx_parser_destroy(parser);
+    parser = NULL;
+}
+
+static void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_i32(uint8_t* p, int32_t v) {
+    uint32_t u = (uint32_t)v;
+    p[0] = (uint8_t)u;
+    p[1] = (uint8_t)(u >> 8);
+    p[2] = (uint8_t)(u >> 16);
+    p[3] = (uint8_t)(u >> 24);
+}
+
+/* Helper: NAV-PVT payload for 2002-12-09 09:27:25.00, 3D fix at the
+   reference point used by the NMEA tests (4717.11399N 00833.91590E) */
+static void make_pvt(uint8_t* p) {
+    memset(p, 0, UBX_NAV_PVT_LEN);
+    put_u16(p + 4, 2002);
+    p[6] = 12;
+    p[7] = 9;
+    p[8] = 9;
+    p[9] = 27;
+    p[10] = 25;
+    p[11] = 0x07;                   /* validDate | validTime | fullyResolved */
+    put_i32(p + 16, 0);             /* nano */
+    p[20] = 3;                      /* 3D fix */
+    p[21] = 0x01;                   /* gnssFixOK */
+    p[23] = 8;                      /* numSV */
+    put_i32(p + 24, 85652650);      /* lon 8.565265 */
+    put_i32(p + 28, 472852332);     /* lat 47.2852332 */
+    put_i32(p + 36, 499600);        /* hMSL 499.6 m */
+    put_i32(p + 60, 2778);          /* gSpeed 2.778 m/s = 10.0 km/h */
+    put_i32(p + 64, 7752000);       /* headMot 77.52 deg */
+    put_u16(p + 76, 101);           /* pDOP 1.01 */
+}
+
+static size_t make_frame(uint8_t* out, size_t size, const uint8_t* pvt) {
+    return ubx_frame_encode(UBX_CLASS_NAV, UBX_ID_NAV_PVT, pvt, UBX_NAV_PVT_LEN, out, size);
+}
+
+/* T1: NAV-PVT frame decodes into the same gps_fix_t fields as GGA+RMC */
+void test_nav_pvt_decodes_fix(void) {
+    uint8_t pvt[UBX_NAV_PVT_LEN], frame[128];
+    make_pvt(pvt);
+    size_t n = make_frame(frame, sizeof(frame), pvt);
+    TEST_ASSERT_EQUAL_size_t(100, n);
+
+    TEST_ASSERT_EQUAL_INT(1, ubx_parser_feed_bytes(parser, frame, n));
+    gps_fix_t fix;
+    TEST_ASSERT_TRUE(ubx_parser_get_fix(parser, &fix));
+    TEST_ASSERT_FALSE(ubx_parser_get_fix(parser, &fix));
+
+    TEST_ASSERT_TRUE(fix.flags & GPS_FIX_VALID);
+    TEST_ASSERT_TRUE(fix.flags & GPS_HAS_TIME);
+    TEST_ASSERT_TRUE(fix.flags & GPS_HAS_DATE);
+    TEST_ASSERT_TRUE(fix.flags & GPS_HAS_LATLON);
+    TEST_ASSERT_TRUE(fix.flags & GPS_HAS_ALTITUDE);
+    TEST_ASSERT_TRUE(fix.flags & GPS_HAS_SPEED);
+    TEST_ASSERT_TRUE(fix.flags & GPS_HAS_COURSE);
+    TEST_ASSERT_TRUE(fix.flags & GPS_HAS_HDOP);
+    TEST_ASSERT_EQUAL_UINT16(2002, fix.year);
+    TEST_ASSERT_EQUAL_UINT8(12, fix.month);
+    TEST_ASSERT_EQUAL_UINT8(9, fix.day);
+    TEST_ASSERT_EQUAL_UINT8(9, fix.hour);
+    TEST_ASSERT_EQUAL_UINT8(27, fix.minute);
+    TEST_ASSERT_EQUAL_UINT8(25, fix.second);
+    TEST_ASSERT_TRUE(fix.unix_ms == 1039426045000ull);      /* 2002-12-09T09:27:25Z */
+    TEST_ASSERT_FLOAT_WITHIN(0.000001, 47.285233, fix.latitude);
+    TEST_ASSERT_FLOAT_WITHIN(0.000001, 8.565265, fix.longitude);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 499.6, fix.altitude_m);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 10.0, fix.speed_kmh);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 77.52, fix.course_deg);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 1.01, fix.hdop);
+    TEST_ASSERT_EQUAL_UINT8(8, fix.satellites);
+    TEST_ASSERT_EQUAL_UINT8(1, fix.fix_quality);
+}
+
+/* T2: checksum mismatch drops the frame */
+void test_bad_frame_checksum(void) {
+    uint8_t pvt[UBX_NAV_PVT_LEN], frame[128];
+    make_pvt(pvt);
+    size_t n = make_frame(frame, sizeof(frame), pvt);
+    frame[30] ^= 0x01;
+    TEST_ASSERT_EQUAL_INT(0, ubx_parser_feed_bytes(parser, frame, n));
+
+    make_frame(frame, sizeof(frame), pvt);
+    frame[n - 1] ^= 0xFF;
+    TEST_ASSERT_EQUAL_INT(0, ubx_parser_feed_bytes(parser, frame, n));
+
+    gps_fix_t fix;
+    TEST_ASSERT_FALSE(ubx_parser_get_fix(parser, &fix));
+}
+
+/* T3: frames split at every possible chunk size */
+void test_chunk_boundaries(void) {
+    uint8_t pvt[UBX_NAV_PVT_LEN], stream[256];
+    make_pvt(pvt);
+    size_t n = make_frame(stream, sizeof(stream), pvt);
+    pvt[10] = 26;
+    n += make_frame(stream + n, sizeof(stream) - n, pvt);
+
+    for (size_t chunk = 1; chunk <= n; chunk++) {
+        ubx_parser_t* p = ubx_parser_create();
+        int total = 0;
+        for (size_t off = 0; off < n; off += chunk) {
+            size_t len = (n - off < chunk) ? n - off : chunk;
+            total += ubx_parser_feed_bytes(p, stream + off, len);
+        }
+        gps_fix_t fix;
+        TEST_ASSERT_TRUE(ubx_parser_get_fix(p, &fix));
+        ubx_parser_destroy(p);
+        TEST_ASSERT_EQUAL_INT(2, total);
+        TEST_ASSERT_EQUAL_UINT8(26, fix.second);
+    }
+}
+
+/* T4: no fix → no position, not valid */
+void test_no_fix(void) {
+    uint8_t pvt[UBX_NAV_PVT_LEN], frame[128];
+    make_pvt(pvt);
+    pvt[20] = 0;
+    pvt[21] = 0;
+    size_t n = make_frame(frame, sizeof(frame), pvt);
+    TEST_ASSERT_EQUAL_INT(1, ubx_parser_feed_bytes(parser, frame, n));
+
+    gps_fix_t fix;
+    TEST_ASSERT_TRUE(ubx_parser_get_fix(parser, &fix));
+    TEST_ASSERT_FALSE(fix.flags & GPS_FIX_VALID);
+    TEST_ASSERT_FALSE(fix.flags & GPS_HAS_LATLON);
+    TEST_ASSERT_FALSE(fix.flags & GPS_HAS_SPEED);
+    TEST_ASSERT_TRUE(fix.flags & GPS_HAS_TIME);
+    TEST_ASSERT_EQUAL_UINT8(0, fix.fix_quality);
+}
+
+/* T5: 2D fix, negative coordinates, DGPS, sub-second time */
+void test_2d_fix_south_west(void) {
+    uint8_t pvt[UBX_NAV_PVT_LEN];
+    make_pvt(pvt);
+    pvt[20] = 2;
+    pvt[21] = 0x03;                    /* gnssFixOK | diffSoln */
+    put_i32(pvt + 16, 500000000);      /* +0.50 s */
+    put_i32(pvt + 24, -1185351650);
+    put_i32(pvt + 28, -340423870);
+
+    gps_fix_t fix;
+    TEST_ASSERT_TRUE(ubx_decode_nav_pvt(pvt, sizeof(pvt), &fix));
+    TEST_ASSERT_TRUE(fix.flags & GPS_FIX_VALID);
+    TEST_ASSERT_FALSE(fix.flags & GPS_HAS_ALTITUDE);
+    TEST_ASSERT_FLOAT_WITHIN(0.000001, -34.042387, fix.latitude);
+    TEST_ASSERT_FLOAT_WITHIN(0.000001, -118.535165, fix.longitude);
+    TEST_ASSERT_EQUAL_UINT8(2, fix.fix_quality);
+    TEST_ASSERT_EQUAL_UINT8(50, fix.centisecond);
+    TEST_ASSERT_FALSE(ubx_decode_nav_pvt(pvt, UBX_NAV_PVT_LEN - 1, &fix));
+}
+
+/* T6: other messages, oversized lengths and false syncs are skipped */
+void test_skip_and_resync(void) {
+    uint8_t pvt[UBX_NAV_PVT_LEN], big[400], stream[1024];
+    make_pvt(pvt);
+    memset(big, 0xB5, sizeof(big));
+
+    size_t n = 0;
+    const uint8_t noise[] = { 0xB5, 0x00, 0xB5, 0xB5, 0x62, 0x01, 0x07, 0xFF, 0xFF, '$', 'G' };
+    memcpy(stream, noise, sizeof(noise));
+    n += sizeof(noise);
+    n += ubx_frame_encode(UBX_CLASS_NAV, 0x35, big, sizeof(big), stream + n, sizeof(stream) - n);
+    n += ubx_frame_encode(0x05, 0x01, big, 2, stream + n, sizeof(stream) - n);  /* ACK-ACK */
+    n += make_frame(stream + n, sizeof(stream) - n, pvt);
+
+    TEST_ASSERT_EQUAL_INT(1, ubx_parser_feed_bytes(parser, stream, n));
+    TEST_ASSERT_FALSE(ubx_parser_in_frame(parser));
+}
+
+/* T7: argument checks and encoder bounds */
+void test_null_args(void) {
+    uint8_t frame[16] = {0};
+    TEST_ASSERT_EQUAL_INT(-1, ubx_parser_feed_bytes(NULL, frame, 1));
+    TEST_ASSERT_EQUAL_INT(-1, ubx_parser_feed_bytes(parser, NULL, 1));
+    TEST_ASSERT_EQUAL_INT(0, ubx_parser_feed_bytes(parser, NULL, 0));
+    TEST_ASSERT_FALSE(ubx_parser_get_fix(NULL, NULL));
+    TEST_ASSERT_EQUAL_size_t(0, ubx_frame_encode(UBX_CLASS_NAV, UBX_ID_NAV_PVT, frame, 10, frame, 16));
+    TEST_ASSERT_EQUAL_size_t(8, ubx_frame_encode(0x06, 0x00, NULL, 0, frame, 16));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_nav_pvt_decodes_fix);
+    RUN_TEST(test_bad_frame_checksum);
+    RUN_TEST(test_chunk_boundaries);
+    RUN_TEST(test_no_fix);
+    RUN_TEST(test_2d_fix_south_west);
+    RUN_TEST(test_skip_and_resync);
+    RUN_TEST(test_null_args);
+    return UNITY_END();
+}
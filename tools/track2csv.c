@@ -0,0 +1,89 @@
+/*
+ * Binary track file to CSV.
+ *
+ *   track2csv [track.bin] [-o track.csv]
+ *
+ * Reads a track*.bin written with STORAGE_FORMAT_BINARY (stdin without a
+ * file) and writes the CSV data_storage would have written for the same
+ * fixes and comments (stdout without -o): the header, one row per fix,
+ * "# " lines for comments. Damaged bytes and a cut-off last record, as
+ * after a power loss, are reported on stderr; the rest is converted.
+ */
+#include "track_bin.h"
+#include "csv_row.h"
+#include "data_storage.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHUNK 4096
+
+int main(int argc, char** argv) {
+    const char* in_path = NULL;
+    const char* out_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            fprintf(stderr, "usage: %s [track.bin] [-o track.csv]\n", argv[0]);
+            return 1;
+        } else {
+            in_path = argv[i];
+        }
+    }
+
+    FILE* in = in_path ? fopen(in_path, "rb") : stdin;
+    if (!in) {
+        perror(in_path);
+        return 1;
+    }
+    FILE* out = out_path ? fopen(out_path, "wb") : stdout;
+    if (!out) {
+        perror(out_path);
+        return 1;
+    }
+
+    static uint8_t buf[CHUNK + TRACK_BIN_RECORD_MAX];
+    size_t have = fread(buf, 1, TRACK_BIN_HEADER_SIZE, in);
+    track_bin_decoder_t dec;
+    if (!track_bin_decoder_init(&dec, buf, have)) {
+        fprintf(stderr, "%s: not a binary track file\n", in_path ? in_path : "stdin");
+        return 1;
+    }
+    fputs(CSV_HEADER, out);
+
+    unsigned long fixes = 0, comments = 0;
+    have = 0;
+    for (;;) {
+        size_t got = fread(buf + have, 1, CHUNK, in);
+        have += got;
+        size_t off = 0, used;
+        track_bin_status_t st;
+        while ((st = track_bin_decode(&dec, buf + off, have - off, &used)) != TRACK_BIN_NEED_MORE) {
+            if (st == TRACK_BIN_FIX) {
+                char line[CSV_ROW_MAX];
+                gps_fix_t fix;
+                gps_fix_unpack(&dec.fix, &fix);
+                fwrite(line, 1, csv_row_format(line, &fix), out);
+                fixes++;
+            } else if (st == TRACK_BIN_COMMENT) {
+                fprintf(out, "# %.*s\n", (int)dec.text_len, dec.text);
+                comments++;
+            }
+            off += used;
+        }
+        memmove(buf, buf + off, have - off);
+        have -= off;
+        if (got == 0) break;
+    }
+
+    if (dec.skipped) fprintf(stderr, "skipped %lu damaged bytes\n", (unsigned long)dec.skipped);
+    if (have) fprintf(stderr, "ignored a cut-off record of %zu bytes at the end\n", have);
+    fprintf(stderr, "%lu fixes, %lu comments\n", fixes, comments);
+    if (in != stdin) fclose(in);
+    if (out != stdout && fclose(out) != 0) {
+        perror(out_path);
+        return 1;
+    }
+    return 0;
+}